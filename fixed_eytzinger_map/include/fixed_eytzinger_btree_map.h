@@ -0,0 +1,1061 @@
+/* Copyright (c) 2017 Michael Kazakov <mike.kazakov@gmail.com>
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#pragma once
+
+#include "fixed_eytzinger_map.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
+// fixed_eytzinger_btree_map has the same interface as fixed_eytzinger_map, but instead of a binary
+// tree it lays the keys out as a B-tree: each node holds up to node_size keys, which together take
+// one cache line, and nodes are stored in breadth-first order. A node of node_size keys has
+// node_size+1 children, so a lookup touches about log(node_size+1) times fewer cache lines.
+// Keys within a node are compared all at once, with SIMD instructions for arithmetic keys.
+
+namespace __eytzinger
+{
+
+// Compares all keys in a B-tree node with a given key and returns a bitmask of keys which are less
+// (__less) or greater (__greater) than it. A node has 16 4-byte keys or 8 8-byte keys, i.e. one
+// cache line. Since the node is sorted, the first mask is a run of low bits and the second one is
+// a run of high bits, and the position within the node is found with a single bit scan.
+template <class _Key,
+          bool _Integral = std::is_integral<_Key>::value && !std::is_same<_Key, bool>::value,
+          size_t _Size = sizeof(_Key)>
+struct __node_simd { static const bool enabled = false; };
+
+#if defined(__AVX512F__)
+
+template <class _Key>
+struct __node_simd<_Key, true, 4>
+{
+    static const bool enabled = true;
+    static __mmask16 __lt( __m512i _a, __m512i _b ) noexcept
+    { return std::is_unsigned<_Key>::value ? _mm512_cmplt_epu32_mask(_a, _b) :
+                                             _mm512_cmplt_epi32_mask(_a, _b); }
+    static unsigned __less( const _Key *_node, _Key _key ) noexcept
+    { return ( __lt(_mm512_loadu_si512(_node), _mm512_set1_epi32(int(_key))) ); }
+    static unsigned __greater( const _Key *_node, _Key _key ) noexcept
+    { return ( __lt(_mm512_set1_epi32(int(_key)), _mm512_loadu_si512(_node)) ); }
+};
+
+template <class _Key>
+struct __node_simd<_Key, true, 8>
+{
+    static const bool enabled = true;
+    static __mmask8 __lt( __m512i _a, __m512i _b ) noexcept
+    { return std::is_unsigned<_Key>::value ? _mm512_cmplt_epu64_mask(_a, _b) :
+                                             _mm512_cmplt_epi64_mask(_a, _b); }
+    static unsigned __less( const _Key *_node, _Key _key ) noexcept
+    { return ( __lt(_mm512_loadu_si512(_node), _mm512_set1_epi64((long long)_key)) ); }
+    static unsigned __greater( const _Key *_node, _Key _key ) noexcept
+    { return ( __lt(_mm512_set1_epi64((long long)_key), _mm512_loadu_si512(_node)) ); }
+};
+
+template <>
+struct __node_simd<float, false, sizeof(float)>
+{
+    static const bool enabled = true;
+    static unsigned __less( const float *_node, float _key ) noexcept
+    { return ( _mm512_cmp_ps_mask(_mm512_loadu_ps(_node), _mm512_set1_ps(_key),
+                                            _CMP_LT_OQ) ); }
+    static unsigned __greater( const float *_node, float _key ) noexcept
+    { return ( _mm512_cmp_ps_mask(_mm512_set1_ps(_key), _mm512_loadu_ps(_node),
+                                            _CMP_LT_OQ) ); }
+};
+
+template <>
+struct __node_simd<double, false, sizeof(double)>
+{
+    static const bool enabled = true;
+    static unsigned __less( const double *_node, double _key ) noexcept
+    { return ( _mm512_cmp_pd_mask(_mm512_loadu_pd(_node), _mm512_set1_pd(_key),
+                                            _CMP_LT_OQ) ); }
+    static unsigned __greater( const double *_node, double _key ) noexcept
+    { return ( _mm512_cmp_pd_mask(_mm512_set1_pd(_key), _mm512_loadu_pd(_node),
+                                            _CMP_LT_OQ) ); }
+};
+
+#elif defined(__AVX2__)
+
+// AVX2 has only signed integer comparisons, so unsigned keys are compared with flipped sign bits.
+template <class _Key>
+struct __node_simd<_Key, true, 4>
+{
+    static const bool enabled = true;
+    static __m256i __load( const _Key *_p ) noexcept
+    {
+        const __m256i __bias = _mm256_set1_epi32(
+            std::is_unsigned<_Key>::value ? std::numeric_limits<int>::min() : 0 );
+        return _mm256_xor_si256( _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_p)), __bias );
+    }
+    static unsigned __gt( __m256i _a, __m256i _b ) noexcept
+    { return (unsigned)_mm256_movemask_ps( _mm256_castsi256_ps(_mm256_cmpgt_epi32(_a, _b)) ); }
+    static unsigned __less( const _Key *_node, _Key _key ) noexcept
+    {
+        const _Key __k[8] = {_key, _key, _key, _key, _key, _key, _key, _key};
+        const __m256i __x = __load( __k );
+        return ( __gt(__x, __load(_node)) | (__gt(__x, __load(_node + 8)) << 8) );
+    }
+    static unsigned __greater( const _Key *_node, _Key _key ) noexcept
+    {
+        const _Key __k[8] = {_key, _key, _key, _key, _key, _key, _key, _key};
+        const __m256i __x = __load( __k );
+        return ( __gt(__load(_node), __x) | (__gt(__load(_node + 8), __x) << 8) );
+    }
+};
+
+template <class _Key>
+struct __node_simd<_Key, true, 8>
+{
+    static const bool enabled = true;
+    static __m256i __load( const _Key *_p ) noexcept
+    {
+        const __m256i __bias = _mm256_set1_epi64x(
+            std::is_unsigned<_Key>::value ? std::numeric_limits<long long>::min() : 0 );
+        return _mm256_xor_si256( _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_p)), __bias );
+    }
+    static unsigned __gt( __m256i _a, __m256i _b ) noexcept
+    { return (unsigned)_mm256_movemask_pd( _mm256_castsi256_pd(_mm256_cmpgt_epi64(_a, _b)) ); }
+    static unsigned __less( const _Key *_node, _Key _key ) noexcept
+    {
+        const _Key __k[4] = {_key, _key, _key, _key};
+        const __m256i __x = __load( __k );
+        return ( __gt(__x, __load(_node)) | (__gt(__x, __load(_node + 4)) << 4) );
+    }
+    static unsigned __greater( const _Key *_node, _Key _key ) noexcept
+    {
+        const _Key __k[4] = {_key, _key, _key, _key};
+        const __m256i __x = __load( __k );
+        return ( __gt(__load(_node), __x) | (__gt(__load(_node + 4), __x) << 4) );
+    }
+};
+
+template <>
+struct __node_simd<float, false, sizeof(float)>
+{
+    static const bool enabled = true;
+    static unsigned __lt( __m256 _a, __m256 _b ) noexcept
+    { return (unsigned)_mm256_movemask_ps( _mm256_cmp_ps(_a, _b, _CMP_LT_OQ) ); }
+    static unsigned __less( const float *_node, float _key ) noexcept
+    {
+        const __m256 __x = _mm256_set1_ps( _key );
+        return ( __lt(_mm256_loadu_ps(_node), __x) |
+                          (__lt(_mm256_loadu_ps(_node + 8), __x) << 8) );
+    }
+    static unsigned __greater( const float *_node, float _key ) noexcept
+    {
+        const __m256 __x = _mm256_set1_ps( _key );
+        return ( __lt(__x, _mm256_loadu_ps(_node)) |
+                          (__lt(__x, _mm256_loadu_ps(_node + 8)) << 8) );
+    }
+};
+
+template <>
+struct __node_simd<double, false, sizeof(double)>
+{
+    static const bool enabled = true;
+    static unsigned __lt( __m256d _a, __m256d _b ) noexcept
+    { return (unsigned)_mm256_movemask_pd( _mm256_cmp_pd(_a, _b, _CMP_LT_OQ) ); }
+    static unsigned __less( const double *_node, double _key ) noexcept
+    {
+        const __m256d __x = _mm256_set1_pd( _key );
+        return ( __lt(_mm256_loadu_pd(_node), __x) |
+                          (__lt(_mm256_loadu_pd(_node + 4), __x) << 4) );
+    }
+    static unsigned __greater( const double *_node, double _key ) noexcept
+    {
+        const __m256d __x = _mm256_set1_pd( _key );
+        return ( __lt(__x, _mm256_loadu_pd(_node)) |
+                          (__lt(__x, _mm256_loadu_pd(_node + 4)) << 4) );
+    }
+};
+
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+// SSE2 has only signed integer comparisons, so unsigned keys are compared with flipped sign bits.
+// There's no 64-bit integer comparison, such keys are compared one by one.
+template <class _Key>
+struct __node_simd<_Key, true, 4>
+{
+    static const bool enabled = true;
+    static __m128i __load( const _Key *_p ) noexcept
+    {
+        const __m128i __bias = _mm_set1_epi32(
+            std::is_unsigned<_Key>::value ? std::numeric_limits<int>::min() : 0 );
+        return _mm_xor_si128( _mm_loadu_si128(reinterpret_cast<const __m128i*>(_p)), __bias );
+    }
+    static unsigned __gt( __m128i _a, __m128i _b ) noexcept
+    { return (unsigned)_mm_movemask_ps( _mm_castsi128_ps(_mm_cmpgt_epi32(_a, _b)) ); }
+    static unsigned __less( const _Key *_node, _Key _key ) noexcept
+    {
+        const _Key __k[4] = {_key, _key, _key, _key};
+        const __m128i __x = __load( __k );
+        return ( __gt(__x, __load(_node))           | (__gt(__x, __load(_node + 4))  << 4) |
+                (__gt(__x, __load(_node + 8)) << 8) | (__gt(__x, __load(_node + 12)) << 12) );
+    }
+    static unsigned __greater( const _Key *_node, _Key _key ) noexcept
+    {
+        const _Key __k[4] = {_key, _key, _key, _key};
+        const __m128i __x = __load( __k );
+        return ( __gt(__load(_node), __x)           | (__gt(__load(_node + 4), __x)  << 4) |
+                (__gt(__load(_node + 8), __x) << 8) | (__gt(__load(_node + 12), __x) << 12) );
+    }
+};
+
+template <>
+struct __node_simd<float, false, sizeof(float)>
+{
+    static const bool enabled = true;
+    static unsigned __lt( __m128 _a, __m128 _b ) noexcept
+    { return (unsigned)_mm_movemask_ps( _mm_cmplt_ps(_a, _b) ); }
+    static unsigned __less( const float *_node, float _key ) noexcept
+    {
+        const __m128 __x = _mm_set1_ps( _key );
+        return ( __lt(_mm_loadu_ps(_node), __x) |
+                          (__lt(_mm_loadu_ps(_node + 4), __x) << 4) |
+                          (__lt(_mm_loadu_ps(_node + 8), __x) << 8) |
+                          (__lt(_mm_loadu_ps(_node + 12), __x) << 12) );
+    }
+    static unsigned __greater( const float *_node, float _key ) noexcept
+    {
+        const __m128 __x = _mm_set1_ps( _key );
+        return ( __lt(__x, _mm_loadu_ps(_node)) |
+                          (__lt(__x, _mm_loadu_ps(_node + 4)) << 4) |
+                          (__lt(__x, _mm_loadu_ps(_node + 8)) << 8) |
+                          (__lt(__x, _mm_loadu_ps(_node + 12)) << 12) );
+    }
+};
+
+template <>
+struct __node_simd<double, false, sizeof(double)>
+{
+    static const bool enabled = true;
+    static unsigned __lt( __m128d _a, __m128d _b ) noexcept
+    { return (unsigned)_mm_movemask_pd( _mm_cmplt_pd(_a, _b) ); }
+    static unsigned __less( const double *_node, double _key ) noexcept
+    {
+        const __m128d __x = _mm_set1_pd( _key );
+        return ( __lt(_mm_loadu_pd(_node), __x) |
+                          (__lt(_mm_loadu_pd(_node + 2), __x) << 2) |
+                          (__lt(_mm_loadu_pd(_node + 4), __x) << 4) |
+                          (__lt(_mm_loadu_pd(_node + 6), __x) << 6) );
+    }
+    static unsigned __greater( const double *_node, double _key ) noexcept
+    {
+        const __m128d __x = _mm_set1_pd( _key );
+        return ( __lt(__x, _mm_loadu_pd(_node)) |
+                          (__lt(__x, _mm_loadu_pd(_node + 2)) << 2) |
+                          (__lt(__x, _mm_loadu_pd(_node + 4)) << 4) |
+                          (__lt(__x, _mm_loadu_pd(_node + 6)) << 6) );
+    }
+};
+
+#endif
+
+// Number of keys in a full node which a descent passes by: the ones less than _key for a lower
+// bound and the ones not greater than _key for an upper bound.
+template <size_t _B, bool _Upper, class _Key, class _K2, class _Compare>
+inline size_t __node_rank( const _Key *_node, const _K2 &_key, const _Compare &_comp,
+                           std::false_type ) noexcept
+{
+    size_t __r = 0;
+    for( size_t __i = 0; __i < _B; ++__i )
+        __r += _Upper ? size_t( !_comp(_key, _node[__i]) ) :
+                        size_t( bool( _comp(_node[__i], _key) ) );
+    return __r;
+}
+
+template <size_t _B, bool _Upper, class _Key, class _K2, class _Compare>
+inline size_t __node_rank( const _Key *_node, const _K2 &_key, const _Compare &,
+                           std::true_type ) noexcept
+{
+    typedef __node_simd<_Key> __simd;
+    return _Upper ? __trailing_ones( ~__simd::__greater(_node, _key) & ((1u << _B) - 1) ) :
+                    __trailing_ones( __simd::__less(_node, _key) );
+}
+
+// Index of the first key which is not less than _key (_Upper == false) or greater than _key
+// (_Upper == true), or _count if there's no such key. All nodes except the last one are full, and
+// the last node has no children, so only the last step of a descent may deal with a partial node.
+template <size_t _B, bool _Upper, class _Key, class _K2, class _Compare>
+inline size_t __btree_bound( const _Key *_keys, size_t _count, const _K2 &_key,
+                             const _Compare &_comp ) noexcept
+{
+    typedef std::integral_constant<bool,
+        __node_simd<_Key>::enabled && _B * sizeof(_Key) == 64 &&
+        std::is_same<_Key, _K2>::value && __is_std_less<_Key, _Compare>::value> _Simd;
+
+    const size_t __full = _count / _B;
+    size_t __result = _count, __b = 0;
+    while( __b < __full ) {
+        const size_t __r = __node_rank<_B, _Upper>( _keys + __b * _B, _key, _comp, _Simd() );
+        __result = __r < _B ? __b * _B + __r : __result;
+        __b = __b * (_B + 1) + __r + 1;
+    }
+
+    if( __b == __full && __b * _B < _count ) {
+        const size_t __first = __b * _B, __size = _count - __first;
+        size_t __r = 0;
+        for( size_t __i = 0; __i < __size; ++__i )
+            __r += _Upper ? size_t( !_comp(_key, _keys[__first + __i]) ) :
+                            size_t( bool( _comp(_keys[__first + __i], _key) ) );
+        __result = __r < __size ? __first + __r : __result;
+    }
+    return __result;
+}
+
+}
+
+template <typename _Key, typename _Value, class _Compare = std::less<_Key> >
+class fixed_eytzinger_btree_map : private _Compare
+{
+public:
+    typedef size_t                                  size_type;
+    typedef std::pair<_Key,_Value>                  value_type;
+    typedef _Key                                    key_type;
+    typedef _Value                                  mapped_type;
+    typedef _Compare                                key_compare;
+    typedef __eytzinger::__proxy_iterator<_Key, _Value>         iterator;
+    typedef __eytzinger::__const_proxy_iterator<_Key, _Value>   const_iterator;
+    typedef std::pair<iterator,iterator>            range_pair;
+    typedef std::pair<const_iterator,const_iterator>const_range_pair;
+
+    // Number of keys in a node: as many as fit into a 64-byte cache line, but at least 2 and at
+    // most 16.
+    static const size_type node_size =
+        64 / sizeof(_Key) > 16 ? 16 : 64 / sizeof(_Key) < 2 ? 2 : 64 / sizeof(_Key);
+
+    static_assert( std::is_nothrow_move_constructible<key_type>::value,
+        "key_type must be nothrow move constructible" );
+    static_assert( std::is_nothrow_move_constructible<mapped_type>::value,
+        "mapped_type must be nothrow move constructible" );
+
+    // Construction
+    fixed_eytzinger_btree_map();
+    explicit fixed_eytzinger_btree_map( const _Compare& comp );
+    fixed_eytzinger_btree_map( const fixed_eytzinger_btree_map& _other );
+    fixed_eytzinger_btree_map( fixed_eytzinger_btree_map&& other );
+    fixed_eytzinger_btree_map(std::initializer_list<value_type> l,
+                              const _Compare& comp = _Compare() );
+    template<typename _InputIterator>
+    fixed_eytzinger_btree_map(_InputIterator begin,
+                              _InputIterator end,
+                              const _Compare& comp = _Compare() );
+
+
+    // Destruction
+    ~fixed_eytzinger_btree_map();
+
+
+    // Element access
+    mapped_type& at( const key_type& key );
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    mapped_type& at( const _K2& key );
+
+    const mapped_type& at( const key_type& key ) const;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const mapped_type& at( const _K2& key ) const;
+
+    mapped_type& operator[]( const key_type& key );
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    mapped_type& operator[]( const _K2& key );
+
+    const mapped_type& operator[]( const key_type& key ) const;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const mapped_type& operator[]( const _K2& key ) const;
+
+
+    // Iterators
+    iterator       begin()     noexcept;
+    iterator       end()       noexcept;
+    const_iterator begin()     const noexcept;
+    const_iterator end()       const noexcept;
+    const_iterator cbegin()    const noexcept;
+    const_iterator cend()      const noexcept;
+
+
+    // Modifiers
+    void clear() noexcept;
+    void swap( fixed_eytzinger_btree_map& other ) noexcept;
+
+
+    // Capacity
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    size_type max_size() const noexcept;
+
+
+    // Lookup
+    size_type count( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    size_type count( const _K2& key ) const noexcept;
+
+    iterator find( const key_type& key ) noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    iterator find(const _K2& key) noexcept;
+
+    const_iterator find( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_iterator find(const _K2& key) const noexcept;
+
+    range_pair equal_range( const key_type& key ) noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    range_pair equal_range(const _K2& key) noexcept;
+
+    const_range_pair equal_range( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_range_pair equal_range(const _K2& key) const noexcept;
+
+    iterator lower_bound( const key_type& key ) noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    iterator lower_bound(const _K2& key) noexcept;
+
+    const_iterator lower_bound( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_iterator lower_bound(const _K2& key) const noexcept;
+
+    iterator upper_bound( const key_type& key ) noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    iterator upper_bound(const _K2& key) noexcept;
+
+    const_iterator upper_bound( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_iterator upper_bound(const _K2& key) const noexcept;
+
+
+    // Assignment
+    fixed_eytzinger_btree_map& operator=( const fixed_eytzinger_btree_map& other );
+    fixed_eytzinger_btree_map& operator=( fixed_eytzinger_btree_map&& other ) noexcept;
+    fixed_eytzinger_btree_map& operator=( std::initializer_list<value_type> l );
+    template<typename _InputIterator>
+    void assign( _InputIterator begin, _InputIterator end );
+    void assign( std::initializer_list<value_type> l );
+
+private:
+    void init( std::vector<value_type> &_t );
+    void alloc_init( size_t _count );
+    value_type *init_fill( size_t _node, value_type *_first );
+    void deallocate() noexcept;
+    void construct_at( size_t _p, _Key &&_k, _Value &&_v ) noexcept;
+    void destroy_all() noexcept;
+    template <class _K2>
+    size_type lower_bound_index( const _K2 &_key ) const noexcept;
+    template <class _K2>
+    size_type upper_bound_index( const _K2 &_key ) const noexcept;
+    template <class _K2>
+    size_type find_index( const _K2 &_key ) const noexcept;
+    const _Compare &comparator() const noexcept { return *this; }
+
+    [[noreturn]] void throw_at() const
+    { throw std::out_of_range("fixed_eytzinger_btree_map::at:  key not found"); }
+    [[noreturn]] void throw_sb() const
+    { throw std::out_of_range("fixed_eytzinger_btree_map::operator[]:  key not found"); }
+
+    size_type    __m_count;
+    key_type    *__m_keys;
+    mapped_type *__m_values;
+};
+
+template <typename _Key, typename _Value, typename _Compare>
+const typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::size_type
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::node_size;
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::fixed_eytzinger_btree_map( ) :
+    fixed_eytzinger_btree_map( _Compare() )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+fixed_eytzinger_btree_map( const _Compare& _comp ) :
+    _Compare(_comp),
+    __m_count(0),
+    __m_keys(nullptr),
+    __m_values(nullptr)
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+fixed_eytzinger_btree_map( fixed_eytzinger_btree_map&& _other ) :
+    _Compare( _other ),
+    __m_count( _other.__m_count ),
+    __m_keys( _other.__m_keys ),
+    __m_values( _other.__m_values )
+{
+    _other.__m_count = 0;
+    _other.__m_keys = nullptr;
+    _other.__m_values = nullptr;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+fixed_eytzinger_btree_map( const fixed_eytzinger_btree_map& _other ) :
+    _Compare( _other ),
+    __m_count(0),
+    __m_keys(nullptr),
+    __m_values(nullptr)
+{
+    alloc_init( _other.__m_count );
+
+    _Key *last_key = __m_keys;
+    _Value *last_value = __m_values;
+    try {
+        for( size_type n = 0; n < __m_count; ++n, ++last_key )
+            ::new((void*)(__m_keys+n)) _Key( _other.__m_keys[n] );
+        for( size_type n = 0; n < __m_count; ++n, ++last_value )
+            ::new((void*)(__m_values+n)) _Value( _other.__m_values[n] );
+    }
+    catch( ... ) {
+        for( _Key *it = __m_keys; it < last_key; ++it )
+            it->~_Key();
+        for( _Value *it = __m_values; it < last_value; ++it )
+            it->~_Value();
+        deallocate();
+        std::rethrow_exception( std::current_exception() );
+    }
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+fixed_eytzinger_btree_map(std::initializer_list<value_type> _l,
+                          const _Compare& _comp):
+    _Compare(_comp),
+    __m_count(0),
+    __m_keys(nullptr),
+    __m_values(nullptr)
+{
+    std::vector<value_type> t{ std::begin(_l), std::end(_l) };
+    init( t );
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template<typename _InputIterator>
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+fixed_eytzinger_btree_map(_InputIterator _begin,
+                          _InputIterator _end,
+                          const _Compare& _comp ):
+    _Compare(_comp),
+    __m_count(0),
+    __m_keys(nullptr),
+    __m_values(nullptr)
+{
+    static_assert( std::is_constructible<value_type,
+                        typename std::iterator_traits<_InputIterator>::reference>::
+                        value,
+                    "incompatible iterator type");
+    std::vector<value_type> t{ _begin, _end };
+    init( t );
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+~fixed_eytzinger_btree_map()
+{
+    destroy_all();
+    deallocate();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+void fixed_eytzinger_btree_map<_Key, _Value, _Compare>::init( std::vector<value_type> &_t )
+{
+    const _Compare &__comp = comparator();
+    std::sort(std::begin(_t), std::end(_t), [&](const value_type &_v1, const value_type &_v2) {
+        return __comp(_v1.first, _v2.first);
+    });
+    _t.erase( std::unique( _t.begin(), _t.end(), [&](const value_type &_v1, const value_type &_v2){
+        return !__comp(_v1.first, _v2.first) && !__comp(_v2.first, _v1.first);
+    }), _t.end());
+
+    alloc_init( _t.size() );
+    init_fill( 0, _t.data() );
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+void fixed_eytzinger_btree_map<_Key, _Value, _Compare>::deallocate() noexcept
+{
+    std::allocator<char> __alloc;
+    __eytzinger::__deallocate_aligned( __alloc, __m_keys, __m_count * sizeof(_Key), 0 );
+    __eytzinger::__deallocate_aligned( __alloc, __m_values, __m_count * sizeof(_Value), 0 );
+    __m_keys = nullptr;
+    __m_values = nullptr;
+    __m_count = 0;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+void fixed_eytzinger_btree_map<_Key, _Value, _Compare>::destroy_all() noexcept
+{
+    for( _Key *_first = __m_keys, *_last = __m_keys + __m_count; _first != _last; _first++ )
+        _first->~_Key();
+    for( _Value *_first = __m_values, *_last = __m_values + __m_count; _first != _last; _first++ )
+        _first->~_Value();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+void fixed_eytzinger_btree_map<_Key, _Value, _Compare>::alloc_init( size_t _count )
+{
+    std::allocator<char> __alloc;
+    __m_count = _count;
+    try {
+        __m_keys = static_cast<_Key*>(
+            __eytzinger::__allocate_aligned(__alloc, _count * sizeof(_Key), 0) );
+        __m_values = static_cast<_Value*>(
+            __eytzinger::__allocate_aligned(__alloc, _count * sizeof(_Value), 0) );
+    } catch( ... ) {
+        deallocate();
+        std::rethrow_exception( std::current_exception() );
+    }
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+void fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+construct_at( size_t _p, _Key &&_k, _Value &&_v ) noexcept
+{
+    ::new((void*)(__m_keys+_p)) _Key( std::move(_k) );
+    ::new((void*)(__m_values+_p)) _Value( std::move(_v) );
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::value_type *
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+init_fill( size_t _node, value_type *_first )
+{
+    const size_type __base = _node * node_size;
+    if( __base >= __m_count )
+        return _first;
+
+    const size_type __size = std::min( node_size, __m_count - __base );
+    for( size_type __i = 0; __i < __size; ++__i ) {
+        _first = init_fill( _node * (node_size + 1) + __i + 1, _first ); // i-th child
+        construct_at( __base + __i, std::move(_first->first), std::move(_first->second) );
+        ++_first;
+    }
+    return init_fill( _node * (node_size + 1) + __size + 1, _first ); // last child
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+void fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+clear() noexcept
+{
+    destroy_all();
+    deallocate();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+void fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+swap( fixed_eytzinger_btree_map& other ) noexcept
+{
+    std::swap(__m_count, other.__m_count);
+    std::swap(__m_keys, other.__m_keys);
+    std::swap(__m_values, other.__m_values);
+    std::swap((_Compare&)*this, (_Compare&)other);
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+bool fixed_eytzinger_btree_map<_Key,_Value, _Compare>::empty() const noexcept
+{
+    return __m_count == 0;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::size_type
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::size() const noexcept
+{
+    return __m_count;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::size_type
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::max_size() const noexcept
+{
+    return std::numeric_limits<size_type>::max() / (node_size + 1);
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::begin() noexcept
+{
+    return iterator{ __m_keys, __m_values };
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::begin() const noexcept
+{
+    return const_iterator{ __m_keys, __m_values };
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::cbegin() const noexcept
+{
+    return begin();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::end() noexcept
+{
+    return iterator{ __m_keys + __m_count, __m_values + __m_count };
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::end() const noexcept
+{
+    return const_iterator{ __m_keys + __m_count, __m_values + __m_count };
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::cend() const noexcept
+{
+    return end();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <class _K2>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::size_type
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+lower_bound_index( const _K2 &_key ) const noexcept
+{
+    return __eytzinger::__btree_bound<node_size, false>(__m_keys, __m_count, _key, comparator());
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <class _K2>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::size_type
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+upper_bound_index( const _K2 &_key ) const noexcept
+{
+    return __eytzinger::__btree_bound<node_size, true>(__m_keys, __m_count, _key, comparator());
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <class _K2>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::size_type
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::find_index( const _K2 &_key ) const noexcept
+{
+    const size_type i = lower_bound_index(_key);
+    return i != __m_count && !comparator()(_key, __m_keys[i]) ? i : __m_count;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::lower_bound(const _Key& _key) const noexcept
+{
+    const size_type i = lower_bound_index(_key);
+    return const_iterator{__m_keys + i, __m_values + i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::lower_bound(const _K2& _key) const noexcept
+{
+    const size_type i = lower_bound_index(_key);
+    return const_iterator{__m_keys + i, __m_values + i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::lower_bound(const _Key& _key) noexcept
+{
+    const size_type i = lower_bound_index(_key);
+    return iterator{__m_keys + i, __m_values + i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::lower_bound(const _K2& _key) noexcept
+{
+    const size_type i = lower_bound_index(_key);
+    return iterator{__m_keys + i, __m_values + i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::upper_bound( const key_type& _key ) noexcept
+{
+    const size_type i = upper_bound_index(_key);
+    return iterator{__m_keys + i, __m_values + i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::upper_bound( const _K2& _key ) noexcept
+{
+    const size_type i = upper_bound_index(_key);
+    return iterator{__m_keys + i, __m_values + i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+upper_bound( const key_type& _key ) const noexcept
+{
+    const size_type i = upper_bound_index(_key);
+    return const_iterator{__m_keys + i, __m_values + i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::upper_bound( const _K2& _key ) const noexcept
+{
+    const size_type i = upper_bound_index(_key);
+    return const_iterator{__m_keys + i, __m_values + i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::find( const _Key& _key ) const noexcept
+{
+    const size_type i = find_index(_key);
+    return const_iterator{__m_keys + i, __m_values + i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::find( const _K2& _key ) const noexcept
+{
+    const size_type i = find_index(_key);
+    return const_iterator{__m_keys + i, __m_values + i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::find( const _Key& _key ) noexcept
+{
+    const size_type i = find_index(_key);
+    return iterator{__m_keys + i, __m_values + i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::iterator
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::find( const _K2& _key ) noexcept
+{
+    const size_type i = find_index(_key);
+    return iterator{__m_keys + i, __m_values + i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::range_pair
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::equal_range( const _Key& _key ) noexcept
+{
+    iterator __p = find(_key);
+    return {__p, __p != end() ? std::next(__p, 1) : __p};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::range_pair
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::equal_range( const _K2& _key ) noexcept
+{
+    iterator __p = find(_key);
+    return {__p, __p != end() ? std::next(__p, 1) : __p};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::const_range_pair
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::equal_range( const _Key& _key ) const noexcept
+{
+    const_iterator __p = find(_key);
+    return {__p, __p != end() ? std::next(__p, 1) : __p};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::const_range_pair
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::equal_range( const _K2& _key ) const noexcept
+{
+    const_iterator __p = find(_key);
+    return {__p, __p != end() ? std::next(__p, 1) : __p};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::size_type
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::count( const key_type& _key ) const noexcept
+{
+    return find_index(_key) != __m_count ? 1 : 0;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_btree_map<_Key, _Value, _Compare>::size_type
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::count( const _K2& _key ) const noexcept
+{
+    return find_index(_key) != __m_count ? 1 : 0;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+_Value &fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+at( const key_type &_key )
+{
+    const size_type i = find_index(_key);
+    if( i != __m_count )
+        return __m_values[i];
+    throw_at();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+_Value& fixed_eytzinger_btree_map<_Key, _Value, _Compare>::at( const _K2 &_key )
+{
+    const size_type i = find_index(_key);
+    if( i != __m_count )
+        return __m_values[i];
+    throw_at();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+const _Value &fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+at( const key_type &_key ) const
+{
+    const size_type i = find_index(_key);
+    if( i != __m_count )
+        return __m_values[i];
+    throw_at();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+const _Value& fixed_eytzinger_btree_map<_Key, _Value, _Compare>::at( const _K2 &_key ) const
+{
+    const size_type i = find_index(_key);
+    if( i != __m_count )
+        return __m_values[i];
+    throw_at();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+_Value& fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+operator[]( const key_type& _key )
+{
+    const size_type i = find_index(_key);
+    if( i != __m_count )
+        return __m_values[i];
+    throw_sb();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+_Value& fixed_eytzinger_btree_map<_Key, _Value, _Compare>::operator[]( const _K2 &_key )
+{
+    const size_type i = find_index(_key);
+    if( i != __m_count )
+        return __m_values[i];
+    throw_sb();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+const _Value& fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+operator[]( const key_type& _key ) const
+{
+    const size_type i = find_index(_key);
+    if( i != __m_count )
+        return __m_values[i];
+    throw_sb();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+const _Value& fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+operator[]( const _K2 &_key ) const
+{
+    const size_type i = find_index(_key);
+    if( i != __m_count )
+        return __m_values[i];
+    throw_sb();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>&
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+operator=( fixed_eytzinger_btree_map&& other ) noexcept
+{
+    clear();
+    swap(other);
+    return *this;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>&
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+operator=( const fixed_eytzinger_btree_map& other )
+{
+    fixed_eytzinger_btree_map __tmp {other};
+    swap(__tmp);
+    return *this;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>&
+fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+operator=( std::initializer_list<value_type> l )
+{
+    fixed_eytzinger_btree_map __tmp {l, comparator()};
+    swap(__tmp);
+    return *this;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template<typename _InputIterator>
+void fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+assign(_InputIterator _begin, _InputIterator _end)
+{
+    fixed_eytzinger_btree_map __tmp {_begin, _end, comparator()};
+    swap(__tmp);
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+void fixed_eytzinger_btree_map<_Key, _Value, _Compare>::
+assign( std::initializer_list<value_type> l )
+{
+    fixed_eytzinger_btree_map __tmp {l, comparator()};
+    swap(__tmp);
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+inline bool
+operator==(const fixed_eytzinger_btree_map<_Key, _Value, _Compare>& __x,
+           const fixed_eytzinger_btree_map<_Key, _Value, _Compare>& __y)
+{
+    return __x.size() == __y.size() && std::equal(__x.begin(), __x.end(), __y.begin());
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+inline bool
+operator!=(const fixed_eytzinger_btree_map<_Key, _Value, _Compare>& __x,
+           const fixed_eytzinger_btree_map<_Key, _Value, _Compare>& __y)
+{
+    return !(__x == __y);
+}
+
+namespace std
+{
+template <typename _Key, typename _Value, typename _Compare>
+inline void swap(fixed_eytzinger_btree_map<_Key, _Value, _Compare>& __x,
+                 fixed_eytzinger_btree_map<_Key, _Value, _Compare>& __y )
+{
+    __y.swap( __x );
+}
+}
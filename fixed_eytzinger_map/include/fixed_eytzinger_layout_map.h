@@ -0,0 +1,741 @@
+/* Copyright (c) 2017 Michael Kazakov <mike.kazakov@gmail.com>
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#pragma once
+
+#include "fixed_eytzinger_map.h"
+
+// fixed_eytzinger_layout_map is an immutable map with the same Eytzinger tree as
+// fixed_eytzinger_map and a choice of how keys and values are placed in memory, given by a layout
+// policy:
+// - fixed_eytzinger_split_layout keeps keys and values in separate arrays, as fixed_eytzinger_map
+//   does. A descent reads keys only, so a cache line holds the most nodes, but fetching the value
+//   of the found element costs another miss.
+// - fixed_eytzinger_interleaved_layout keeps every key next to its value, so the value comes with
+//   the last node a descent reads. Every level reads fewer nodes per line though, so this pays off
+//   with small values, when a lookup is followed by a fetch.
+// - fixed_eytzinger_hybrid_layout<levels> keeps the top levels split and interleaves the rest. The
+//   top levels stay compact and cached, and the nodes below, where most lookups end, bring their
+//   values along.
+// The layout only changes the speed of operations, not their results. Iterators follow the layout
+// order of elements, as those of fixed_eytzinger_map do.
+
+struct fixed_eytzinger_split_layout
+{
+    static const unsigned split_levels = 64;
+};
+
+struct fixed_eytzinger_interleaved_layout
+{
+    static const unsigned split_levels = 0;
+};
+
+template <unsigned _SplitLevels = 16>
+struct fixed_eytzinger_hybrid_layout
+{
+    static const unsigned split_levels = _SplitLevels;
+};
+
+namespace __eytzinger
+{
+
+template <class _Key, class _Value>
+struct __layout_node
+{
+    _Key    __m_key;
+    _Value  __m_value;
+};
+
+// Iterates over nodes [0, top) of a pair of key and value arrays followed by nodes [top, count) of
+// an array of interleaved nodes.
+template <class _Key, class _Value>
+struct __layout_iterator
+{
+    typedef std::bidirectional_iterator_tag         iterator_category;
+    typedef ptrdiff_t                               difference_type;
+    typedef std::pair<_Key, _Value>                 value_type;
+    typedef __const_pair_ptr_wrap<_Key, _Value>     pointer;
+    typedef std::pair<const _Key&, const _Value&>   reference;
+    typedef __layout_node<_Key, _Value>             node_type;
+
+    __layout_iterator() noexcept : k(nullptr), v(nullptr), n(nullptr), top(0), j(0)
+    { }
+    __layout_iterator(const _Key *_k, const _Value *_v, const node_type *_n, size_t _top,
+                      size_t _j) noexcept : k(_k), v(_v), n(_n), top(_top), j(_j)
+    { }
+    reference operator *() const noexcept
+    {
+        return j < top ? reference{ k[j], v[j] } :
+                         reference{ n[j - top].__m_key, n[j - top].__m_value };
+    }
+    pointer operator->() const noexcept
+    {
+        return j < top ? pointer{ k + j, v + j } :
+                         pointer{ &n[j - top].__m_key, &n[j - top].__m_value };
+    }
+    __layout_iterator &operator++() noexcept
+    {
+        ++j; return *this;
+    }
+    __layout_iterator operator++(int) noexcept
+    {
+        __layout_iterator __tmp = *this; ++(*this); return __tmp;
+    }
+    __layout_iterator &operator--() noexcept
+    {
+        --j; return *this;
+    }
+    __layout_iterator operator--(int) noexcept
+    {
+        __layout_iterator __tmp = *this; --(*this); return __tmp;
+    }
+    bool operator ==(const __layout_iterator &_rhs) const noexcept
+    {
+        return j == _rhs.j;
+    }
+    bool operator !=(const __layout_iterator &_rhs) const noexcept
+    {
+        return j != _rhs.j;
+    }
+private:
+    const _Key *k;
+    const _Value *v;
+    const node_type *n;
+    size_t top;
+    size_t j;
+};
+
+}
+
+template <typename _Key, typename _Value, class _Layout = fixed_eytzinger_split_layout,
+          class _Compare = std::less<_Key>,
+          class _Allocator = std::allocator< std::pair<_Key, _Value> > >
+class fixed_eytzinger_layout_map : private _Compare
+{
+public:
+    typedef fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>    base_type;
+    typedef size_t                                                      size_type;
+    typedef std::pair<_Key,_Value>                                      value_type;
+    typedef _Key                                                        key_type;
+    typedef _Value                                                      mapped_type;
+    typedef _Compare                                                    key_compare;
+    typedef _Allocator                                                  allocator_type;
+    typedef _Layout                                                     layout_type;
+    typedef __eytzinger::__layout_iterator<_Key, _Value>                const_iterator;
+    typedef std::pair<const_iterator,const_iterator>                    const_range_pair;
+    
+    // Construction
+    // The elements are laid out by fixed_eytzinger_map first and then moved into their places.
+    fixed_eytzinger_layout_map();
+    explicit fixed_eytzinger_layout_map( base_type base );
+    fixed_eytzinger_layout_map( std::initializer_list<value_type> l,
+                                const _Compare& comp = _Compare(),
+                                const _Allocator& alloc = _Allocator() );
+    template<typename _InputIterator>
+    fixed_eytzinger_layout_map( _InputIterator begin,
+                                _InputIterator end,
+                                const _Compare& comp = _Compare(),
+                                const _Allocator& alloc = _Allocator() );
+    
+    // Construction from input which is sorted and has unique keys.
+    // Throws std::invalid_argument if the input isn't sorted or has duplicates.
+    template<typename _InputIterator>
+    fixed_eytzinger_layout_map( fixed_eytzinger_sorted_unique_t,
+                                _InputIterator begin,
+                                _InputIterator end,
+                                const _Compare& comp = _Compare(),
+                                const _Allocator& alloc = _Allocator() );
+    
+    fixed_eytzinger_layout_map( const fixed_eytzinger_layout_map& other );
+    fixed_eytzinger_layout_map( fixed_eytzinger_layout_map&& other ) noexcept;
+    fixed_eytzinger_layout_map& operator=( const fixed_eytzinger_layout_map& other );
+    fixed_eytzinger_layout_map& operator=( fixed_eytzinger_layout_map&& other ) noexcept(
+        std::allocator_traits<_Allocator>::propagate_on_container_move_assignment::value );
+    ~fixed_eytzinger_layout_map();
+    
+    allocator_type get_allocator() const noexcept;
+    
+    
+    // Element access
+    mapped_type& at( const key_type& key );
+    const mapped_type& at( const key_type& key ) const;
+    mapped_type& operator[]( const key_type& key );
+    const mapped_type& operator[]( const key_type& key ) const;
+    
+    
+    // Iterators
+    const_iterator begin()     const noexcept;
+    const_iterator end()       const noexcept;
+    const_iterator cbegin()    const noexcept;
+    const_iterator cend()      const noexcept;
+    
+    
+    // Capacity
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    
+    
+    // Modifiers
+    void swap( fixed_eytzinger_layout_map& other ) noexcept;
+    
+    
+    // Observers
+    key_compare key_comp() const;
+    // Number of the top nodes whose keys and values are kept in separate arrays.
+    size_type split_size() const noexcept;
+    
+    
+    // Lookup
+    size_type count( const key_type& key ) const noexcept;
+    const_iterator find( const key_type& key ) const noexcept;
+    const_range_pair equal_range( const key_type& key ) const noexcept;
+    const_iterator lower_bound( const key_type& key ) const noexcept;
+    const_iterator upper_bound( const key_type& key ) const noexcept;
+    
+private:
+    typedef __eytzinger::__layout_node<_Key, _Value> node_type;
+    typedef std::allocator_traits<_Allocator> alloc_traits;
+    typedef __eytzinger::__alloc_propagation<_Allocator> propagation;
+    typedef typename alloc_traits::template rebind_alloc<char> byte_allocator_type;
+    typedef __eytzinger::__access access;
+    
+    fixed_eytzinger_layout_map( const _Compare& _comp, const _Allocator& _alloc ) noexcept;
+    template <typename _KeyAt, typename _ValueAt>
+    void init( size_type _count, _KeyAt _key_at, _ValueAt _value_at );
+    void move_init( fixed_eytzinger_layout_map &_other );
+    void clear() noexcept;
+    void deallocate() noexcept;
+    void destroy( size_type _n ) noexcept;
+    void swap_data( fixed_eytzinger_layout_map &_other ) noexcept;
+    size_type nodes_offset() const noexcept;
+    template <bool _Upper>
+    size_type bound_index( const key_type &_key ) const noexcept;
+    size_type find_index( const key_type &_key ) const noexcept;
+    const _Key &key_at( size_type _j ) const noexcept;
+    _Value &value_at( size_type _j ) const noexcept;
+    const_iterator at_index( size_type _j ) const noexcept;
+    static const bool has_split = _Layout::split_levels != 0;
+    static const bool has_nodes = _Layout::split_levels < 8 * sizeof(size_type);
+    static const unsigned key_prefetch_distance = fixed_eytzinger_prefetch_distance<_Key>::value;
+    static const unsigned node_prefetch_distance =
+        fixed_eytzinger_prefetch_distance<node_type>::value;
+    const _Compare &comparator() const noexcept { return *this; }
+    [[noreturn]] static void throw_at()
+    { throw std::out_of_range("fixed_eytzinger_layout_map::at:  key not found"); }
+    [[noreturn]] static void throw_sb()
+    { throw std::out_of_range("fixed_eytzinger_layout_map::operator[]:  key not found"); }
+    
+    size_type       __m_count;
+    size_type       __m_top;        // nodes [0, __m_top) are split, the rest are interleaved
+    _Key           *__m_keys;
+    _Value         *__m_values;
+    node_type      *__m_nodes;      // nodes from __m_top on
+    allocator_type  __m_alloc;
+};
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+fixed_eytzinger_layout_map() :
+    fixed_eytzinger_layout_map( base_type() )
+{
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+fixed_eytzinger_layout_map( base_type _base ) :
+    _Compare( _base.key_comp() ),
+    __m_count( 0 ),
+    __m_top( 0 ),
+    __m_keys( nullptr ),
+    __m_values( nullptr ),
+    __m_nodes( nullptr ),
+    __m_alloc( _base.get_allocator() )
+{
+    init( access::count(_base),
+          [&]( size_type _j ) -> _Key&& { return std::move(access::keys(_base)[_j]); },
+          [&]( size_type _j ) -> _Value&& { return std::move(access::values(_base)[_j]); } );
+}
+
+// An empty map with no storage, which init() fills.
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+fixed_eytzinger_layout_map( const _Compare& _comp, const _Allocator& _alloc ) noexcept :
+    _Compare( _comp ),
+    __m_count( 0 ),
+    __m_top( 0 ),
+    __m_keys( nullptr ),
+    __m_values( nullptr ),
+    __m_nodes( nullptr ),
+    __m_alloc( _alloc )
+{
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+fixed_eytzinger_layout_map( std::initializer_list<value_type> _l, const _Compare& _comp,
+                            const _Allocator& _alloc ) :
+    fixed_eytzinger_layout_map( base_type(_l, _comp, _alloc) )
+{
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+template <typename _InputIterator>
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+fixed_eytzinger_layout_map( _InputIterator _begin, _InputIterator _end, const _Compare& _comp,
+                            const _Allocator& _alloc ) :
+    fixed_eytzinger_layout_map( base_type(_begin, _end, _comp, _alloc) )
+{
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+template <typename _InputIterator>
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+fixed_eytzinger_layout_map( fixed_eytzinger_sorted_unique_t _tag, _InputIterator _begin,
+                            _InputIterator _end, const _Compare& _comp,
+                            const _Allocator& _alloc ) :
+    fixed_eytzinger_layout_map( base_type(_tag, _begin, _end, _comp, _alloc) )
+{
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+fixed_eytzinger_layout_map( const fixed_eytzinger_layout_map& _other ) :
+    _Compare( _other.comparator() ),
+    __m_count( 0 ),
+    __m_top( 0 ),
+    __m_keys( nullptr ),
+    __m_values( nullptr ),
+    __m_nodes( nullptr ),
+    __m_alloc( std::allocator_traits<_Allocator>::
+               select_on_container_copy_construction(_other.__m_alloc) )
+{
+    init( _other.__m_count,
+          [&]( size_type _j ) -> const _Key& { return _other.key_at(_j); },
+          [&]( size_type _j ) -> const _Value& { return _other.value_at(_j); } );
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+fixed_eytzinger_layout_map( fixed_eytzinger_layout_map&& _other ) noexcept :
+    _Compare( std::move(_other.comparator()) ),
+    __m_count( _other.__m_count ),
+    __m_top( _other.__m_top ),
+    __m_keys( _other.__m_keys ),
+    __m_values( _other.__m_values ),
+    __m_nodes( _other.__m_nodes ),
+    __m_alloc( std::move(_other.__m_alloc) )
+{
+    _other.__m_count = _other.__m_top = 0;
+    _other.__m_keys = nullptr;
+    _other.__m_values = nullptr;
+    _other.__m_nodes = nullptr;
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>&
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+operator=( const fixed_eytzinger_layout_map& _other )
+{
+    if( this != &_other ) {
+        fixed_eytzinger_layout_map __tmp( _other.comparator(),
+            propagation::__copy_allocator(__m_alloc, _other.__m_alloc) );
+        __tmp.init( _other.__m_count,
+                    [&]( size_type _j ) -> const _Key& { return _other.key_at(_j); },
+                    [&]( size_type _j ) -> const _Value& { return _other.value_at(_j); } );
+        clear();
+        propagation::__copy_assign( __m_alloc, _other.__m_alloc );
+        swap_data( __tmp );
+    }
+    return *this;
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>&
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+operator=( fixed_eytzinger_layout_map&& _other ) noexcept(
+    std::allocator_traits<_Allocator>::propagate_on_container_move_assignment::value )
+{
+    if( this == &_other )
+        return *this;
+    if( propagation::__can_take(__m_alloc, _other.__m_alloc) ) {
+        clear();
+        propagation::__move_assign( __m_alloc, _other.__m_alloc );
+        swap_data( _other );
+    }
+    else {
+        fixed_eytzinger_layout_map __tmp( _other.comparator(), __m_alloc );
+        __tmp.move_init( _other );
+        clear();
+        swap_data( __tmp );
+    }
+    return *this;
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+~fixed_eytzinger_layout_map()
+{
+    clear();
+}
+
+// Interleaved nodes are aligned so that every group of siblings starts at a cache line, as the
+// keys of fixed_eytzinger_map are. The first node of a level below the split ones, 2^d - 1, goes
+// to 2^d - (__m_top + 1) in the array, so an offset of __m_top + 1 nodes puts it at 2^d.
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::size_type
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+nodes_offset() const noexcept
+{
+    return ((__m_top + 1) * sizeof(node_type)) % 64;
+}
+
+// Constructs the node _j of the map from _key_at(_j) and _value_at(_j), in the same order.
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+template <typename _KeyAt, typename _ValueAt>
+void fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+init( size_type _count, _KeyAt _key_at, _ValueAt _value_at )
+{
+    __m_count = _count;
+    __m_top = has_nodes ? std::min( _count, (size_type(1) << _Layout::split_levels) - 1 ) : _count;
+    
+    byte_allocator_type __alloc( __m_alloc );
+    size_type __n = 0;
+    try {
+        __m_keys = static_cast<_Key*>( __eytzinger::__allocate_aligned(
+            __alloc, __m_top * sizeof(_Key), sizeof(_Key)) );
+        __m_values = static_cast<_Value*>( __eytzinger::__allocate_aligned(
+            __alloc, __m_top * sizeof(_Value), 0) );
+        __m_nodes = static_cast<node_type*>( __eytzinger::__allocate_aligned(
+            __alloc, (__m_count - __m_top) * sizeof(node_type), nodes_offset()) );
+        for( ; __n < __m_top; ++__n ) {
+            ::new((void*)(__m_keys + __n)) _Key( _key_at(__n) );
+            try {
+                ::new((void*)(__m_values + __n)) _Value( _value_at(__n) );
+            }
+            catch( ... ) {
+                __m_keys[__n].~_Key();
+                throw;
+            }
+        }
+        for( ; __n < __m_count; ++__n ) {
+            node_type *__node = __m_nodes + (__n - __m_top);
+            ::new((void*)&__node->__m_key) _Key( _key_at(__n) );
+            try {
+                ::new((void*)&__node->__m_value) _Value( _value_at(__n) );
+            }
+            catch( ... ) {
+                __node->__m_key.~_Key();
+                throw;
+            }
+        }
+    }
+    catch( ... ) {
+        destroy( __n );
+        deallocate();
+        __m_count = __m_top = 0;
+        std::rethrow_exception( std::current_exception() );
+    }
+}
+
+// Moves elements from a map whose allocator can't free this map's storage. Throws if the storage
+// can't be allocated, _other is left unchanged then.
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+void fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+move_init( fixed_eytzinger_layout_map& _other )
+{
+    init( _other.__m_count,
+          [&]( size_type _j ) -> _Key&& { return std::move(const_cast<_Key&>(_other.key_at(_j))); },
+          [&]( size_type _j ) -> _Value&& { return std::move(_other.value_at(_j)); } );
+    _other.clear();
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+void fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+clear() noexcept
+{
+    destroy( __m_count );
+    deallocate();
+    __m_count = __m_top = 0;
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+void fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+deallocate() noexcept
+{
+    byte_allocator_type __alloc( __m_alloc );
+    __eytzinger::__deallocate_aligned( __alloc, __m_keys, __m_top * sizeof(_Key), sizeof(_Key) );
+    __eytzinger::__deallocate_aligned( __alloc, __m_values, __m_top * sizeof(_Value), 0 );
+    __eytzinger::__deallocate_aligned( __alloc, __m_nodes,
+                                       (__m_count - __m_top) * sizeof(node_type), nodes_offset() );
+    __m_keys = nullptr;
+    __m_values = nullptr;
+    __m_nodes = nullptr;
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+void fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+destroy( size_type _n ) noexcept
+{
+    for( size_type __j = 0; __j < _n; ++__j ) {
+        if( __j < __m_top ) {
+            __m_keys[__j].~_Key();
+            __m_values[__j].~_Value();
+        }
+        else {
+            __m_nodes[__j - __m_top].__m_key.~_Key();
+            __m_nodes[__j - __m_top].__m_value.~_Value();
+        }
+    }
+}
+
+// Descends through the split levels and then through the interleaved ones. Either part is empty
+// with the split and the interleaved layouts.
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+template <bool _Upper>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::size_type
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+bound_index( const key_type &_key ) const noexcept
+{
+    const _Compare &__comp = comparator();
+    // as if the interleaved nodes were indexed from 0, for the prefetch only
+    const node_type *__origin = reinterpret_cast<const node_type*>(
+        reinterpret_cast<std::uintptr_t>(__m_nodes) - __m_top * sizeof(node_type) );
+    size_type __j = 0;
+    while( has_split && __j < __m_top ) {
+        // near the bottom of the split levels the descendants are interleaved nodes, which take
+        // a line per fewer levels
+        if( !has_nodes || ((__j + 1) << key_prefetch_distance) <= __m_top )
+            __eytzinger::__prefetch_descendants<key_prefetch_distance>( __m_keys, __j );
+        else if( ((__j + 1) << node_prefetch_distance) > __m_top )
+            __eytzinger::__prefetch_descendants<node_prefetch_distance>( __origin, __j );
+        __j = _Upper ? 2 * __j + 2 - size_type( bool( __comp(_key, __m_keys[__j]) ) ) :
+                       2 * __j + 1 + size_type( bool( __comp(__m_keys[__j], _key) ) );
+    }
+    while( has_nodes && __j < __m_count ) {
+        __eytzinger::__prefetch_descendants<node_prefetch_distance>( __origin, __j );
+        const _Key &__k = __m_nodes[__j - __m_top].__m_key;
+        __j = _Upper ? 2 * __j + 2 - size_type( bool( __comp(_key, __k) ) ) :
+                       2 * __j + 1 + size_type( bool( __comp(__k, _key) ) );
+    }
+    return __eytzinger::__descent_result( __j, __m_count );
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::size_type
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+find_index( const key_type &_key ) const noexcept
+{
+    const size_type __j = bound_index<false>( _key );
+    return __j != __m_count && !comparator()(_key, key_at(__j)) ? __j : __m_count;
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+const _Key &fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+key_at( size_type _j ) const noexcept
+{
+    return !has_nodes || (has_split && _j < __m_top) ? __m_keys[_j] :
+                                                       __m_nodes[_j - __m_top].__m_key;
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+_Value &fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+value_at( size_type _j ) const noexcept
+{
+    return !has_nodes || (has_split && _j < __m_top) ? __m_values[_j] :
+                                                       __m_nodes[_j - __m_top].__m_value;
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+at_index( size_type _j ) const noexcept
+{
+    return const_iterator{ __m_keys, __m_values, __m_nodes, __m_top, _j };
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::allocator_type
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+get_allocator() const noexcept
+{
+    return __m_alloc;
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+_Value &fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+at( const key_type &_key )
+{
+    const size_type __j = find_index( _key );
+    if( __j == __m_count )
+        throw_at();
+    return value_at( __j );
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+const _Value &fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+at( const key_type &_key ) const
+{
+    const size_type __j = find_index( _key );
+    if( __j == __m_count )
+        throw_at();
+    return value_at( __j );
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+_Value &fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+operator[]( const key_type &_key )
+{
+    const size_type __j = find_index( _key );
+    if( __j == __m_count )
+        throw_sb();
+    return value_at( __j );
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+const _Value &fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+operator[]( const key_type &_key ) const
+{
+    const size_type __j = find_index( _key );
+    if( __j == __m_count )
+        throw_sb();
+    return value_at( __j );
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::begin() const noexcept
+{
+    return at_index( 0 );
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::end() const noexcept
+{
+    return at_index( __m_count );
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::cbegin() const noexcept
+{
+    return begin();
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::cend() const noexcept
+{
+    return end();
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+bool fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+empty() const noexcept
+{
+    return __m_count == 0;
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::size_type
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::size() const noexcept
+{
+    return __m_count;
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+void fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+swap( fixed_eytzinger_layout_map& _other ) noexcept
+{
+    swap_data( _other );
+    propagation::__swap( __m_alloc, _other.__m_alloc );
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+void fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+swap_data( fixed_eytzinger_layout_map& _other ) noexcept
+{
+    std::swap( static_cast<_Compare&>(*this), static_cast<_Compare&>(_other) );
+    std::swap( __m_count, _other.__m_count );
+    std::swap( __m_top, _other.__m_top );
+    std::swap( __m_keys, _other.__m_keys );
+    std::swap( __m_values, _other.__m_values );
+    std::swap( __m_nodes, _other.__m_nodes );
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::key_compare
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::key_comp() const
+{
+    return comparator();
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::size_type
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+split_size() const noexcept
+{
+    return __m_top;
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::size_type
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+count( const key_type& _key ) const noexcept
+{
+    return find_index(_key) != __m_count;
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+find( const key_type& _key ) const noexcept
+{
+    return at_index( find_index(_key) );
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::const_range_pair
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+equal_range( const key_type& _key ) const noexcept
+{
+    const const_iterator __p = find(_key);
+    return {__p, __p == end() ? __p : std::next(__p, 1)};
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+lower_bound( const key_type& _key ) const noexcept
+{
+    return at_index( bound_index<false>(_key) );
+}
+
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>::
+upper_bound( const key_type& _key ) const noexcept
+{
+    return at_index( bound_index<true>(_key) );
+}
+
+namespace std
+{
+template <typename _Key, typename _Value, typename _Layout, typename _Compare, typename _Allocator>
+inline void swap( fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>& __x,
+                  fixed_eytzinger_layout_map<_Key, _Value, _Layout, _Compare, _Allocator>& __y )
+    noexcept
+{
+    __y.swap( __x );
+}
+}
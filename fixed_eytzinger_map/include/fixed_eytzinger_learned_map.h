@@ -0,0 +1,374 @@
+/* Copyright (c) 2017 Michael Kazakov <mike.kazakov@gmail.com>
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#pragma once
+
+#include "fixed_eytzinger_map.h"
+
+// fixed_eytzinger_learned_map is an immutable fixed_eytzinger_map of arithmetic keys with a
+// learned front end which shortens lookups when keys are spread evenly or smoothly, e.g.
+// timestamps or sequential ids. A linear model built from the smallest and the largest key maps
+// every key to one of about size() / segment_size segments of equal width, up to max_segments of
+// them. For each segment the front end keeps the root of the smallest subtree which contains the
+// result of a lookup of any key falling into it, so a lookup descends from that root rather than
+// from the root of the whole tree. The error bound is exact: whatever the distribution of keys,
+// lookups return the same results as those of the map, and only get no shorter where keys are
+// crowded into few segments.
+// The front end takes a machine word per segment. The levels it lets a lookup skip are the upper
+// ones, which mostly stay cached anyway, so the table is limited to stay in cache as well.
+
+namespace __eytzinger {
+
+// The closest common ancestor of nodes _a and _b.
+inline size_t __common_ancestor( size_t _a, size_t _b ) noexcept
+{
+    for( ++_a, ++_b; _a != _b; ) { // 1-based, a node is greater than any node above it
+        if( _a > _b )
+            _a >>= 1;
+        else
+            _b >>= 1;
+    }
+    return _a - 1;
+}
+
+}
+
+template <typename _Key, typename _Value, class _Compare = std::less<_Key>,
+          class _Allocator = std::allocator< std::pair<_Key, _Value> > >
+class fixed_eytzinger_learned_map
+{
+public:
+    typedef fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>    base_type;
+    typedef size_t                                                      size_type;
+    typedef std::pair<_Key,_Value>                                      value_type;
+    typedef _Key                                                        key_type;
+    typedef _Value                                                      mapped_type;
+    typedef _Compare                                                    key_compare;
+    typedef _Allocator                                                  allocator_type;
+    typedef typename base_type::const_iterator                          const_iterator;
+    typedef typename base_type::const_range_pair                        const_range_pair;
+    typedef typename base_type::const_ordered_iterator                  const_ordered_iterator;
+    typedef typename base_type::const_ordered_range                     const_ordered_range;
+    
+    static_assert( std::is_arithmetic<_Key>::value, "key_type must be arithmetic" );
+    static_assert( __eytzinger::__is_std_less<_Key, _Compare>::value,
+        "keys must be ordered by std::less" );
+    
+    // Average number of keys per segment of the front end, and the limit of segments.
+    static const size_type default_segment_size = 8;
+    static const size_type default_max_segments = 65536;
+    
+    // Construction
+    // Takes over the map and builds the front end in linear time.
+    fixed_eytzinger_learned_map();
+    explicit fixed_eytzinger_learned_map( base_type base,
+                                          size_type segment_size = default_segment_size,
+                                          size_type max_segments = default_max_segments );
+    
+    
+    // Element access
+    const mapped_type& at( const key_type& key ) const;
+    
+    
+    // Iterators
+    const_iterator begin()     const noexcept;
+    const_iterator end()       const noexcept;
+    const_iterator cbegin()    const noexcept;
+    const_iterator cend()      const noexcept;
+    const_ordered_iterator ordered_begin()     const noexcept;
+    const_ordered_iterator ordered_end()       const noexcept;
+    
+    
+    // Capacity
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    
+    
+    // Observers
+    key_compare key_comp() const;
+    const base_type& base() const noexcept;
+    size_type segments() const noexcept;
+    
+    
+    // Lookup
+    size_type count( const key_type& key ) const noexcept;
+    const_iterator find( const key_type& key ) const noexcept;
+    const_range_pair equal_range( const key_type& key ) const noexcept;
+    const_iterator lower_bound( const key_type& key ) const noexcept;
+    const_iterator upper_bound( const key_type& key ) const noexcept;
+    
+    // Elements with keys in [lo, hi), in the order of keys.
+    const_ordered_range range( const key_type& lo, const key_type& hi ) const noexcept;
+    
+private:
+    typedef std::allocator_traits<_Allocator> alloc_traits;
+    typedef __eytzinger::__access access;
+    typedef std::vector<size_type, typename alloc_traits::template rebind_alloc<size_type> >
+        starts_type;
+    
+    size_type segment( const key_type &_key ) const noexcept;
+    size_type lower_index( const key_type &_key ) const noexcept;
+    size_type find_index( const key_type &_key ) const noexcept;
+    const_iterator at_index( size_type _i ) const noexcept;
+    static const unsigned prefetch_distance = fixed_eytzinger_prefetch_distance<_Key>::value;
+    [[noreturn]] static void throw_at()
+    { throw std::out_of_range("fixed_eytzinger_learned_map::at:  key not found"); }
+    
+    base_type   __m_base;
+    starts_type __m_starts;     // the node to start the descent from, per segment
+    double      __m_min;        // the model: segment = (key - __m_min) * __m_scale
+    double      __m_scale;
+};
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::fixed_eytzinger_learned_map() :
+    fixed_eytzinger_learned_map( base_type() )
+{
+}
+
+// Segment s holds the keys whose ranks are in [first(s), first(s + 1)), where first(s) is the rank
+// of the first key in segment s or after it. The model is monotonic, so a lookup of a key from
+// segment s yields a rank in [first(s), first(s + 1)] as well. The smallest subtree which contains
+// all of them is the one rooted at the common ancestor of their first and last nodes in order:
+// a descent from it either ends in the subtree or climbs to the node which follows it.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_learned_map( base_type _base, size_type _segment_size, size_type _max_segments ) :
+    __m_base( std::move(_base) ),
+    __m_starts( __m_base.get_allocator() ),
+    __m_min( 0. ),
+    __m_scale( 0. )
+{
+    const size_type __count = access::count(__m_base);
+    const _Key *__keys = access::keys(__m_base);
+    size_type __segments = 1;
+    if( __count != 0 ) {
+        const double __min = double( __keys[__eytzinger::__inorder_first(__count)] );
+        const double __max = double( __keys[__eytzinger::__inorder_last(__count)] );
+        if( __max > __min ) {
+            __segments = std::min( __count / std::max(_segment_size, size_type(1)), _max_segments );
+            __segments = std::max( __segments, size_type(1) );
+            __m_min = __min;
+            __m_scale = double(__segments) / (__max - __min);
+        }
+    }
+    
+    // the first node of every segment in order, then the subtree to start from
+    __m_starts.assign( __segments, __count );
+    size_type __s = 0;
+    for( size_type __j = __eytzinger::__inorder_first(__count); __j != __count;
+         __j = __eytzinger::__inorder_next(__j, __count) )
+        for( const size_type __last = segment(__keys[__j]); __s <= __last; ++__s )
+            __m_starts[__s] = __j;
+    
+    size_type __past_end = 0; // a node a descent climbs from to the end
+    while( __past_end < __count )
+        __past_end = 2 * __past_end + 2;
+    const size_type __last = __eytzinger::__inorder_last( __count );
+    for( __s = 0; __s < __segments; ++__s ) {
+        const size_type __next = __s + 1 < __segments ? __m_starts[__s + 1] : __count;
+        if( __m_starts[__s] == __count )
+            __m_starts[__s] = __past_end;
+        else
+            __m_starts[__s] = __eytzinger::__common_ancestor( __m_starts[__s],
+                                                              __next != __count ? __next : __last );
+    }
+}
+
+// Maps the key to a segment in a way which preserves the order of keys, including keys out of the
+// range of the map.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::
+segment( const key_type &_key ) const noexcept
+{
+    const double __x = (double(_key) - __m_min) * __m_scale;
+    const size_type __last = __m_starts.size() - 1;
+    if( !(__x > 0.) ) // NaN too
+        return 0;
+    return __x < double(__last) ? size_type(__x) : __last;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::
+lower_index( const key_type &_key ) const noexcept
+{
+    return __eytzinger::__lower_bound<prefetch_distance>( access::keys(__m_base),
+                                                          access::count(__m_base), _key,
+                                                          access::comparator(__m_base),
+                                                          __m_starts[segment(_key)] );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::
+find_index( const key_type &_key ) const noexcept
+{
+    const size_type __i = lower_index( _key ), __count = access::count(__m_base);
+    return __i != __count && !access::comparator(__m_base)(_key, access::keys(__m_base)[__i]) ?
+        __i : __count;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::
+at_index( size_type _i ) const noexcept
+{
+    return const_iterator{access::keys(__m_base) + _i, access::values(__m_base) + _i};
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+const _Value &fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::
+at( const key_type &_key ) const
+{
+    const size_type __i = find_index( _key );
+    if( __i == access::count(__m_base) )
+        throw_at();
+    return access::values(__m_base)[__i];
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::begin() const noexcept
+{
+    return __m_base.begin();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::end() const noexcept
+{
+    return __m_base.end();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::cbegin() const noexcept
+{
+    return __m_base.cbegin();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::cend() const noexcept
+{
+    return __m_base.cend();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::const_ordered_iterator
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::ordered_begin() const noexcept
+{
+    return __m_base.ordered_begin();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::const_ordered_iterator
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::ordered_end() const noexcept
+{
+    return __m_base.ordered_end();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+bool fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::empty() const noexcept
+{
+    return __m_base.empty();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::size() const noexcept
+{
+    return __m_base.size();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::key_compare
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::key_comp() const
+{
+    return __m_base.key_comp();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+const typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::base_type&
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::base() const noexcept
+{
+    return __m_base;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::segments() const noexcept
+{
+    return __m_starts.size();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::
+count( const key_type& _key ) const noexcept
+{
+    return find_index(_key) != access::count(__m_base);
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::
+find( const key_type& _key ) const noexcept
+{
+    return at_index( find_index(_key) );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::const_range_pair
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::
+equal_range( const key_type& _key ) const noexcept
+{
+    const const_iterator __p = find(_key);
+    return {__p, __p == end() ? __p : std::next(__p, 1)};
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::
+lower_bound( const key_type& _key ) const noexcept
+{
+    return at_index( lower_index(_key) );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::
+upper_bound( const key_type& _key ) const noexcept
+{
+    return at_index( __eytzinger::__upper_bound<prefetch_distance>(
+        access::keys(__m_base), access::count(__m_base), _key, access::comparator(__m_base),
+        __m_starts[segment(_key)]) );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::const_ordered_range
+fixed_eytzinger_learned_map<_Key, _Value, _Compare, _Allocator>::
+range( const key_type& _lo, const key_type& _hi ) const noexcept
+{
+    const size_type __count = access::count(__m_base), __lo = lower_index(_lo);
+    size_type __hi = lower_index(_hi);
+    const _Key *__keys = access::keys(__m_base);
+    if( __lo == __count ||
+        (__hi != __count && access::comparator(__m_base)(__keys[__hi], __keys[__lo])) )
+        __hi = __lo;
+    return const_ordered_range{
+        const_ordered_iterator{ access::keys(__m_base), access::values(__m_base), __lo, __count },
+        const_ordered_iterator{ access::keys(__m_base), access::values(__m_base), __hi, __count } };
+}
@@ -14,29 +14,1704 @@
 #pragma once
 
 #include <stdexcept>
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <new>
 #include <vector>
 #include <utility>
 #include <functional>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <thread>
+#include <exception>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+#if defined(__linux__) && defined(FIXED_EYTZINGER_MAP_HUGE_PAGES_THRESHOLD)
+#include <sys/mman.h>
+#endif
+
+// Tag which tells that the input of a constructor or of assign() is already sorted by the
+// comparator and has no duplicate keys. Such input is laid out in linear time without sorting it
+// first. The ordering is still checked, and std::invalid_argument is thrown if it doesn't hold.
+struct fixed_eytzinger_sorted_unique_t { explicit fixed_eytzinger_sorted_unique_t() = default; };
+constexpr fixed_eytzinger_sorted_unique_t fixed_eytzinger_sorted_unique{};
+
+// Executor which runs tasks on std::threads, one thread per task at most. Any other executor, e.g.
+// an adapter for an existing thread pool, can be used for a parallel build as long as it provides
+// the same two members: concurrency() tells how many tasks are worth running at once, and
+// operator()(tasks, f) calls f(0), ..., f(tasks-1), possibly in parallel, and returns when all of
+// them are done.
+struct fixed_eytzinger_thread_executor
+{
+    explicit fixed_eytzinger_thread_executor(
+        unsigned _threads = std::thread::hardware_concurrency() ) noexcept
+        : threads(_threads ? _threads : 1) {}
+    
+    size_t concurrency() const noexcept { return threads; }
+    
+    template <typename _Function>
+    void operator()( size_t _tasks, _Function _f ) const
+    {
+        std::vector<std::thread> __workers;
+        std::vector<std::exception_ptr> __errors( _tasks );
+        auto __run = [&](size_t _i) {
+            try { _f(_i); }
+            catch( ... ) { __errors[_i] = std::current_exception(); }
+        };
+        for( size_t __i = 1; __i < _tasks; ++__i ) {
+            try { __workers.emplace_back( __run, __i ); }
+            catch( ... ) { __run( __i ); } // no more threads, do it here
+        }
+        if( _tasks != 0 )
+            __run( 0 );
+        for( auto &__w: __workers )
+            __w.join();
+        for( auto &__e: __errors )
+            if( __e )
+                std::rethrow_exception( __e );
+    }
+    
+    unsigned threads;
+};
 
-template <typename _Key, typename _Value, class _Compare = std::less<_Key> >
-class fixed_eytzinger_map : private _Compare
+// Tag which makes a constructor or assign() sort the input and lay it out in parallel, with
+// the given executor.
+template <typename _Executor>
+struct fixed_eytzinger_parallel_t
+{
+    _Executor executor;
+};
+
+template <typename _Executor>
+inline fixed_eytzinger_parallel_t<_Executor> fixed_eytzinger_parallel( _Executor _executor )
+{
+    return fixed_eytzinger_parallel_t<_Executor>{ std::move(_executor) };
+}
+
+inline fixed_eytzinger_parallel_t<fixed_eytzinger_thread_executor> fixed_eytzinger_parallel()
+{
+    return fixed_eytzinger_parallel( fixed_eytzinger_thread_executor() );
+}
+
+// How many levels below the current node a lookup prefetches. The default picks the deepest level
+// whose group of descendants fits into one 64-byte cache line, i.e. 4 levels (16 keys) for 4-byte
+// keys, 3 levels for 8-byte keys and so on. Specialize it to tune lookups for a particular key
+// type, 0 turns prefetching off.
+template <typename _Key>
+struct fixed_eytzinger_prefetch_distance
+{
+    static const unsigned value =
+        sizeof(_Key) <= 4  ? 4 :
+        sizeof(_Key) <= 8  ? 3 :
+        sizeof(_Key) <= 16 ? 2 :
+        sizeof(_Key) <= 32 ? 1 : 0;
+};
+
+namespace __eytzinger
+{
+
+inline void __prefetch( const void *_p ) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch( _p );
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch( static_cast<const char*>(_p), _MM_HINT_T0 );
+#else
+    (void)_p;
+#endif
+}
+
+// Prefetches the leftmost descendant of node _j which lies _Levels below it. Descendants may lay
+// past the end of the array, which is fine for a prefetch, so the address is never dereferenced.
+template <unsigned _Levels, class _Key>
+inline void __prefetch_descendants( const _Key *_keys, size_t _j ) noexcept
+{
+    if( _Levels != 0 ) {
+        const size_t __d = ((_j + 1) << _Levels) - 1;
+        __prefetch( reinterpret_cast<const void*>(
+            reinterpret_cast<std::uintptr_t>(_keys) + __d * sizeof(_Key) ) );
+    }
+}
+
+// Storage of keys and values starts at a cache line boundary. Keys are stored with an offset of
+// one key, i.e. as if they were indexed from 1, so that every group of siblings (nodes
+// 2^k..2^(k+1)-1 in 1-based numbering) starts at a cache line and a prefetched group of
+// descendants takes a single line.
+// On Linux, blocks of FIXED_EYTZINGER_MAP_HUGE_PAGES_THRESHOLD bytes or larger are aligned to a
+// 2Mb boundary and marked with MADV_HUGEPAGE, so that lookups in big maps don't spend their time
+// in page walks. The macro is not defined by default.
+inline size_t __block_alignment( size_t _length ) noexcept
+{
+#if defined(__linux__) && defined(FIXED_EYTZINGER_MAP_HUGE_PAGES_THRESHOLD)
+    if( _length >= size_t(FIXED_EYTZINGER_MAP_HUGE_PAGES_THRESHOLD) )
+        return size_t(2) << 20;
+#endif
+    (void)_length;
+    return 64;
+}
+
+// Number of bytes to request from an allocator for an aligned block of _size bytes which starts
+// _offset bytes past the alignment boundary. The block is preceded by the pointer returned by the
+// allocator.
+inline size_t __block_size( size_t _size, size_t _offset ) noexcept
+{
+    const size_t __length = _offset + _size, __align = __block_alignment( __length );
+    return ((__length + __align - 1) & ~(__align - 1)) + __align + sizeof(void*);
+}
+
+template <class _ByteAllocator>
+inline void *__allocate_aligned( _ByteAllocator &_alloc, size_t _size, size_t _offset )
+{
+    static_assert( std::is_same<typename std::allocator_traits<_ByteAllocator>::pointer,
+                                char*>::value,
+                   "allocators with fancy pointers are not supported" );
+    const size_t __length = _offset + _size, __align = __block_alignment( __length );
+    char *__raw = std::allocator_traits<_ByteAllocator>::allocate( _alloc,
+                                                                    __block_size(_size, _offset) );
+    const std::uintptr_t __base =
+        (reinterpret_cast<std::uintptr_t>(__raw) + sizeof(void*) + __align - 1) &
+        ~std::uintptr_t(__align - 1);
+    reinterpret_cast<char**>(__base)[-1] = __raw;
+#if defined(__linux__) && defined(FIXED_EYTZINGER_MAP_HUGE_PAGES_THRESHOLD)
+    if( __align > 64 ) // only a hint, failures are fine
+        ::madvise( reinterpret_cast<void*>(__base), (__length + __align - 1) & ~(__align - 1),
+                   MADV_HUGEPAGE );
+#endif
+    return reinterpret_cast<void*>(__base + _offset);
+}
+
+template <class _ByteAllocator>
+inline void __deallocate_aligned( _ByteAllocator &_alloc, void *_p, size_t _size,
+                                  size_t _offset ) noexcept
+{
+    if( _p )
+        std::allocator_traits<_ByteAllocator>::deallocate( _alloc,
+            reinterpret_cast<char**>(static_cast<char*>(_p) - _offset)[-1],
+            __block_size(_size, _offset) );
+}
+
+// number of trailing set bits in _v
+inline size_t __trailing_ones( size_t _v ) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctzll( ~(unsigned long long)_v );
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long __i;
+    _BitScanForward64( &__i, ~(unsigned __int64)_v );
+    return __i;
+#elif defined(_MSC_VER)
+    unsigned long __i;
+    _BitScanForward( &__i, ~(unsigned long)_v );
+    return __i;
+#else
+    size_t __n = 0;
+    for( ; _v & 1; _v >>= 1 )
+        ++__n;
+    return __n;
+#endif
+}
+
+// floor(log2(_v)), _v must not be zero
+inline size_t __log2( size_t _v ) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 8 * sizeof(unsigned long long) - 1 - (size_t)__builtin_clzll( _v );
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long __i;
+    _BitScanReverse64( &__i, _v );
+    return __i;
+#elif defined(_MSC_VER)
+    unsigned long __i;
+    _BitScanReverse( &__i, (unsigned long)_v );
+    return __i;
+#else
+    size_t __n = 0;
+    while( _v >>= 1 )
+        ++__n;
+    return __n;
+#endif
+}
+
+// Turns a node index where a descent fell off the tree into the index of the last node at which
+// the descent went left. With 1-based numbering the path is written in the bits of the index:
+// drop the trailing right turns and the left turn before them. Yields _count if there was none.
+inline size_t __descent_result( size_t _j, size_t _count ) noexcept
+{
+    const size_t __k = (_j + 1) >> (__trailing_ones(_j + 1) + 1);
+    return __k ? __k - 1 : _count;
+}
+
+// In-order traversal of a tree of _count nodes, i.e. nodes in the order of their keys. A step takes
+// O(1) time on average, and __inorder_next yields _count after the last node.
+inline size_t __inorder_first( size_t _count ) noexcept
+{
+    size_t __i = 1;
+    while( 2 * __i <= _count )
+        __i *= 2;
+    return _count ? __i - 1 : 0;
+}
+
+inline size_t __inorder_next( size_t _j, size_t _count ) noexcept
+{
+    size_t __i = _j + 1; // 1-based
+    if( 2 * __i + 1 <= _count ) { // the leftmost node of the right subtree
+        __i = 2 * __i + 1;
+        while( 2 * __i <= _count )
+            __i *= 2;
+    }
+    else { // the closest ancestor whose left subtree is done
+        __i >>= __trailing_ones(__i) + 1;
+    }
+    return __i ? __i - 1 : _count;
+}
+
+inline size_t __inorder_last( size_t _count ) noexcept
+{
+    size_t __i = 1;
+    while( 2 * __i + 1 <= _count )
+        __i = 2 * __i + 1;
+    return _count ? __i - 1 : 0;
+}
+
+inline size_t __inorder_prev( size_t _j, size_t _count ) noexcept
+{
+    if( _j == _count )
+        return __inorder_last( _count );
+    size_t __i = _j + 1; // 1-based
+    if( 2 * __i <= _count ) { // the rightmost node of the left subtree
+        __i = 2 * __i;
+        while( 2 * __i + 1 <= _count )
+            __i = 2 * __i + 1;
+    }
+    else { // the closest ancestor whose right subtree this node is in
+        __i >>= __trailing_ones(~__i) + 1;
+    }
+    return __i ? __i - 1 : _count;
+}
+
+// Number of nodes in the subtree rooted at _j.
+inline size_t __subtree_size( size_t _j, size_t _count ) noexcept
+{
+    size_t __size = 0;
+    for( size_t __width = 1; _j < _count; _j = 2 * _j + 1, __width *= 2 )
+        __size += std::min( __width, _count - _j );
+    return __size;
+}
+
+// Index of the node which goes _k-th in order, _k must be less than _count. Takes O(log^2 n).
+inline size_t __inorder_at( size_t _k, size_t _count ) noexcept
+{
+    size_t __j = 0;
+    while( true ) {
+        const size_t __left = __subtree_size( 2 * __j + 1, _count );
+        if( _k == __left )
+            return __j;
+        if( _k < __left ) {
+            __j = 2 * __j + 1;
+        }
+        else {
+            _k -= __left + 1;
+            __j = 2 * __j + 2;
+        }
+    }
+}
+
+// Walks a sequence of iterators, or of (key, iterator) pairs, and yields the elements they point
+// to.
+template <typename _Iterator, typename _Entry = _Iterator>
+struct __indirect_iterator
+{
+    typedef typename std::iterator_traits<_Iterator>::reference reference;
+    const _Entry *__m_i;
+    reference operator*() const { return *__target(*__m_i); }
+    __indirect_iterator &operator++() noexcept { ++__m_i; return *this; }
+    static const _Iterator &__target( const _Iterator &_i ) noexcept { return _i; }
+    template <typename _Key>
+    static const _Iterator &__target( const std::pair<_Key, _Iterator> &_e ) noexcept
+    { return _e.second; }
+};
+
+// Number of levels from the root which are complete, i.e. floor(log2(_count + 1)).
+inline size_t __complete_levels( size_t _count ) noexcept
+{
+    return __log2( _count + 1 );
+}
+
+// Index of the node which goes _k-th in order, _k must be less than _count. Same as __inorder_at,
+// but in O(1): the nodes of the incomplete last level take every other place among the first
+// 2 * (their number) in order, and the rest of the nodes form a complete tree. In a complete tree
+// of L levels, the i-th node in order, 1-based, sits on the level which the trailing zeros of i
+// count up from the bottom, and its place on that level is given by the bits above them.
+inline size_t __inorder_node( size_t _k, size_t _count ) noexcept
+{
+    const size_t __complete = __complete_levels( _count );
+    const size_t __last = _count - ((size_t(1) << __complete) - 1);
+    const size_t __below = size_t( _k < 2 * __last ); // whether the node is on the last level
+    const size_t __levels = __complete + __below;
+    _k -= __last & (__below - 1);
+    const size_t __i = _k + 1;
+    const size_t __zeros = __trailing_ones( ~__i );
+    return ((size_t(1) << (__levels - 1 - __zeros)) | (__i >> (__zeros + 1))) - 1;
+}
+
+template <class _Key, class _Compare>
+struct __is_std_less : std::is_same<_Compare, std::less<_Key>> {};
+#if __cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+template <class _Key>
+struct __is_std_less<_Key, std::less<>> : std::true_type {};
+#endif
+
+// Small trees of arithmetic keys ordered by std::less are searched with a linear scan instead of a
+// descent: the number of keys less than the looked up one is counted by comparing whole vectors of
+// keys at once, regardless of their order, and gives the in-order position of the result. A scan
+// of a cache line or two takes less time than the chain of dependent loads of a descent.
+// SSE2 compares 32-bit integers and floating point numbers, 64-bit integers need SSE4.2 or AVX2.
+// Unsigned keys are compared with flipped sign bits, as in the vectorized descents below.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+template <bool _Unsigned>
+struct __scan_epi32
+{
+    typedef __m128i __vector;
+    typedef __m128i __counter;
+    static const size_t width = 4;
+    
+    static __m128i __bias() noexcept
+    { return _mm_set1_epi32( _Unsigned ? std::numeric_limits<int>::min() : 0 ); }
+    static __m128i __splat( const void *_q ) noexcept
+    { return _mm_xor_si128( _mm_set1_epi32(*static_cast<const int*>(_q)), __bias() ); }
+    static __m128i __load( const void *_k ) noexcept
+    { return _mm_xor_si128( _mm_loadu_si128(static_cast<const __m128i*>(_k)), __bias() ); }
+    static __m128i __count_less( __m128i _n, __m128i _a, __m128i _b ) noexcept
+    { return _mm_sub_epi32( _n, _mm_cmplt_epi32(_a, _b) ); }
+    static size_t __sum( __m128i _n ) noexcept
+    {
+        _n = _mm_add_epi32( _n, _mm_shuffle_epi32(_n, _MM_SHUFFLE(1, 0, 3, 2)) );
+        _n = _mm_add_epi32( _n, _mm_shuffle_epi32(_n, _MM_SHUFFLE(2, 3, 0, 1)) );
+        return size_t( _mm_cvtsi128_si32(_n) );
+    }
+};
+
+struct __scan_ps
+{
+    typedef __m128  __vector;
+    typedef __m128i __counter;
+    static const size_t width = 4;
+    
+    static __m128 __splat( const void *_q ) noexcept
+    { return _mm_set1_ps( *static_cast<const float*>(_q) ); }
+    static __m128 __load( const void *_k ) noexcept
+    { return _mm_loadu_ps( static_cast<const float*>(_k) ); }
+    static __m128i __count_less( __m128i _n, __m128 _a, __m128 _b ) noexcept
+    { return _mm_sub_epi32( _n, _mm_castps_si128(_mm_cmplt_ps(_a, _b)) ); }
+    static size_t __sum( __m128i _n ) noexcept
+    { return __scan_epi32<false>::__sum( _n ); }
+};
+
+struct __scan_pd
+{
+    typedef __m128d __vector;
+    typedef __m128i __counter;
+    static const size_t width = 2;
+    
+    static __m128d __splat( const void *_q ) noexcept
+    { return _mm_set1_pd( *static_cast<const double*>(_q) ); }
+    static __m128d __load( const void *_k ) noexcept
+    { return _mm_loadu_pd( static_cast<const double*>(_k) ); }
+    static __m128i __count_less( __m128i _n, __m128d _a, __m128d _b ) noexcept
+    { return _mm_sub_epi64( _n, _mm_castpd_si128(_mm_cmplt_pd(_a, _b)) ); }
+    static size_t __sum( __m128i _n ) noexcept
+    { return size_t( _mm_cvtsi128_si32(_n) + _mm_cvtsi128_si32(_mm_srli_si128(_n, 8)) ); }
+};
+
+#if defined(__SSE4_2__) || defined(__AVX2__)
+template <bool _Unsigned>
+struct __scan_epi64
+{
+    typedef __m128i __vector;
+    typedef __m128i __counter;
+    static const size_t width = 2;
+    
+    static __m128i __bias() noexcept
+    { return _mm_set1_epi64x( _Unsigned ? std::numeric_limits<long long>::min() : 0 ); }
+    static __m128i __splat( const void *_q ) noexcept
+    { return _mm_xor_si128( _mm_set1_epi64x(*static_cast<const long long*>(_q)), __bias() ); }
+    static __m128i __load( const void *_k ) noexcept
+    { return _mm_xor_si128( _mm_loadu_si128(static_cast<const __m128i*>(_k)), __bias() ); }
+    static __m128i __count_less( __m128i _n, __m128i _a, __m128i _b ) noexcept
+    { return _mm_sub_epi64( _n, _mm_cmpgt_epi64(_b, _a) ); }
+    static size_t __sum( __m128i _n ) noexcept
+    { return __scan_pd::__sum( _n ); }
+};
+#endif
+#endif
+
+// Picks the scan operations for a key type, void when there are none.
+template <class _Key,
+          bool _Integral = std::is_integral<_Key>::value && !std::is_same<_Key, bool>::value,
+          size_t _Size = sizeof(_Key)>
+struct __scan_ops { typedef void type; };
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+template <class _Key>
+struct __scan_ops<_Key, true, 4> { typedef __scan_epi32<std::is_unsigned<_Key>::value> type; };
+#if defined(__SSE4_2__) || defined(__AVX2__)
+template <class _Key>
+struct __scan_ops<_Key, true, 8> { typedef __scan_epi64<std::is_unsigned<_Key>::value> type; };
+#endif
+template <>
+struct __scan_ops<float, false, sizeof(float)> { typedef __scan_ps type; };
+template <>
+struct __scan_ops<double, false, sizeof(double)> { typedef __scan_pd type; };
+#endif
+
+// Whether a lookup of a _K2 key in a small tree is done with a linear scan.
+template <class _Key, class _K2, class _Compare>
+struct __linear_scan : std::integral_constant<bool,
+    !std::is_void<typename __scan_ops<_Key>::type>::value &&
+    std::is_same<_Key, _K2>::value &&
+    __is_std_less<_Key, _Compare>::value> {};
+
+// Trees of up to this many keys are scanned rather than descended.
+static const size_t __linear_scan_max = 32;
+
+template <bool _Upper, class _Ops, class _Key, class _Compare>
+inline size_t __linear_bound( const _Key *_keys, size_t _count, const _Key &_key,
+                              const _Compare &_comp ) noexcept
+{
+    const typename _Ops::__vector __q = _Ops::__splat( &_key );
+    typename _Ops::__counter __n = typename _Ops::__counter();
+    size_t __i = 0;
+    for( ; __i + _Ops::width <= _count; __i += _Ops::width ) {
+        const typename _Ops::__vector __k = _Ops::__load( _keys + __i );
+        __n = _Upper ? _Ops::__count_less( __n, __q, __k ) : _Ops::__count_less( __n, __k, __q );
+    }
+    size_t __r = _Ops::__sum( __n );
+    for( ; __i < _count; ++__i )
+        __r += size_t( bool(_Upper ? _comp(_key, _keys[__i]) : _comp(_keys[__i], _key)) );
+    if( _Upper ) // __r counted the keys greater than _key
+        __r = _count - __r;
+    return __r < _count ? __inorder_node( __r, _count ) : _count;
+}
+
+// Index of the first key which is not less than _key, or _count if there's no such key.
+// The descent can start at the root of a subtree _j if the result is known to be one of its nodes
+// or the node which follows them in order.
+template <unsigned _Prefetch, class _Key, class _K2, class _Compare>
+inline size_t __lower_bound( const _Key *_keys, size_t _count, const _K2 &_key,
+                             const _Compare &_comp, size_t _j, std::false_type ) noexcept
+{
+    while( _j < _count ) {
+        __prefetch_descendants<_Prefetch>( _keys, _j );
+        _j = 2 * _j + 1 + size_t( bool( _comp(_keys[_j], _key) ) ); // left or right branch
+    }
+    return __descent_result( _j, _count );
+}
+
+template <unsigned _Prefetch, class _Key, class _K2, class _Compare>
+inline size_t __lower_bound( const _Key *_keys, size_t _count, const _K2 &_key,
+                             const _Compare &_comp, size_t _j, std::true_type ) noexcept
+{
+    if( _j == 0 && _count <= __linear_scan_max )
+        return __linear_bound<false, typename __scan_ops<_Key>::type>( _keys, _count, _key, _comp );
+    return __lower_bound<_Prefetch>( _keys, _count, _key, _comp, _j, std::false_type() );
+}
+
+template <unsigned _Prefetch, class _Key, class _K2, class _Compare>
+inline size_t __lower_bound( const _Key *_keys, size_t _count, const _K2 &_key,
+                             const _Compare &_comp, size_t _j = 0 ) noexcept
+{
+    return __lower_bound<_Prefetch>( _keys, _count, _key, _comp, _j,
+                                     __linear_scan<_Key, _K2, _Compare>() );
+}
+
+// Index of the first key which is greater than _key, or _count if there's no such key.
+template <unsigned _Prefetch, class _Key, class _K2, class _Compare>
+inline size_t __upper_bound( const _Key *_keys, size_t _count, const _K2 &_key,
+                             const _Compare &_comp, size_t _j, std::false_type ) noexcept
+{
+    while( _j < _count ) {
+        __prefetch_descendants<_Prefetch>( _keys, _j );
+        _j = 2 * _j + 2 - size_t( bool( _comp(_key, _keys[_j]) ) ); // right or left branch
+    }
+    return __descent_result( _j, _count );
+}
+
+template <unsigned _Prefetch, class _Key, class _K2, class _Compare>
+inline size_t __upper_bound( const _Key *_keys, size_t _count, const _K2 &_key,
+                             const _Compare &_comp, size_t _j, std::true_type ) noexcept
+{
+    if( _j == 0 && _count <= __linear_scan_max )
+        return __linear_bound<true, typename __scan_ops<_Key>::type>( _keys, _count, _key, _comp );
+    return __upper_bound<_Prefetch>( _keys, _count, _key, _comp, _j, std::false_type() );
+}
+
+template <unsigned _Prefetch, class _Key, class _K2, class _Compare>
+inline size_t __upper_bound( const _Key *_keys, size_t _count, const _K2 &_key,
+                             const _Compare &_comp, size_t _j = 0 ) noexcept
+{
+    return __upper_bound<_Prefetch>( _keys, _count, _key, _comp, _j,
+                                     __linear_scan<_Key, _K2, _Compare>() );
+}
+
+template <class _Compare, class = void>
+struct __is_transparent : std::false_type {};
+
+template <class _Compare>
+struct __is_transparent<_Compare, typename std::conditional<true, void,
+    typename _Compare::is_transparent>::type> : std::true_type {};
+
+// Number of descents a batched lookup advances in lockstep.
+static const size_t __batch_group = 32;
+
+// Runs lower bound descents for the keys in [_first, _last) in groups, advancing every descent of a
+// group by one level before moving to the next level. The node each descent visits next is
+// prefetched right away, so the cache misses of the whole group overlap. Reports the result of
+// every lookup as _sink(iterator to the key, index of the first key not less than it).
+template <class _Key, class _ForwardIterator, class _Compare, class _Sink>
+inline void __lower_bound_batch( const _Key *_keys, size_t _count,
+                                 _ForwardIterator _first, _ForwardIterator _last,
+                                 const _Compare &_comp, _Sink &&_sink, std::false_type )
+{
+    // all nodes of the first __levels levels exist, so descending through them needs no checks
+    const size_t __levels = __complete_levels( _count );
+    
+    _ForwardIterator __k[__batch_group];
+    size_t __j[__batch_group];
+    while( _first != _last ) {
+        size_t __n = 0;
+        for( ; __n < __batch_group && _first != _last; ++__n, ++_first ) {
+            __k[__n] = _first;
+            __j[__n] = 0;
+        }
+        
+        for( size_t __l = 0; __l < __levels; ++__l )
+            for( size_t __i = 0; __i < __n; ++__i ) {
+                __j[__i] = 2 * __j[__i] + 1 + size_t( bool( _comp(_keys[__j[__i]], *__k[__i]) ) );
+                __prefetch( reinterpret_cast<const void*>(
+                    reinterpret_cast<std::uintptr_t>(_keys) + __j[__i] * sizeof(_Key) ) );
+            }
+        
+        for( size_t __i = 0; __i < __n; ++__i ) {
+            if( __j[__i] < _count ) // the last level is incomplete
+                __j[__i] = 2 * __j[__i] + 1 + size_t( bool( _comp(_keys[__j[__i]], *__k[__i]) ) );
+            _sink( __k[__i], __descent_result( __j[__i], _count ) );
+        }
+    }
+}
+
+// Vectorized descents for arithmetic keys ordered by std::less. Every lane of a vector runs its own
+// descent: keys of the current nodes are fetched with a gather and compared with the looked up keys
+// at once, producing the next node index of each lane. The instruction set is chosen at compile
+// time, without AVX2 or AVX-512 the scalar batch lookup is used.
+
+#if defined(__AVX512F__)
+
+// Full gathers are spelled as masked ones with an explicit source, the unmasked intrinsics trip
+// -Wmaybe-uninitialized in some versions of GCC.
+template <bool _Unsigned>
+struct __simd_epi32
+{
+    typedef __m512i __vector;
+    typedef __m512i __index;
+    static const size_t width = 16;
+    static const size_t max_count = size_t(1) << 30;
+    
+    static __m512i __load( const void *_q ) noexcept
+    { return _mm512_loadu_si512( _q ); }
+    static __mmask16 __less( __m512i _k, __m512i _q ) noexcept
+    { return _Unsigned ? _mm512_cmplt_epu32_mask(_k, _q) : _mm512_cmplt_epi32_mask(_k, _q); }
+    static __m512i __step_from( __m512i _j, __mmask16 _right ) noexcept
+    {
+        const __m512i __one = _mm512_set1_epi32( 1 );
+        const __m512i __left = _mm512_add_epi32( _mm512_add_epi32(_j, _j), __one );
+        return _mm512_mask_add_epi32( __left, _right, __left, __one );
+    }
+    static __m512i __step( const void *_keys, __m512i _j, __m512i _q ) noexcept
+    {
+        const __m512i __k =
+            _mm512_mask_i32gather_epi32( _mm512_setzero_si512(), 0xFFFF, _j, _keys, 4 );
+        return __step_from( _j, __less(__k, _q) );
+    }
+    static __m512i __last_step( const void *_keys, __m512i _j, __m512i _q, size_t _count ) noexcept
+    {
+        const __mmask16 __valid = _mm512_cmplt_epu32_mask( _j, _mm512_set1_epi32(int(_count)) );
+        const __m512i __k =
+            _mm512_mask_i32gather_epi32( _mm512_setzero_si512(), __valid, _j, _keys, 4 );
+        return _mm512_mask_mov_epi32( _j, __valid, __step_from(_j, __less(__k, _q)) );
+    }
+    static void __store( __m512i _j, size_t *_out ) noexcept
+    {
+        uint32_t __t[width];
+        _mm512_storeu_si512( __t, _j );
+        for( size_t __i = 0; __i < width; ++__i )
+            _out[__i] = __t[__i];
+    }
+};
+
+struct __simd_ps
+{
+    typedef __m512  __vector;
+    typedef __m512i __index;
+    static const size_t width = 16;
+    static const size_t max_count = size_t(1) << 30;
+    
+    static __m512 __load( const void *_q ) noexcept
+    { return _mm512_loadu_ps( _q ); }
+    static __m512i __step( const void *_keys, __m512i _j, __m512 _q ) noexcept
+    {
+        const __m512 __k = _mm512_mask_i32gather_ps( _mm512_setzero_ps(), 0xFFFF, _j, _keys, 4 );
+        return __simd_epi32<false>::__step_from( _j, _mm512_cmp_ps_mask(__k, _q, _CMP_LT_OQ) );
+    }
+    static __m512i __last_step( const void *_keys, __m512i _j, __m512 _q, size_t _count ) noexcept
+    {
+        const __mmask16 __valid = _mm512_cmplt_epu32_mask( _j, _mm512_set1_epi32(int(_count)) );
+        const __m512 __k = _mm512_mask_i32gather_ps( _mm512_setzero_ps(), __valid, _j, _keys, 4 );
+        const __mmask16 __right = _mm512_cmp_ps_mask( __k, _q, _CMP_LT_OQ );
+        return _mm512_mask_mov_epi32( _j, __valid, __simd_epi32<false>::__step_from(_j, __right) );
+    }
+    static void __store( __m512i _j, size_t *_out ) noexcept
+    { __simd_epi32<false>::__store( _j, _out ); }
+};
+
+template <bool _Unsigned>
+struct __simd_epi64
+{
+    typedef __m512i __vector;
+    typedef __m512i __index;
+    static const size_t width = 8;
+    static const size_t max_count = size_t(1) << 62;
+    
+    static __m512i __load( const void *_q ) noexcept
+    { return _mm512_loadu_si512( _q ); }
+    static __mmask8 __less( __m512i _k, __m512i _q ) noexcept
+    { return _Unsigned ? _mm512_cmplt_epu64_mask(_k, _q) : _mm512_cmplt_epi64_mask(_k, _q); }
+    static __m512i __step_from( __m512i _j, __mmask8 _right ) noexcept
+    {
+        const __m512i __one = _mm512_set1_epi64( 1 );
+        const __m512i __left = _mm512_add_epi64( _mm512_add_epi64(_j, _j), __one );
+        return _mm512_mask_add_epi64( __left, _right, __left, __one );
+    }
+    static __m512i __step( const void *_keys, __m512i _j, __m512i _q ) noexcept
+    {
+        const __m512i __k =
+            _mm512_mask_i64gather_epi64( _mm512_setzero_si512(), 0xFF, _j, _keys, 8 );
+        return __step_from( _j, __less(__k, _q) );
+    }
+    static __m512i __last_step( const void *_keys, __m512i _j, __m512i _q, size_t _count ) noexcept
+    {
+        const __mmask8 __valid =
+            _mm512_cmplt_epu64_mask( _j, _mm512_set1_epi64((long long)_count) );
+        const __m512i __k =
+            _mm512_mask_i64gather_epi64( _mm512_setzero_si512(), __valid, _j, _keys, 8 );
+        return _mm512_mask_mov_epi64( _j, __valid, __step_from(_j, __less(__k, _q)) );
+    }
+    static void __store( __m512i _j, size_t *_out ) noexcept
+    {
+        uint64_t __t[width];
+        _mm512_storeu_si512( __t, _j );
+        for( size_t __i = 0; __i < width; ++__i )
+            _out[__i] = size_t(__t[__i]);
+    }
+};
+
+struct __simd_pd
+{
+    typedef __m512d __vector;
+    typedef __m512i __index;
+    static const size_t width = 8;
+    static const size_t max_count = size_t(1) << 62;
+    
+    static __m512d __load( const void *_q ) noexcept
+    { return _mm512_loadu_pd( _q ); }
+    static __m512i __step( const void *_keys, __m512i _j, __m512d _q ) noexcept
+    {
+        const __m512d __k = _mm512_mask_i64gather_pd( _mm512_setzero_pd(), 0xFF, _j, _keys, 8 );
+        return __simd_epi64<false>::__step_from( _j, _mm512_cmp_pd_mask(__k, _q, _CMP_LT_OQ) );
+    }
+    static __m512i __last_step( const void *_keys, __m512i _j, __m512d _q, size_t _count ) noexcept
+    {
+        const __mmask8 __valid =
+            _mm512_cmplt_epu64_mask( _j, _mm512_set1_epi64((long long)_count) );
+        const __m512d __k = _mm512_mask_i64gather_pd( _mm512_setzero_pd(), __valid, _j, _keys, 8 );
+        const __mmask8 __right = _mm512_cmp_pd_mask( __k, _q, _CMP_LT_OQ );
+        return _mm512_mask_mov_epi64( _j, __valid, __simd_epi64<false>::__step_from(_j, __right) );
+    }
+    static void __store( __m512i _j, size_t *_out ) noexcept
+    { __simd_epi64<false>::__store( _j, _out ); }
+};
+
+#elif defined(__AVX2__)
+
+// AVX2 has only signed integer comparisons, so unsigned keys are compared with flipped sign bits.
+template <bool _Unsigned>
+struct __simd_epi32
+{
+    typedef __m256i __vector;
+    typedef __m256i __index;
+    static const size_t width = 8;
+    static const size_t max_count = size_t(1) << 30;
+    
+    static __m256i __bias() noexcept
+    { return _mm256_set1_epi32( _Unsigned ? std::numeric_limits<int>::min() : 0 ); }
+    static __m256i __load( const void *_q ) noexcept
+    { return _mm256_xor_si256( _mm256_loadu_si256(static_cast<const __m256i*>(_q)), __bias() ); }
+    static __m256i __step_from( __m256i _j, __m256i _right ) noexcept
+    {   // _right is -1 in lanes which go right
+        const __m256i __left = _mm256_add_epi32( _mm256_add_epi32(_j, _j), _mm256_set1_epi32(1) );
+        return _mm256_sub_epi32( __left, _right );
+    }
+    static __m256i __step( const void *_keys, __m256i _j, __m256i _q ) noexcept
+    {
+        const __m256i __k = _mm256_xor_si256(
+            _mm256_i32gather_epi32(static_cast<const int*>(_keys), _j, 4), __bias() );
+        return __step_from( _j, _mm256_cmpgt_epi32(_q, __k) );
+    }
+    static __m256i __last_step( const void *_keys, __m256i _j, __m256i _q, size_t _count ) noexcept
+    {
+        const __m256i __valid = _mm256_cmpgt_epi32( _mm256_set1_epi32(int(_count)), _j );
+        const __m256i __k = _mm256_xor_si256( _mm256_mask_i32gather_epi32(
+            _mm256_setzero_si256(), static_cast<const int*>(_keys), _j, __valid, 4), __bias() );
+        const __m256i __right = _mm256_and_si256( _mm256_cmpgt_epi32(_q, __k), __valid );
+        return _mm256_blendv_epi8( _j, __step_from(_j, __right), __valid );
+    }
+    static void __store( __m256i _j, size_t *_out ) noexcept
+    {
+        uint32_t __t[width];
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>(__t), _j );
+        for( size_t __i = 0; __i < width; ++__i )
+            _out[__i] = __t[__i];
+    }
+};
+
+struct __simd_ps
+{
+    typedef __m256  __vector;
+    typedef __m256i __index;
+    static const size_t width = 8;
+    static const size_t max_count = size_t(1) << 30;
+    
+    static __m256 __load( const void *_q ) noexcept
+    { return _mm256_loadu_ps( static_cast<const float*>(_q) ); }
+    static __m256i __step( const void *_keys, __m256i _j, __m256 _q ) noexcept
+    {
+        const __m256 __k = _mm256_i32gather_ps( static_cast<const float*>(_keys), _j, 4 );
+        const __m256i __right = _mm256_castps_si256( _mm256_cmp_ps(__k, _q, _CMP_LT_OQ) );
+        return __simd_epi32<false>::__step_from( _j, __right );
+    }
+    static __m256i __last_step( const void *_keys, __m256i _j, __m256 _q, size_t _count ) noexcept
+    {
+        const __m256i __valid = _mm256_cmpgt_epi32( _mm256_set1_epi32(int(_count)), _j );
+        const __m256 __k = _mm256_mask_i32gather_ps( _mm256_setzero_ps(),
+            static_cast<const float*>(_keys), _j, _mm256_castsi256_ps(__valid), 4 );
+        const __m256i __right = _mm256_and_si256(
+            _mm256_castps_si256(_mm256_cmp_ps(__k, _q, _CMP_LT_OQ)), __valid );
+        return _mm256_blendv_epi8( _j, __simd_epi32<false>::__step_from(_j, __right), __valid );
+    }
+    static void __store( __m256i _j, size_t *_out ) noexcept
+    { __simd_epi32<false>::__store( _j, _out ); }
+};
+
+template <bool _Unsigned>
+struct __simd_epi64
+{
+    typedef __m256i __vector;
+    typedef __m256i __index;
+    static const size_t width = 4;
+    static const size_t max_count = size_t(1) << 62;
+    
+    static __m256i __bias() noexcept
+    { return _mm256_set1_epi64x( _Unsigned ? std::numeric_limits<long long>::min() : 0 ); }
+    static __m256i __load( const void *_q ) noexcept
+    { return _mm256_xor_si256( _mm256_loadu_si256(static_cast<const __m256i*>(_q)), __bias() ); }
+    static __m256i __step_from( __m256i _j, __m256i _right ) noexcept
+    {   // _right is -1 in lanes which go right
+        const __m256i __left = _mm256_add_epi64( _mm256_add_epi64(_j, _j), _mm256_set1_epi64x(1) );
+        return _mm256_sub_epi64( __left, _right );
+    }
+    static __m256i __step( const void *_keys, __m256i _j, __m256i _q ) noexcept
+    {
+        const __m256i __k = _mm256_xor_si256(
+            _mm256_i64gather_epi64(static_cast<const long long*>(_keys), _j, 8), __bias() );
+        return __step_from( _j, _mm256_cmpgt_epi64(_q, __k) );
+    }
+    static __m256i __last_step( const void *_keys, __m256i _j, __m256i _q, size_t _count ) noexcept
+    {
+        const __m256i __valid = _mm256_cmpgt_epi64( _mm256_set1_epi64x((long long)_count), _j );
+        const __m256i __k = _mm256_xor_si256( _mm256_mask_i64gather_epi64(_mm256_setzero_si256(),
+            static_cast<const long long*>(_keys), _j, __valid, 8), __bias() );
+        const __m256i __right = _mm256_and_si256( _mm256_cmpgt_epi64(_q, __k), __valid );
+        return _mm256_blendv_epi8( _j, __step_from(_j, __right), __valid );
+    }
+    static void __store( __m256i _j, size_t *_out ) noexcept
+    {
+        uint64_t __t[width];
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>(__t), _j );
+        for( size_t __i = 0; __i < width; ++__i )
+            _out[__i] = size_t(__t[__i]);
+    }
+};
+
+struct __simd_pd
+{
+    typedef __m256d __vector;
+    typedef __m256i __index;
+    static const size_t width = 4;
+    static const size_t max_count = size_t(1) << 62;
+    
+    static __m256d __load( const void *_q ) noexcept
+    { return _mm256_loadu_pd( static_cast<const double*>(_q) ); }
+    static __m256i __step( const void *_keys, __m256i _j, __m256d _q ) noexcept
+    {
+        const __m256d __k = _mm256_i64gather_pd( static_cast<const double*>(_keys), _j, 8 );
+        const __m256i __right = _mm256_castpd_si256( _mm256_cmp_pd(__k, _q, _CMP_LT_OQ) );
+        return __simd_epi64<false>::__step_from( _j, __right );
+    }
+    static __m256i __last_step( const void *_keys, __m256i _j, __m256d _q, size_t _count ) noexcept
+    {
+        const __m256i __valid = _mm256_cmpgt_epi64( _mm256_set1_epi64x((long long)_count), _j );
+        const __m256d __k = _mm256_mask_i64gather_pd( _mm256_setzero_pd(),
+            static_cast<const double*>(_keys), _j, _mm256_castsi256_pd(__valid), 8 );
+        const __m256i __right = _mm256_and_si256(
+            _mm256_castpd_si256(_mm256_cmp_pd(__k, _q, _CMP_LT_OQ)), __valid );
+        return _mm256_blendv_epi8( _j, __simd_epi64<false>::__step_from(_j, __right), __valid );
+    }
+    static void __store( __m256i _j, size_t *_out ) noexcept
+    { __simd_epi64<false>::__store( _j, _out ); }
+};
+
+#endif
+
+// Picks the vector operations for a key type, void when there are none.
+template <class _Key,
+          bool _Integral = std::is_integral<_Key>::value && !std::is_same<_Key, bool>::value,
+          size_t _Size = sizeof(_Key)>
+struct __simd_ops { typedef void type; };
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+template <class _Key>
+struct __simd_ops<_Key, true, 4> { typedef __simd_epi32<std::is_unsigned<_Key>::value> type; };
+template <class _Key>
+struct __simd_ops<_Key, true, 8> { typedef __simd_epi64<std::is_unsigned<_Key>::value> type; };
+template <>
+struct __simd_ops<float, false, sizeof(float)> { typedef __simd_ps type; };
+template <>
+struct __simd_ops<double, false, sizeof(double)> { typedef __simd_pd type; };
+#endif
+
+// Whether a batch of _K2 keys can be looked up with vectorized descents.
+template <class _Key, class _K2, class _Compare>
+struct __simd_batch : std::integral_constant<bool,
+    !std::is_void<typename __simd_ops<_Key>::type>::value &&
+    std::is_same<_Key, _K2>::value &&
+    __is_std_less<_Key, _Compare>::value> {};
+
+template <class _Ops, class _Key, class _ForwardIterator, class _Sink>
+inline void __lower_bound_batch_simd( const _Key *_keys, size_t _count,
+                                      _ForwardIterator _first, _ForwardIterator _last,
+                                      _Sink &&_sink )
+{
+    static const size_t __width = _Ops::width;
+    static const size_t __vectors = __batch_group / __width;
+    const size_t __levels = __complete_levels( _count );
+    
+    _ForwardIterator __k[__batch_group];
+    _Key __q[__batch_group];
+    size_t __r[__batch_group];
+    typename _Ops::__vector __v[__vectors];
+    typename _Ops::__index __j[__vectors];
+    while( _first != _last ) {
+        size_t __n = 0;
+        for( ; __n < __batch_group && _first != _last; ++__n, ++_first ) {
+            __k[__n] = _first;
+            __q[__n] = *_first;
+        }
+        std::fill( __q + __n, __q + __batch_group, _Key() );
+        
+        const size_t __nv = (__n + __width - 1) / __width;
+        for( size_t __i = 0; __i < __nv; ++__i ) {
+            __v[__i] = _Ops::__load( __q + __i * __width );
+            __j[__i] = typename _Ops::__index();
+        }
+        
+        for( size_t __l = 0; __l < __levels; ++__l )
+            for( size_t __i = 0; __i < __nv; ++__i )
+                __j[__i] = _Ops::__step( _keys, __j[__i], __v[__i] );
+        
+        for( size_t __i = 0; __i < __nv; ++__i ) {
+            __j[__i] = _Ops::__last_step( _keys, __j[__i], __v[__i], _count );
+            _Ops::__store( __j[__i], __r + __i * __width );
+        }
+        
+        for( size_t __i = 0; __i < __n; ++__i )
+            _sink( __k[__i], __descent_result( __r[__i], _count ) );
+    }
+}
+
+template <class _Key, class _ForwardIterator, class _Compare, class _Sink>
+inline void __lower_bound_batch( const _Key *_keys, size_t _count,
+                                 _ForwardIterator _first, _ForwardIterator _last,
+                                 const _Compare &_comp, _Sink &&_sink, std::true_type )
+{
+    typedef typename __simd_ops<_Key>::type _Ops;
+    if( _count < _Ops::max_count )
+        __lower_bound_batch_simd<_Ops>( _keys, _count, _first, _last, _sink );
+    else
+        __lower_bound_batch( _keys, _count, _first, _last, _comp, _sink, std::false_type() );
+}
+
+template <class _Key, class _ForwardIterator, class _Compare, class _Sink>
+inline void __lower_bound_batch( const _Key *_keys, size_t _count,
+                                 _ForwardIterator _first, _ForwardIterator _last,
+                                 const _Compare &_comp, _Sink &&_sink )
+{
+    typedef typename std::iterator_traits<_ForwardIterator>::value_type _K2;
+    __lower_bound_batch( _keys, _count, _first, _last, _comp, _sink,
+                         __simd_batch<_Key, _K2, _Compare>() );
+}
+
+template <class _Key, class _Value>
+struct __pair_ptr_wrap : std::pair<const _Key&, _Value&>
+{
+    __pair_ptr_wrap(const _Key *_k, _Value *_v) noexcept :
+        std::pair<const _Key&, _Value&>(*_k, *_v) {}
+    
+    const std::pair<const _Key&, _Value&>* operator->() const noexcept
+        { return this; }
+};
+
+template <class _Key, class _Value>
+struct __const_pair_ptr_wrap : std::pair<const _Key&, const _Value&>
+{
+    __const_pair_ptr_wrap(const _Key *_k, const _Value *_v) noexcept :
+        std::pair<const _Key&, const _Value&>(*_k, *_v) {}
+    
+    const std::pair<const _Key&, const _Value&>* operator->() const noexcept
+        { return this; }
+};
+
+// Iterates over a pair of parallel key and value arrays.
+template <class _Key, class _Value>
+struct __proxy_iterator
+{
+    typedef std::bidirectional_iterator_tag         iterator_category;
+    typedef ptrdiff_t                               difference_type;
+    typedef std::pair<_Key, _Value>                 value_type;
+    typedef __pair_ptr_wrap<_Key, _Value>           pointer;
+    typedef std::pair<const _Key&, _Value&>         reference;
+
+    __proxy_iterator() noexcept : k(nullptr), v(nullptr)
+    { }
+    __proxy_iterator(const _Key *_k, _Value *_v) noexcept : k(_k), v(_v)
+    { }
+    reference operator *() const noexcept
+    {
+        return reference{ *k, *v };
+    }
+    pointer operator->() const noexcept
+    {
+        return pointer{ k, v };
+    }
+    reference operator[](difference_type _n) const noexcept
+    {
+        return *(*this + _n);
+    }
+    __proxy_iterator &operator++() noexcept
+    {
+        ++k; ++v; return *this;
+    }
+    __proxy_iterator operator++(int) noexcept
+    {
+        __proxy_iterator __tmp = *this; ++(*this); return __tmp;
+    }
+    __proxy_iterator &operator--() noexcept
+    {
+        --k; --v; return *this;
+    }
+    __proxy_iterator operator--(int) noexcept
+    {
+        __proxy_iterator __tmp = *this; --(*this); return __tmp;
+    }
+    __proxy_iterator &operator+=(difference_type _d) noexcept
+    {
+        k += _d; v += _d; return *this;
+    }
+    __proxy_iterator &operator-=(difference_type _d) noexcept
+    {
+        k -= _d; v -= _d; return *this;
+    }
+    __proxy_iterator operator +(difference_type _d) const noexcept
+    {
+        __proxy_iterator __tmp = *this; return __tmp += _d;
+    }
+    __proxy_iterator operator -(difference_type _d) const noexcept
+    {
+        __proxy_iterator __tmp = *this; return __tmp -= _d;
+    }
+    difference_type operator-(const __proxy_iterator &_rhs) const noexcept
+    {
+        return k - _rhs.k;
+    }
+    bool operator ==(const __proxy_iterator &_rhs) const noexcept
+    {
+        return k == _rhs.k;
+    }
+    bool operator !=(const __proxy_iterator &_rhs) const noexcept
+    {
+        return k != _rhs.k;
+    }
+    bool operator  <(const __proxy_iterator &_rhs) const noexcept
+    {
+        return k < _rhs.k;
+    }
+    bool operator  >(const __proxy_iterator &_rhs) const noexcept
+    {
+        return k > _rhs.k;
+    }
+    bool operator <=(const __proxy_iterator &_rhs) const noexcept
+    {
+        return k <= _rhs.k;
+    }
+    bool operator >=(const __proxy_iterator &_rhs) const noexcept
+    {
+        return k >= _rhs.k;
+    }
+private:
+    const _Key *k;
+    _Value *v;
+    template <class, class> friend struct __const_proxy_iterator;
+};
+
+template <class _Key, class _Value>
+struct __const_proxy_iterator
+{
+    typedef std::bidirectional_iterator_tag         iterator_category;
+    typedef ptrdiff_t                               difference_type;
+    typedef std::pair<_Key, _Value>                 value_type;
+    typedef __const_pair_ptr_wrap<_Key, _Value>     pointer;
+    typedef std::pair<const _Key&, const _Value&>   reference;
+
+    __const_proxy_iterator() noexcept : k(nullptr), v(nullptr)
+    { }
+    __const_proxy_iterator(const _Key *_k, const _Value *_v) noexcept : k(_k), v(_v)
+    { }
+    __const_proxy_iterator(const __proxy_iterator<_Key, _Value> &_i) noexcept : k(_i.k), v(_i.v)
+    { }
+    reference operator *() const noexcept
+    {
+        return reference{ *k, *v };
+    }
+    pointer operator->() const noexcept
+    {
+        return pointer{ k, v };
+    }
+    reference operator[](difference_type _n) const noexcept
+    {
+        return *(*this + _n);
+    }
+    __const_proxy_iterator &operator++() noexcept
+    {
+        ++k; ++v; return *this;
+    }
+    __const_proxy_iterator operator++(int) noexcept
+    {
+        __const_proxy_iterator __tmp = *this; ++(*this); return __tmp;
+    }
+    __const_proxy_iterator &operator--() noexcept
+    {
+        --k; --v; return *this;
+    }
+    __const_proxy_iterator operator--(int) noexcept
+    {
+        __const_proxy_iterator __tmp = *this; --(*this); return __tmp;
+    }
+    __const_proxy_iterator &operator+=(difference_type _d) noexcept
+    {
+        k += _d; v += _d; return *this;
+    }
+    __const_proxy_iterator &operator-=(difference_type _d) noexcept
+    {
+        k -= _d; v -= _d; return *this;
+    }
+    __const_proxy_iterator operator +(difference_type _d) const noexcept
+    {
+        __const_proxy_iterator __tmp = *this; return __tmp += _d;
+    }
+    __const_proxy_iterator operator -(difference_type _d) const noexcept
+    {
+        __const_proxy_iterator __tmp = *this; return __tmp -= _d;
+    }
+    difference_type operator-(const __const_proxy_iterator &_rhs) const noexcept
+    {
+        return k - _rhs.k;
+    }
+    bool operator ==(const __const_proxy_iterator &_rhs) const noexcept
+    {
+        return k == _rhs.k;
+    }
+    bool operator !=(const __const_proxy_iterator &_rhs) const noexcept
+    {
+        return k != _rhs.k;
+    }
+    bool operator  <(const __const_proxy_iterator &_rhs) const noexcept
+    {
+        return k < _rhs.k;
+    }
+    bool operator  >(const __const_proxy_iterator &_rhs) const noexcept
+    {
+        return k > _rhs.k;
+    }
+    bool operator <=(const __const_proxy_iterator &_rhs) const noexcept
+    {
+        return k <= _rhs.k;
+    }
+    bool operator >=(const __const_proxy_iterator &_rhs) const noexcept
+    {
+        return k >= _rhs.k;
+    }
+private:
+    const _Key *k;
+    const _Value *v;
+};
+
+// Iterates over a pair of parallel key and value arrays in the order of keys. _Value is const for
+// a constant iterator.
+template <class _Key, class _Value>
+struct __ordered_iterator
+{
+    typedef std::bidirectional_iterator_tag         iterator_category;
+    typedef ptrdiff_t                               difference_type;
+    typedef std::pair<_Key, typename std::remove_const<_Value>::type> value_type;
+    typedef __pair_ptr_wrap<_Key, _Value>           pointer;
+    typedef std::pair<const _Key&, _Value&>         reference;
+    
+    __ordered_iterator() noexcept : k(nullptr), v(nullptr), j(0), n(0)
+    { }
+    __ordered_iterator(const _Key *_k, _Value *_v, size_t _j, size_t _n) noexcept :
+        k(_k), v(_v), j(_j), n(_n)
+    { }
+    template <class _V2, class = typename std::enable_if<
+        !std::is_same<_V2, _Value>::value && std::is_same<const _V2, _Value>::value>::type>
+    __ordered_iterator(const __ordered_iterator<_Key, _V2> &_i) noexcept :
+        k(_i.k), v(_i.v), j(_i.j), n(_i.n)
+    { }
+    reference operator *() const noexcept
+    {
+        return reference{ k[j], v[j] };
+    }
+    pointer operator->() const noexcept
+    {
+        return pointer{ k + j, v + j };
+    }
+    __ordered_iterator &operator++() noexcept
+    {
+        j = __inorder_next(j, n); return *this;
+    }
+    __ordered_iterator operator++(int) noexcept
+    {
+        __ordered_iterator __tmp = *this; ++(*this); return __tmp;
+    }
+    __ordered_iterator &operator--() noexcept
+    {
+        j = __inorder_prev(j, n); return *this;
+    }
+    __ordered_iterator operator--(int) noexcept
+    {
+        __ordered_iterator __tmp = *this; --(*this); return __tmp;
+    }
+    bool operator ==(const __ordered_iterator &_rhs) const noexcept
+    {
+        return j == _rhs.j;
+    }
+    bool operator !=(const __ordered_iterator &_rhs) const noexcept
+    {
+        return j != _rhs.j;
+    }
+private:
+    const _Key *k;
+    _Value *v;
+    size_t j;
+    size_t n;
+    template <class, class> friend struct __ordered_iterator;
+};
+
+// A pair of iterators which can be used in a range-based for loop.
+template <class _Iterator>
+struct __range
+{
+    _Iterator __m_begin;
+    _Iterator __m_end;
+    _Iterator begin() const noexcept { return __m_begin; }
+    _Iterator end() const noexcept { return __m_end; }
+    bool empty() const noexcept { return __m_begin == __m_end; }
+};
+
+// The array of values of fixed_eytzinger_map, parallel to the array of keys. Empty for
+// fixed_eytzinger_set, which has no values.
+template <typename _Value>
+struct __value_array
+{
+    _Value *__m_values = nullptr;
+    
+    template <class _ByteAllocator>
+    void __allocate( _ByteAllocator &_alloc, size_t _count )
+    {
+        __m_values = static_cast<_Value*>( __allocate_aligned(_alloc, _count * sizeof(_Value), 0) );
+    }
+    template <class _ByteAllocator>
+    void __deallocate( _ByteAllocator &_alloc, size_t _count ) noexcept
+    {
+        __deallocate_aligned( _alloc, __m_values, _count * sizeof(_Value), 0 );
+        __m_values = nullptr;
+    }
+    template <typename _V>
+    void __construct( size_t _p, _V &&_v )
+    {
+        ::new((void*)(__m_values+_p)) _Value( std::forward<_V>(_v) );
+    }
+    void __destroy( size_t _p ) noexcept
+    {
+        (__m_values+_p)->~_Value();
+    }
+    void __destroy_all( size_t _count ) noexcept
+    {
+        for( _Value *_first = __m_values, *_last = __m_values + _count; _first != _last; _first++ )
+            _first->~_Value();
+    }
+    void __swap( __value_array &_other ) noexcept
+    {
+        std::swap( __m_values, _other.__m_values );
+    }
+};
+
+template <>
+struct __value_array<void>
+{
+    template <class _ByteAllocator>
+    void __allocate( _ByteAllocator &, size_t ) {}
+    template <class _ByteAllocator>
+    void __deallocate( _ByteAllocator &, size_t ) noexcept {}
+    void __construct( size_t ) noexcept {}
+    void __destroy( size_t ) noexcept {}
+    void __destroy_all( size_t ) noexcept {}
+    void __swap( __value_array & ) noexcept {}
+};
+
+// The propagation rules of allocators on assignment and swap, for the containers which manage
+// storage of their own.
+template <class _Allocator>
+struct __alloc_propagation
+{
+    typedef std::allocator_traits<_Allocator> __traits;
+    typedef typename __traits::propagate_on_container_copy_assignment __on_copy_assignment;
+    typedef typename __traits::propagate_on_container_move_assignment __on_move_assignment;
+    typedef typename __traits::propagate_on_container_swap __on_swap;
+    
+    // The allocator of the copy which a copy assignment of _from to _to makes.
+    static const _Allocator &__copy_allocator( const _Allocator &_to,
+                                               const _Allocator &_from ) noexcept
+    {
+        return __on_copy_assignment::value ? _from : _to;
+    }
+    // Tells whether a move assignment of _from to _to can take over its storage, otherwise the
+    // elements are moved one by one into storage of _to.
+    static bool __can_take( const _Allocator &_to, const _Allocator &_from ) noexcept
+    {
+        return __on_move_assignment::value || _to == _from;
+    }
+    static void __copy_assign( _Allocator &_to, const _Allocator &_from ) noexcept
+    {
+        __assign( _to, _from, __on_copy_assignment() );
+    }
+    static void __move_assign( _Allocator &_to, const _Allocator &_from ) noexcept
+    {
+        __assign( _to, _from, __on_move_assignment() );
+    }
+    static void __swap( _Allocator &_1, _Allocator &_2 ) noexcept
+    {
+        __swap( _1, _2, __on_swap() );
+    }
+    
+private:
+    static void __assign( _Allocator &_to, const _Allocator &_from, std::true_type ) noexcept
+    { _to = _from; }
+    static void __assign( _Allocator &, const _Allocator &, std::false_type ) noexcept {}
+    static void __swap( _Allocator &_1, _Allocator &_2, std::true_type ) noexcept
+    { using std::swap; swap(_1, _2); }
+    static void __swap( _Allocator &, _Allocator &, std::false_type ) noexcept {}
+};
+
+// The storage of fixed_eytzinger_map and fixed_eytzinger_set: the comparator, the allocator,
+// the keys in the layout order and, unless _Value is void, the values. Allocation, copying,
+// moving and the allocator propagation rules of both containers live here.
+template <typename _Key, typename _Value, class _Compare, class _Allocator>
+class __storage : protected _Compare, protected __value_array<_Value>
+{
+protected:
+    typedef std::allocator_traits<_Allocator> alloc_traits;
+    typedef __alloc_propagation<_Allocator> propagation;
+    typedef typename alloc_traits::template rebind_alloc<char> byte_allocator_type;
+    typedef std::integral_constant<bool, !std::is_void<_Value>::value> __has_values;
+    typedef typename std::conditional<__has_values::value,
+                                      std::pair<_Key, _Value>, _Key>::type __element;
+    typedef std::vector<__element, typename alloc_traits::template rebind_alloc<__element> >
+        scratch_type;
+    
+    __storage( const _Compare &_comp, const _Allocator &_alloc ) :
+        _Compare(_comp),
+        __m_count(0),
+        __m_keys(nullptr),
+        __m_alloc(_alloc)
+    {
+    }
+    
+    __storage( __storage &&_other ) noexcept :
+        _Compare( _other ),
+        __m_count(0),
+        __m_keys(nullptr),
+        __m_alloc( std::move(_other.__m_alloc) )
+    {
+        swap_data( _other );
+    }
+    
+    __storage( __storage &&_other, const _Allocator &_alloc ) :
+        __storage( _other.comparator(), _alloc )
+    {
+        if( __m_alloc == _other.__m_alloc )
+            swap_data( _other );
+        else
+            move_init( _other );
+    }
+    
+    __storage( const __storage &_other ) :
+        __storage( _other.comparator(),
+                   alloc_traits::select_on_container_copy_construction(_other.__m_alloc) )
+    {
+        copy_init( _other );
+    }
+    
+    __storage( const __storage &_other, const _Allocator &_alloc ) :
+        __storage( _other.comparator(), _alloc )
+    {
+        copy_init( _other );
+    }
+    
+    ~__storage()
+    {
+        clear();
+    }
+    
+    // Storage which can't be taken over is moved element by element into a temporary first, so
+    // nothing changes if that throws.
+    __storage& operator=( __storage &&_other ) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value )
+    {
+        if( propagation::__can_take(__m_alloc, _other.__m_alloc) ) {
+            clear();
+            propagation::__move_assign( __m_alloc, _other.__m_alloc );
+            swap_data( _other );
+        }
+        else {
+            __storage __tmp( std::move(_other), __m_alloc );
+            clear();
+            swap_data( __tmp );
+        }
+        return *this;
+    }
+    
+    __storage& operator=( const __storage &_other )
+    {
+        __storage __tmp( _other, propagation::__copy_allocator(__m_alloc, _other.__m_alloc) );
+        clear();
+        propagation::__copy_assign( __m_alloc, _other.__m_alloc );
+        swap_data( __tmp );
+        return *this;
+    }
+    
+    _Allocator get_allocator() const noexcept
+    {
+        return __m_alloc;
+    }
+    
+    void clear() noexcept
+    {
+        destroy_all();
+        deallocate();
+    }
+    
+    void swap( __storage &_other ) noexcept
+    {
+        swap_data( _other );
+        propagation::__swap( __m_alloc, _other.__m_alloc );
+    }
+    
+    // Swaps everything but the allocators.
+    void swap_data( __storage &_other ) noexcept
+    {
+        std::swap( __m_count, _other.__m_count );
+        std::swap( __m_keys, _other.__m_keys );
+        this->__swap( _other );
+        std::swap( (_Compare&)*this, (_Compare&)_other );
+    }
+    
+    void alloc_init( size_t _count )
+    {
+        byte_allocator_type __alloc( __m_alloc );
+        __m_count = _count;
+        try {
+            __m_keys = static_cast<_Key*>(
+                __allocate_aligned(__alloc, _count * sizeof(_Key), sizeof(_Key)) );
+            this->__allocate( __alloc, _count );
+        } catch( ... ) {
+            deallocate();
+            std::rethrow_exception( std::current_exception() );
+        }
+    }
+    
+    void deallocate() noexcept
+    {
+        byte_allocator_type __alloc( __m_alloc );
+        __deallocate_aligned( __alloc, __m_keys, __m_count * sizeof(_Key), sizeof(_Key) );
+        this->__deallocate( __alloc, __m_count );
+        __m_keys = nullptr;
+        __m_count = 0;
+    }
+    
+    template <typename _K, typename... _V>
+    void emplace_at( size_t _p, _K &&_k, _V &&..._v )
+    {
+        ::new((void*)(__m_keys+_p)) _Key( std::forward<_K>(_k) );
+        try {
+            this->__construct( _p, std::forward<_V>(_v)... );
+        }
+        catch( ... ) {
+            (__m_keys+_p)->~_Key();
+            std::rethrow_exception( std::current_exception() );
+        }
+    }
+    
+    void destroy_at( size_t _p ) noexcept
+    {
+        (__m_keys+_p)->~_Key();
+        this->__destroy( _p );
+    }
+    
+    void destroy_all() noexcept
+    {
+        for( _Key *_first = __m_keys, *_last = __m_keys + __m_count; _first != _last; _first++ )
+            _first->~_Key();
+        this->__destroy_all( __m_count );
+    }
+    
+    // Constructs _count elements from a sorted sequence, visiting the nodes in order. With
+    // _Validate set, every key is checked to be greater than the previous one.
+    template <bool _Validate, typename _ForwardIterator>
+    void init_fill( size_t _count, _ForwardIterator _first )
+    {
+        alloc_init( _count );
+        
+        size_t __j = __inorder_first(_count), __prev = _count, __n = 0;
+        try {
+            for( ; __n < _count; ++__n, ++_first ) {
+                emplace_element( __j, *_first, __has_values() );
+                if( _Validate && __prev != _count && !comp(__m_keys[__prev], __m_keys[__j]) ) {
+                    ++__n;
+                    throw_unsorted();
+                }
+                __prev = __j;
+                __j = __inorder_next( __j, _count );
+            }
+        }
+        catch( ... ) {
+            for( __j = __inorder_first(_count); __n--; __j = __inorder_next(__j, _count) )
+                destroy_at( __j );
+            deallocate();
+            std::rethrow_exception( std::current_exception() );
+        }
+    }
+    
+    template <typename _InputIterator>
+    void init_sorted( _InputIterator _begin, _InputIterator _end, std::input_iterator_tag )
+    {
+        scratch_type t( _begin, _end, __m_alloc );
+        init_fill<true>( t.size(), std::make_move_iterator(t.begin()) );
+    }
+    
+    template <typename _ForwardIterator>
+    void init_sorted( _ForwardIterator _begin, _ForwardIterator _end, std::forward_iterator_tag )
+    {
+        init_fill<true>( (size_t)std::distance(_begin, _end), _begin );
+    }
+    
+    const _Compare &comparator() const noexcept { return *this; }
+    bool comp(const _Key& _v1, const _Key &_v2) const noexcept
+    {
+        return _Compare::operator()(_v1, _v2);
+    }
+    bool equal(const _Key& _v1, const _Key &_v2) const noexcept
+    {
+        return !comp(_v1, _v2) && !comp(_v2, _v1);
+    }
+    template <class _K1, class _K2>
+    bool comp2(const _K1& _v1, const _K2 &_v2) const noexcept
+    {
+        return _Compare::operator()(_v1, _v2);
+    }
+    template <class _K1, class _K2>
+    bool equal2(const _K1& _v1, const _K2 &_v2) const noexcept
+    {
+        return !_Compare::operator()(_v1, _v2) && !_Compare::operator()(_v2, _v1);
+    }
+    
+    template <typename _ForwardIterator>
+    static void check_batch_iterator() noexcept
+    {
+        static_assert( std::is_base_of<std::forward_iterator_tag,
+                            typename std::iterator_traits<_ForwardIterator>::iterator_category>::
+                            value,
+                       "batch lookup requires forward iterators" );
+        static_assert( std::is_same<typename std::iterator_traits<_ForwardIterator>::value_type,
+                                    _Key>::value ||
+                       __is_transparent<_Compare>::value,
+                       "heterogeneous batch lookup requires a transparent comparator" );
+    }
+    
+    [[noreturn]] static void throw_unsorted()
+    {
+        throw std::invalid_argument( __has_values::value ?
+            "fixed_eytzinger_map: keys are not sorted or not unique" :
+            "fixed_eytzinger_set: keys are not sorted or not unique" );
+    }
+    
+    size_t          __m_count;
+    _Key           *__m_keys;
+    _Allocator      __m_alloc;
+    
+private:
+    void copy_init( const __storage &_other )
+    {
+        alloc_init( _other.__m_count );
+        
+        size_t __n = 0;
+        try {
+            for( ; __n < __m_count; ++__n )
+                copy_at( __n, _other, __has_values() );
+        }
+        catch( ... ) {
+            while( __n-- )
+                destroy_at( __n );
+            deallocate();
+            std::rethrow_exception( std::current_exception() );
+        }
+    }
+    
+    // Moves elements from storage whose allocator can't free this storage. Throws if the storage
+    // can't be allocated, _other is left unchanged then.
+    void move_init( __storage &_other )
+    {
+        alloc_init( _other.__m_count );
+        for( size_t __n = 0; __n < __m_count; ++__n )
+            move_at( __n, _other, __has_values() );
+        _other.clear();
+    }
+    
+    void copy_at( size_t _p, const __storage &_other, std::true_type )
+    {
+        emplace_at( _p, _other.__m_keys[_p], _other.__m_values[_p] );
+    }
+    void copy_at( size_t _p, const __storage &_other, std::false_type )
+    {
+        emplace_at( _p, _other.__m_keys[_p] );
+    }
+    void move_at( size_t _p, __storage &_other, std::true_type ) noexcept
+    {
+        emplace_at( _p, std::move(_other.__m_keys[_p]), std::move(_other.__m_values[_p]) );
+    }
+    void move_at( size_t _p, __storage &_other, std::false_type ) noexcept
+    {
+        emplace_at( _p, std::move(_other.__m_keys[_p]) );
+    }
+    template <typename _Element>
+    void emplace_element( size_t _p, _Element &&_e, std::true_type )
+    {
+        emplace_at( _p, std::forward<_Element>(_e).first, std::forward<_Element>(_e).second );
+    }
+    template <typename _Element>
+    void emplace_element( size_t _p, _Element &&_e, std::false_type )
+    {
+        emplace_at( _p, std::forward<_Element>(_e) );
+    }
+};
+
+}
+
+template <typename _Key, typename _Value, class _Compare, class _Allocator>
+class fixed_eytzinger_map;
+
+namespace __eytzinger
+{
+
+// Access to the arrays of fixed_eytzinger_map for the containers built on top of it, which look
+// elements up with their own code and hand out iterators into those arrays.
+struct __access
+{
+    template <typename _Key, typename _Value, class _Compare, class _Allocator>
+    static size_t count( const fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator> &_m )
+        noexcept
+    {
+        return _m.__m_count;
+    }
+    template <typename _Key, typename _Value, class _Compare, class _Allocator>
+    static _Key *keys( const fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator> &_m ) noexcept
+    {
+        return _m.__m_keys;
+    }
+    template <typename _Key, typename _Value, class _Compare, class _Allocator>
+    static _Value *values( const fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator> &_m )
+        noexcept
+    {
+        return _m.__m_values;
+    }
+    template <typename _Key, typename _Value, class _Compare, class _Allocator>
+    static const _Compare &
+    comparator( const fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator> &_m ) noexcept
+    {
+        return _m.comparator();
+    }
+};
+
+}
+
+template <typename _Key, typename _Value, class _Compare = std::less<_Key>,
+          class _Allocator = std::allocator< std::pair<_Key, _Value> > >
+class fixed_eytzinger_map : private __eytzinger::__storage<_Key, _Value, _Compare, _Allocator>
 {
-    struct pair_ptr_wrap;
-    struct const_pair_ptr_wrap;
-    struct proxy_iterator;
-    struct const_proxy_iterator;
 public:
     typedef size_t                                  size_type;
     typedef std::pair<_Key,_Value>                  value_type;
     typedef _Key                                    key_type;
     typedef _Value                                  mapped_type;
     typedef _Compare                                key_compare;
-    typedef proxy_iterator                          iterator;
-    typedef const_proxy_iterator                    const_iterator;
+    typedef _Allocator                              allocator_type;
+    typedef __eytzinger::__proxy_iterator<_Key, _Value>         iterator;
+    typedef __eytzinger::__const_proxy_iterator<_Key, _Value>   const_iterator;
     typedef std::pair<iterator,iterator>            range_pair;
     typedef std::pair<const_iterator,const_iterator>const_range_pair;
+    typedef __eytzinger::__ordered_iterator<_Key, _Value>       ordered_iterator;
+    typedef __eytzinger::__ordered_iterator<_Key, const _Value> const_ordered_iterator;
+    typedef std::reverse_iterator<ordered_iterator>             reverse_ordered_iterator;
+    typedef std::reverse_iterator<const_ordered_iterator>       const_reverse_ordered_iterator;
+    typedef __eytzinger::__range<ordered_iterator>              ordered_range;
+    typedef __eytzinger::__range<const_ordered_iterator>        const_ordered_range;
     
     static_assert( std::is_nothrow_move_constructible<key_type>::value,
         "key_type must be nothrow move constructible" );
@@ -44,20 +1719,87 @@ public:
         "mapped_type must be nothrow move constructible" );    
     
     // Construction
+    // The allocator provides storage for keys and values, as well as a temporary buffer used to
+    // sort the input. Forward ranges of big elements are sorted through a buffer of iterators
+    // instead, so that every element is copied only once, right to its place in the map.
+    // Small trivially copyable keys are kept in that buffer too, which saves the sort from
+    // chasing iterators.
     fixed_eytzinger_map();
-    explicit fixed_eytzinger_map( const _Compare& comp );
+    explicit fixed_eytzinger_map( const _Compare& comp,
+                                  const _Allocator& alloc = _Allocator() );
+    explicit fixed_eytzinger_map( const _Allocator& alloc );
     fixed_eytzinger_map( const fixed_eytzinger_map& _other );
+    fixed_eytzinger_map( const fixed_eytzinger_map& _other, const _Allocator& alloc );
     fixed_eytzinger_map( fixed_eytzinger_map&& other );
+    fixed_eytzinger_map( fixed_eytzinger_map&& other, const _Allocator& alloc );
+    fixed_eytzinger_map(std::initializer_list<value_type> l,
+                        const _Compare& comp = _Compare(),
+                        const _Allocator& alloc = _Allocator() );
     fixed_eytzinger_map(std::initializer_list<value_type> l,
-                        const _Compare& comp = _Compare() );
+                        const _Allocator& alloc );
+    template<typename _InputIterator>
+    fixed_eytzinger_map(_InputIterator begin,
+                        _InputIterator end,
+                        const _Compare& comp = _Compare(),
+                        const _Allocator& alloc = _Allocator() );
     template<typename _InputIterator>
     fixed_eytzinger_map(_InputIterator begin,
                         _InputIterator end,
-                        const _Compare& comp = _Compare() );
-
-
-    // Destruction
-    ~fixed_eytzinger_map();
+                        const _Allocator& alloc );
+    
+    // Construction which takes over the vector and sorts it in place, with no temporary buffer.
+    // Every element is moved once to its place in the map, the vector is left empty.
+    template<typename _VectorAllocator>
+    fixed_eytzinger_map(std::vector<value_type, _VectorAllocator>&& v,
+                        const _Compare& comp = _Compare(),
+                        const _Allocator& alloc = _Allocator() );
+    template<typename _VectorAllocator>
+    fixed_eytzinger_map(std::vector<value_type, _VectorAllocator>&& v,
+                        const _Allocator& alloc );
+    
+    // Construction which sorts and lays out the input in parallel, on the executor of the tag.
+    template<typename _Executor, typename _InputIterator>
+    fixed_eytzinger_map(const fixed_eytzinger_parallel_t<_Executor>& par,
+                        _InputIterator begin,
+                        _InputIterator end,
+                        const _Compare& comp = _Compare(),
+                        const _Allocator& alloc = _Allocator() );
+    
+    // Construction from input which is sorted and has unique keys, takes linear time.
+    // Throws std::invalid_argument if the input isn't sorted or has duplicates.
+    fixed_eytzinger_map(fixed_eytzinger_sorted_unique_t,
+                        std::initializer_list<value_type> l,
+                        const _Compare& comp = _Compare(),
+                        const _Allocator& alloc = _Allocator() );
+    template<typename _InputIterator>
+    fixed_eytzinger_map(fixed_eytzinger_sorted_unique_t,
+                        _InputIterator begin,
+                        _InputIterator end,
+                        const _Compare& comp = _Compare(),
+                        const _Allocator& alloc = _Allocator() );
+    
+    // Construction from a map and a sorted change set, takes linear time.
+    // The elements of [begin, end), which must be sorted and have unique keys, replace the
+    // elements of base with equal keys or are added to them. The elements of base with keys from
+    // [erase_begin, erase_end), which must be sorted, are left out. Base is walked in the order
+    // of keys along with both ranges, so nothing is sorted. Throws std::invalid_argument if a
+    // range isn't sorted.
+    template<typename _ForwardIterator>
+    fixed_eytzinger_map(const fixed_eytzinger_map& base,
+                        fixed_eytzinger_sorted_unique_t,
+                        _ForwardIterator begin,
+                        _ForwardIterator end );
+    template<typename _ForwardIterator, typename _KeyIterator>
+    fixed_eytzinger_map(const fixed_eytzinger_map& base,
+                        fixed_eytzinger_sorted_unique_t,
+                        _ForwardIterator begin,
+                        _ForwardIterator end,
+                        _KeyIterator erase_begin,
+                        _KeyIterator erase_end );
+
+
+    // Allocator
+    allocator_type get_allocator() const noexcept;
 
 
     // Element access
@@ -87,6 +1829,18 @@ public:
     const_iterator cend()      const noexcept;
     
     
+    // Iterators in the order of keys
+    // A step takes O(1) time on average.
+    ordered_iterator       ordered_begin()     noexcept;
+    ordered_iterator       ordered_end()       noexcept;
+    const_ordered_iterator ordered_begin()     const noexcept;
+    const_ordered_iterator ordered_end()       const noexcept;
+    reverse_ordered_iterator       ordered_rbegin()    noexcept;
+    reverse_ordered_iterator       ordered_rend()      noexcept;
+    const_reverse_ordered_iterator ordered_rbegin()    const noexcept;
+    const_reverse_ordered_iterator ordered_rend()      const noexcept;
+    
+    
     // Modifiers
     void clear() noexcept;
     void swap( fixed_eytzinger_map& other ) noexcept;
@@ -98,6 +1852,10 @@ public:
     size_type max_size() const noexcept;
     
     
+    // Observers
+    key_compare key_comp() const;
+    
+    
     // Lookup
     size_type count( const key_type& key ) const noexcept;
     template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
@@ -135,918 +1893,1239 @@ public:
     template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
     const_iterator upper_bound(const _K2& key) const noexcept;
     
+    // Elements with keys in [lo, hi), in the order of keys.
+    ordered_range range( const key_type& lo, const key_type& hi ) noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    ordered_range range( const _K2& lo, const _K2& hi ) noexcept;
+    
+    const_ordered_range range( const key_type& lo, const key_type& hi ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_ordered_range range( const _K2& lo, const _K2& hi ) const noexcept;
+    
+    
+    // Batch lookup
+    // Each of these looks up every key in [first, last) and writes one result per key to out.
+    // Lookups are interleaved, which overlaps their cache misses and pays off for large maps.
+    template <typename _ForwardIterator, typename _OutputIterator>
+    _OutputIterator count_batch(_ForwardIterator first,
+                                _ForwardIterator last,
+                                _OutputIterator out ) const;
+    
+    template <typename _ForwardIterator, typename _OutputIterator>
+    _OutputIterator find_batch(_ForwardIterator first,
+                               _ForwardIterator last,
+                               _OutputIterator out );
+    template <typename _ForwardIterator, typename _OutputIterator>
+    _OutputIterator find_batch(_ForwardIterator first,
+                               _ForwardIterator last,
+                               _OutputIterator out ) const;
+    
+    template <typename _ForwardIterator, typename _OutputIterator>
+    _OutputIterator lower_bound_batch(_ForwardIterator first,
+                                      _ForwardIterator last,
+                                      _OutputIterator out );
+    template <typename _ForwardIterator, typename _OutputIterator>
+    _OutputIterator lower_bound_batch(_ForwardIterator first,
+                                      _ForwardIterator last,
+                                      _OutputIterator out ) const;
+    
     
     // Assignment
     fixed_eytzinger_map& operator=( const fixed_eytzinger_map& other );
-    fixed_eytzinger_map& operator=( fixed_eytzinger_map&& other ) noexcept;
+    fixed_eytzinger_map& operator=( fixed_eytzinger_map&& other ) noexcept(
+        std::allocator_traits<_Allocator>::propagate_on_container_move_assignment::value );
     fixed_eytzinger_map& operator=( std::initializer_list<value_type> l );
     template<typename _InputIterator>
     void assign( _InputIterator begin, _InputIterator end );
     void assign( std::initializer_list<value_type> l );
+    template<typename _VectorAllocator>
+    void assign( std::vector<value_type, _VectorAllocator>&& v );
+    template<typename _InputIterator>
+    void assign( fixed_eytzinger_sorted_unique_t, _InputIterator begin, _InputIterator end );
+    template<typename _Executor, typename _InputIterator>
+    void assign( const fixed_eytzinger_parallel_t<_Executor>& par,
+                 _InputIterator begin,
+                 _InputIterator end );
+    
+    // Applies a sorted change set in linear time, as the constructor from a map does. Elements
+    // which stay are moved to the new layout if the changes can be copied without throwing, so
+    // the map is left unchanged on exceptions.
+    template<typename _ForwardIterator>
+    void rebuild( fixed_eytzinger_sorted_unique_t,
+                  _ForwardIterator begin,
+                  _ForwardIterator end );
+    template<typename _ForwardIterator, typename _KeyIterator>
+    void rebuild( fixed_eytzinger_sorted_unique_t,
+                  _ForwardIterator begin,
+                  _ForwardIterator end,
+                  _KeyIterator erase_begin,
+                  _KeyIterator erase_end );
     
 private:
-    void alloc_init( size_t _count );
-    value_type *init_fill( size_t _base, value_type *_first);
-    void deallocate() noexcept;
-    void construct_at( size_t _p, _Key &&_k, _Value &&_v ) noexcept;
-    void destroy_at( size_t _p ) noexcept;
-    void destroy_all() noexcept;
-    bool comp(const _Key& _v1, const _Key &_v2) const noexcept;
-    bool equal(const _Key& _v1, const _Key &_v2) const noexcept;
-    template <class _K1, class _K2>
-    bool comp2(const _K1& _v1, const _K2 &_v2) const noexcept;
-    template <class _K1, class _K2>
-    bool equal2(const _K1& _v1, const _K2 &_v2) const noexcept;
+    typedef __eytzinger::__storage<_Key, _Value, _Compare, _Allocator> __base;
+    typedef typename __base::alloc_traits alloc_traits;
+    typedef typename __base::scratch_type scratch_type;
     
+    template <typename _Vector>
+    void init( _Vector &_t );
+    template <typename _InputIterator>
+    void init_unsorted( _InputIterator _begin, _InputIterator _end, std::input_iterator_tag );
+    template <typename _ForwardIterator>
+    void init_unsorted( _ForwardIterator _begin, _ForwardIterator _end, std::forward_iterator_tag );
+    template <typename _ForwardIterator>
+    void init_indirect( _ForwardIterator _begin, _ForwardIterator _end, std::false_type );
+    template <typename _ForwardIterator>
+    void init_indirect( _ForwardIterator _begin, _ForwardIterator _end, std::true_type );
+    template <typename _Executor>
+    void init_parallel( scratch_type &_t, _Executor _ex );
+    template <bool _Move, typename _Map, typename _ForwardIterator, typename _KeyIterator>
+    void init_merge( _Map &_base,
+                     _ForwardIterator _first, _ForwardIterator _last,
+                     _KeyIterator _erase_first, _KeyIterator _erase_last );
+    template <bool _Validate, typename _ForwardIterator, typename _KeyIterator,
+              typename _Keep, typename _Add>
+    void merge_walk( const _Key *_keys, size_t _count,
+                     _ForwardIterator _first, _ForwardIterator _last,
+                     _KeyIterator _erase_first, _KeyIterator _erase_last,
+                     _Keep _keep, _Add _add ) const;
+    void construct_at( size_t _p, _Key &&_k, _Value &&_v ) noexcept;
+    template <typename _Range, typename _K2>
+    _Range make_range( const _K2& _lo, const _K2& _hi ) const noexcept;
+    static const unsigned prefetch_distance = fixed_eytzinger_prefetch_distance<_Key>::value;
     [[noreturn]] void throw_at() const
     { throw std::out_of_range("fixed_eytzinger_map::at:  key not found"); }
     [[noreturn]] void throw_sb() const
     { throw std::out_of_range("fixed_eytzinger_map::operator[]:  key not found"); }
     
-    size_type    __m_count;
-    key_type    *__m_keys;
-    mapped_type *__m_values;
-};
-
-template <typename _Key, typename _Value, typename _Compare>
-struct fixed_eytzinger_map<_Key, _Value, _Compare>::proxy_iterator
-{
-	typedef std::bidirectional_iterator_tag         iterator_category;
-	typedef ptrdiff_t                               difference_type;
-	typedef std::pair<_Key, _Value>                 value_type;
-	typedef pair_ptr_wrap                           pointer;
-	typedef std::pair<const _Key&, _Value&>         reference;
-
-	proxy_iterator() noexcept : k(nullptr), v(nullptr)
-	{ }
-	proxy_iterator(const _Key *_k, _Value *_v) noexcept : k(_k), v(_v)
-	{ }
-	reference operator *() const noexcept
-	{
-		return reference{ *k, *v };
-	}
-	pointer operator->() const noexcept
-	{
-		return pointer{ k, v };
-	}
-	reference operator[](difference_type _n) const noexcept
-	{
-		return *(*this + _n);
-	}
-	proxy_iterator &operator++() noexcept
-	{
-		++k; ++v; return *this;
-	}
-	proxy_iterator operator++(int) noexcept
-	{
-		proxy_iterator __tmp = *this; ++(*this); return __tmp;
-	}
-	proxy_iterator &operator--() noexcept
-	{
-		--k; --v; return *this;
-	}
-	proxy_iterator operator--(int) noexcept
-	{
-		proxy_iterator __tmp = *this; --(*this); return __tmp;
-	}
-	proxy_iterator &operator+=(difference_type _d) noexcept
-	{
-		k += _d; v += _d; return *this;
-	}
-	proxy_iterator &operator-=(difference_type _d) noexcept
-	{
-		k -= _d; v -= _d; return *this;
-	}
-	proxy_iterator operator -(difference_type _d) noexcept
-	{
-		proxy_iterator __tmp = *this; return __tmp -= _d;
-	}
-	difference_type operator-(const proxy_iterator &_rhs) const noexcept
-	{
-		return k - _rhs.k;
-	}
-	bool operator ==(const proxy_iterator &_rhs) const noexcept
-	{
-		return k == _rhs.k;
-	}
-	bool operator !=(const proxy_iterator &_rhs) const noexcept
-	{
-		return k != _rhs.k;
-	}
-	bool operator  <(const proxy_iterator &_rhs) const noexcept
-	{
-		return k < _rhs.k;
-	}
-	bool operator  >(const proxy_iterator &_rhs) const noexcept
-	{
-		return k > _rhs.k;
-	}
-	bool operator <=(const proxy_iterator &_rhs) const noexcept
-	{
-		return k <= _rhs.k;
-	}
-	bool operator >=(const proxy_iterator &_rhs) const noexcept
-	{
-		return k >= _rhs.k;
-	}
-private:
-	const _Key *k;
-	_Value *v;
-	friend class fixed_eytzinger_map;
-};
-
-template <typename _Key, typename _Value, typename _Compare>
-struct fixed_eytzinger_map<_Key, _Value, _Compare>::const_proxy_iterator
-{
-	typedef std::bidirectional_iterator_tag         iterator_category;
-	typedef ptrdiff_t                               difference_type;
-	typedef std::pair<_Key, _Value>                 value_type;
-	typedef const_pair_ptr_wrap                     pointer;
-	typedef std::pair<const _Key&, const _Value&>   reference;
-
-	const_proxy_iterator() noexcept : k(nullptr), v(nullptr)
-	{ }
-	const_proxy_iterator(const _Key *_k, const _Value *_v) noexcept : k(_k), v(_v)
-	{ }
-	reference operator *() const noexcept
-	{
-		return reference{ *k, *v };
-	}
-	pointer operator->() const noexcept
-	{
-		return pointer{ k, v };
-	}
-	reference operator[](difference_type _n) const noexcept
-	{
-		return *(*this + _n);
-	}
-	const_proxy_iterator &operator++() noexcept
-	{
-		++k; ++v; return *this;
-	}
-	const_proxy_iterator operator++(int) noexcept
-	{
-		proxy_iterator __tmp = *this; ++(*this); return __tmp;
-	}
-	const_proxy_iterator &operator--() noexcept
-	{
-		--k; --v; return *this;
-	}
-	const_proxy_iterator operator--(int) noexcept
-	{
-		proxy_iterator __tmp = *this; --(*this); return __tmp;
-	}
-	const_proxy_iterator &operator+=(difference_type _d) noexcept
-	{
-		k += _d; v += _d; return *this;
-	}
-	const_proxy_iterator &operator-=(difference_type _d) noexcept
-	{
-		k -= _d; v -= _d; return *this;
-	}
-	const_proxy_iterator operator -(difference_type _d) noexcept
-	{
-		proxy_iterator __tmp = *this; return __tmp -= _d;
-	}
-	difference_type operator-(const const_proxy_iterator &_rhs) const noexcept
-	{
-		return k - _rhs.k;
-	}
-	bool operator ==(const const_proxy_iterator &_rhs) const noexcept
-	{
-		return k == _rhs.k;
-	}
-	bool operator !=(const const_proxy_iterator &_rhs) const noexcept
-	{
-		return k != _rhs.k;
-	}
-	bool operator  <(const const_proxy_iterator &_rhs) const noexcept
-	{
-		return k < _rhs.k;
-	}
-	bool operator  >(const const_proxy_iterator &_rhs) const noexcept
-	{
-		return k > _rhs.k;
-	}
-	bool operator <=(const const_proxy_iterator &_rhs) const noexcept
-	{
-		return k <= _rhs.k;
-	}
-	bool operator >=(const const_proxy_iterator &_rhs) const noexcept
-	{
-		return k >= _rhs.k;
-	}
-private:
-	const _Key *k;
-	const _Value *v;
-	friend class fixed_eytzinger_map;
+    using __base::__m_count;
+    using __base::__m_keys;
+    using __base::__m_values;
+    using __base::__m_alloc;
+    using __base::alloc_init;
+    using __base::init_sorted;
+    using __base::emplace_at;
+    using __base::destroy_at;
+    using __base::deallocate;
+    using __base::swap_data;
+    using __base::throw_unsorted;
+    using __base::comparator;
+    using __base::comp;
+    using __base::equal;
+    using __base::comp2;
+    using __base::equal2;
+    
+    friend struct __eytzinger::__access;
 };
 
-template <typename _Key, typename _Value, typename _Compare>
-fixed_eytzinger_map<_Key, _Value, _Compare>::fixed_eytzinger_map( ) :
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::fixed_eytzinger_map( ) :
  fixed_eytzinger_map( _Compare() )
 {
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-fixed_eytzinger_map<_Key, _Value, _Compare>::fixed_eytzinger_map( const _Compare& _comp ) :
-    _Compare(_comp),
-    __m_count(0),
-    __m_keys(nullptr),
-    __m_values(nullptr)
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_map( const _Compare& _comp, const _Allocator& _alloc ) :
+    __base( _comp, _alloc )
 {
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-fixed_eytzinger_map<_Key, _Value, _Compare>::
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_map( const _Allocator& _alloc ) :
+    fixed_eytzinger_map( _Compare(), _alloc )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
 fixed_eytzinger_map( fixed_eytzinger_map&& _other ) :
-    _Compare( _other ),
-    __m_count( _other.__m_count ),
-    __m_keys( _other.__m_keys ),
-    __m_values( _other.__m_values )
+    __base( std::move(_other) )
 {
-    _other.__m_count = 0;
-    _other.__m_keys = nullptr;
-    _other.__m_values = nullptr;
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-fixed_eytzinger_map<_Key, _Value, _Compare>::
-fixed_eytzinger_map( const fixed_eytzinger_map& _other )
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_map( fixed_eytzinger_map&& _other, const _Allocator& _alloc ) :
+    __base( std::move(_other), _alloc )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_map( const fixed_eytzinger_map& _other ) :
+    __base( _other )
 {
-    alloc_init( _other.__m_count );
-    
-    _Key *last_key = __m_keys;
-    _Value *last_value = __m_values;
-    try {
-        for( size_type n = 0; n < __m_count; ++n, ++last_key )
-            ::new((void*)(__m_keys+n)) _Key( _other.__m_keys[n] );
-        for( size_type n = 0; n < __m_count; ++n, ++last_value )
-            ::new((void*)(__m_values+n)) _Value( _other.__m_values[n] );
-    }
-    catch( ... ) {
-        for( _Key *it = __m_keys; it < last_key; ++it )
-            it->~_Key();
-        for( _Value *it = __m_values; it < last_value; ++it )
-            it->~_Value();
-		deallocate();
-        std::rethrow_exception( std::current_exception() );
-    }
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-fixed_eytzinger_map<_Key, _Value, _Compare>::
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_map( const fixed_eytzinger_map& _other, const _Allocator& _alloc ) :
+    __base( _other, _alloc )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
 fixed_eytzinger_map(std::initializer_list<value_type> _l,
-                    const _Compare& _comp):
-    _Compare(_comp),
-    __m_count(0),
-    __m_keys(nullptr),
-    __m_values(nullptr)
-{
-    std::vector<value_type> t{ std::begin(_l), std::end(_l) };
-    std::sort(t.begin(), t.end(), [this](const value_type &_v1, const value_type &_v2) {
-        return comp(_v1.first, _v2.first);
-    });
-    t.erase( std::unique( t.begin(), t.end(), [this](const value_type &_v1, const value_type &_v2){
-        return equal(_v1.first, _v2.first);
-    }), t.end());
-    
-    alloc_init( t.size() );
-    init_fill( 0, t.data() );
+                    const _Compare& _comp,
+                    const _Allocator& _alloc):
+    fixed_eytzinger_map( _comp, _alloc )
+{
+    init_unsorted( std::begin(_l), std::end(_l), std::random_access_iterator_tag() );
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_map(std::initializer_list<value_type> _l,
+                    const _Allocator& _alloc):
+    fixed_eytzinger_map( _l, _Compare(), _alloc )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template<typename _InputIterator>
-fixed_eytzinger_map<_Key, _Value, _Compare>::fixed_eytzinger_map(_InputIterator _begin,
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::fixed_eytzinger_map(_InputIterator _begin,
                                                                  _InputIterator _end,
-                                                                 const _Compare& _comp ):
-    _Compare(_comp),
-    __m_count(0),
-    __m_keys(nullptr),
-    __m_values(nullptr)
+                                                                 const _Compare& _comp,
+                                                                 const _Allocator& _alloc ):
+    fixed_eytzinger_map( _comp, _alloc )
 {
     static_assert( std::is_constructible<value_type,
                         typename std::iterator_traits<_InputIterator>::reference>::
                         value,
                     "incompatible iterator type");
-    std::vector<value_type> t{ _begin, _end };
-    std::sort(std::begin(t), std::end(t), [this](const value_type &_v1, const value_type &_v2) {
-        return comp(_v1.first, _v2.first);
-    });
-    t.erase( std::unique( t.begin(), t.end(), [this](const value_type &_v1, const value_type &_v2){
-        return equal(_v1.first, _v2.first);
-    }), t.end());
+    init_unsorted( _begin, _end,
+                   typename std::iterator_traits<_InputIterator>::iterator_category() );
+}
 
-    alloc_init( t.size() );
-    init_fill( 0, t.data() );
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _InputIterator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::fixed_eytzinger_map(_InputIterator _begin,
+                                                                 _InputIterator _end,
+                                                                 const _Allocator& _alloc ):
+    fixed_eytzinger_map( _begin, _end, _Compare(), _alloc )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _VectorAllocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_map(std::vector<value_type, _VectorAllocator>&& _v,
+                    const _Compare& _comp,
+                    const _Allocator& _alloc ):
+    fixed_eytzinger_map( _comp, _alloc )
+{
+    std::vector<value_type, _VectorAllocator> t( std::move(_v) ); // freed once the map is built
+    _v.clear();
+    init( t );
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-fixed_eytzinger_map<_Key, _Value, _Compare>::
-~fixed_eytzinger_map()
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _VectorAllocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_map(std::vector<value_type, _VectorAllocator>&& _v,
+                    const _Allocator& _alloc ):
+    fixed_eytzinger_map( std::move(_v), _Compare(), _alloc )
 {
-    destroy_all();
-	deallocate();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-void fixed_eytzinger_map<_Key, _Value, _Compare>::deallocate() noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_map(fixed_eytzinger_sorted_unique_t,
+                    std::initializer_list<value_type> _l,
+                    const _Compare& _comp,
+                    const _Allocator& _alloc):
+    fixed_eytzinger_map( _comp, _alloc )
 {
-    if( __m_keys ) {
-        ::operator delete( __m_keys );
-        __m_keys = nullptr;
-    }
-    if( __m_values ) {
-        ::operator delete( __m_values );
-        __m_values = nullptr;
-    }
-    __m_count = 0;
+    this->template init_fill<true>( _l.size(), std::begin(_l) );
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-void fixed_eytzinger_map<_Key, _Value, _Compare>::destroy_at( size_t _p ) noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _InputIterator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_map(fixed_eytzinger_sorted_unique_t,
+                    _InputIterator _begin,
+                    _InputIterator _end,
+                    const _Compare& _comp,
+                    const _Allocator& _alloc ):
+    fixed_eytzinger_map( _comp, _alloc )
 {
-    (__m_keys+_p)->~_Key();
-    (__m_values+_p)->~_Value();
+    static_assert( std::is_constructible<value_type,
+                        typename std::iterator_traits<_InputIterator>::reference>::
+                        value,
+                    "incompatible iterator type");
+    init_sorted( _begin, _end,
+                 typename std::iterator_traits<_InputIterator>::iterator_category() );
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-void fixed_eytzinger_map<_Key, _Value, _Compare>::destroy_all() noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _ForwardIterator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_map(const fixed_eytzinger_map& _base,
+                    fixed_eytzinger_sorted_unique_t _tag,
+                    _ForwardIterator _begin,
+                    _ForwardIterator _end ):
+    fixed_eytzinger_map( _base, _tag, _begin, _end,
+                         static_cast<const _Key*>(nullptr), static_cast<const _Key*>(nullptr) )
 {
-    for( _Key *_first = __m_keys, *_last = __m_keys + __m_count; _first != _last; _first++ )
-        _first->~_Key();
-    for( _Value *_first = __m_values, *_last = __m_values + __m_count; _first != _last; _first++ )
-        _first->~_Value();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-void fixed_eytzinger_map<_Key, _Value, _Compare>::alloc_init( size_t _count )
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _ForwardIterator, typename _KeyIterator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_map(const fixed_eytzinger_map& _base,
+                    fixed_eytzinger_sorted_unique_t,
+                    _ForwardIterator _begin,
+                    _ForwardIterator _end,
+                    _KeyIterator _erase_begin,
+                    _KeyIterator _erase_end ):
+    fixed_eytzinger_map( _base.comparator(),
+                         alloc_traits::select_on_container_copy_construction(_base.__m_alloc) )
+{
+    init_merge<false>( _base, _begin, _end, _erase_begin, _erase_end );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _Executor, typename _InputIterator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_map(const fixed_eytzinger_parallel_t<_Executor>& _par,
+                    _InputIterator _begin,
+                    _InputIterator _end,
+                    const _Compare& _comp,
+                    const _Allocator& _alloc ):
+    fixed_eytzinger_map( _comp, _alloc )
 {
-    __m_count = _count;
-    try {
-        __m_keys = static_cast<_Key*>( ::operator new(_count * sizeof(_Key)) );
-        __m_values = static_cast<_Value*>( ::operator new(_count * sizeof(_Value)) );
-    } catch( ... ) {
-		deallocate();
-        std::rethrow_exception( std::current_exception() );
-    }
+    static_assert( std::is_constructible<value_type,
+                        typename std::iterator_traits<_InputIterator>::reference>::
+                        value,
+                    "incompatible iterator type");
+    scratch_type t( _begin, _end, __m_alloc );
+    init_parallel( t, _par.executor );
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-void fixed_eytzinger_map<_Key, _Value, _Compare>::
-construct_at( size_t _p, _Key &&_k, _Value &&_v ) noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+_Allocator fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::get_allocator() const noexcept
 {
-    ::new((void*)(__m_keys+_p)) _Key( std::move(_k) );
-    ::new((void*)(__m_values+_p)) _Value( std::move(_v) );
+    return __m_alloc;
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::value_type *
-fixed_eytzinger_map<_Key, _Value, _Compare>::
-init_fill( size_t _base, value_type *_first )
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _Vector>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::init( _Vector &_t )
 {
-    if( _base >= __m_count )
-        return _first;
+    std::sort(std::begin(_t), std::end(_t), [this](const value_type &_v1, const value_type &_v2) {
+        return comp(_v1.first, _v2.first);
+    });
+    _t.erase( std::unique( _t.begin(), _t.end(),
+                           [this](const value_type &_v1, const value_type &_v2){
+        return equal(_v1.first, _v2.first);
+    }), _t.end());
 
-	_first = init_fill( 2 * _base + 1, _first ); // left branch
-    
-    construct_at( _base, std::move(_first->first), std::move(_first->second) ); // leaf
-    ++_first;
+    this->template init_fill<false>( _t.size(), std::make_move_iterator(_t.begin()) );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _InputIterator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+init_unsorted( _InputIterator _begin, _InputIterator _end, std::input_iterator_tag )
+{
+    scratch_type t( _begin, _end, __m_alloc );
+    init( t );
+}
 
-	_first = init_fill( 2 * _base + 2, _first ); // right branch
+// Elements which are not bigger than the entries of an indirect sort are sorted by value, as
+// that's faster and takes no more memory. Bigger ones are sorted by their iterators, along with
+// copies of their keys when these are small and trivial, and then copied straight into the map.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _ForwardIterator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+init_unsorted( _ForwardIterator _begin, _ForwardIterator _end, std::forward_iterator_tag )
+{
+    typedef std::integral_constant<bool, std::is_trivially_copyable<_Key>::value &&
+                                         sizeof(_Key) <= sizeof(_ForwardIterator)> __keyed;
+    if( sizeof(value_type) <= ( __keyed::value ? sizeof(std::pair<_Key, _ForwardIterator>) :
+                                                 sizeof(_ForwardIterator) ) )
+        init_unsorted( _begin, _end, std::input_iterator_tag() );
+    else
+        init_indirect( _begin, _end, __keyed() );
+}
 
-	return _first;
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _ForwardIterator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+init_indirect( _ForwardIterator _begin, _ForwardIterator _end, std::false_type )
+{
+    typedef _ForwardIterator __entry;
+    std::vector<__entry, typename alloc_traits::template rebind_alloc<__entry> > __t( __m_alloc );
+    __t.reserve( (size_t)std::distance(_begin, _end) );
+    for( ; _begin != _end; ++_begin )
+        __t.push_back( _begin );
+    std::sort(std::begin(__t), std::end(__t), [this](const __entry &_e1, const __entry &_e2) {
+        return comp((*_e1).first, (*_e2).first);
+    });
+    __t.erase( std::unique( __t.begin(), __t.end(),
+                            [this](const __entry &_e1, const __entry &_e2){
+        return equal((*_e1).first, (*_e2).first);
+    }), __t.end());
+    
+    this->template init_fill<false>(
+        __t.size(), __eytzinger::__indirect_iterator<_ForwardIterator, __entry>{__t.data()} );
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-void fixed_eytzinger_map<_Key, _Value, _Compare>::
-clear() noexcept
-{
-    destroy_all();
-	deallocate();
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _ForwardIterator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+init_indirect( _ForwardIterator _begin, _ForwardIterator _end, std::true_type )
+{
+    typedef std::pair<_Key, _ForwardIterator> __entry;
+    std::vector<__entry, typename alloc_traits::template rebind_alloc<__entry> > __t( __m_alloc );
+    __t.reserve( (size_t)std::distance(_begin, _end) );
+    for( ; _begin != _end; ++_begin )
+        __t.emplace_back( (*_begin).first, _begin );
+    std::sort(std::begin(__t), std::end(__t), [this](const __entry &_e1, const __entry &_e2) {
+        return comp(_e1.first, _e2.first);
+    });
+    __t.erase( std::unique( __t.begin(), __t.end(),
+                            [this](const __entry &_e1, const __entry &_e2){
+        return equal(_e1.first, _e2.first);
+    }), __t.end());
+    
+    this->template init_fill<false>(
+        __t.size(), __eytzinger::__indirect_iterator<_ForwardIterator, __entry>{__t.data()} );
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-void fixed_eytzinger_map<_Key, _Value, _Compare>::
-swap( fixed_eytzinger_map& other ) noexcept
-{
-    std::swap(__m_count, other.__m_count);
-    std::swap(__m_keys, other.__m_keys);
-    std::swap(__m_values, other.__m_values);
-    std::swap((_Compare&)*this, (_Compare&)other);
+// Sorts chunks of the input in parallel and merges them pairwise, then removes duplicates and
+// lets every task fill the nodes of its own range of ranks. A task finds the first node of its
+// range directly and walks the rest in order.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _Executor>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+init_parallel( scratch_type &_t, _Executor _ex )
+{
+    const size_type __min_chunk = 16384;
+    const size_type __tasks = std::max( size_type(1), std::min( size_type(_ex.concurrency()),
+                                                                _t.size() / __min_chunk ) );
+    if( __tasks == 1 ) {
+        init( _t );
+        return;
+    }
+    
+    const auto __less = [this](const value_type &_v1, const value_type &_v2) {
+        return comp(_v1.first, _v2.first);
+    };
+    const auto __chunk = [&](size_type _i) {
+        return _t.begin() + ( _i < __tasks ? _t.size() / __tasks * _i : _t.size() );
+    };
+    _ex( __tasks, [&](size_type _i) {
+        std::sort( __chunk(_i), __chunk(_i + 1), __less );
+    });
+    for( size_type __width = 1; __width < __tasks; __width *= 2 )
+        _ex( (__tasks + 2 * __width - 1) / (2 * __width), [&](size_type _i) {
+            const size_type __first = 2 * __width * _i;
+            std::inplace_merge( __chunk(__first),
+                                __chunk(std::min(__first + __width, __tasks)),
+                                __chunk(std::min(__first + 2 * __width, __tasks)),
+                                __less );
+        });
+    _t.erase( std::unique( _t.begin(), _t.end(),
+                           [this](const value_type &_v1, const value_type &_v2){
+        return equal(_v1.first, _v2.first);
+    }), _t.end());
+    
+    alloc_init( _t.size() );
+    const size_type __count = __m_count;
+    const auto __rank = [&](size_type _i) {
+        return _i < __tasks ? __count / __tasks * _i : __count;
+    };
+    _ex( __tasks, [&](size_type _i) {
+        size_type __k = __rank(_i);
+        size_type __j = __k < __count ? __eytzinger::__inorder_at( __k, __count ) : __count;
+        for( ; __k < __rank(_i + 1); ++__k, __j = __eytzinger::__inorder_next(__j, __count) )
+            construct_at( __j, std::move(_t[__k].first), std::move(_t[__k].second) );
+    });
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-bool fixed_eytzinger_map<_Key, _Value, _Compare>::
-comp(const _Key& _v1, const _Key &_v2) const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+construct_at( size_t _p, _Key &&_k, _Value &&_v ) noexcept
 {
-    return _Compare::operator()(_v1, _v2);
+    ::new((void*)(__m_keys+_p)) _Key( std::move(_k) );
+    ::new((void*)(__m_values+_p)) _Value( std::move(_v) );
 }
-template <typename _Key, typename _Value, typename _Compare>
-bool fixed_eytzinger_map<_Key, _Value, _Compare>::
-equal(const _Key& _v1, const _Key &_v2) const noexcept
-{
-    return !comp(_v1, _v2) && !comp(_v2, _v1);
+
+// Lays out the elements of _base merged with a sorted change set in two passes: the first one
+// validates the changes and counts the elements, the second one fills the nodes in order. With
+// _Move set, the elements of _base which stay are moved rather than copied.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <bool _Move, typename _Map, typename _ForwardIterator, typename _KeyIterator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+init_merge( _Map &_base,
+            _ForwardIterator _first, _ForwardIterator _last,
+            _KeyIterator _erase_first, _KeyIterator _erase_last )
+{
+    typedef typename std::conditional<_Move, _Key&&, const _Key&>::type key_reference;
+    typedef typename std::conditional<_Move, _Value&&, const _Value&>::type value_reference;
+    
+    size_type __count = 0;
+    merge_walk<true>( _base.__m_keys, _base.__m_count, _first, _last, _erase_first, _erase_last,
+                      [&]( size_t ) { ++__count; },
+                      [&]( const _ForwardIterator& ) { ++__count; } );
+    alloc_init( __count );
+    
+    size_type __j = __eytzinger::__inorder_first(__count), __n = 0;
+    try {
+        merge_walk<false>( _base.__m_keys, _base.__m_count,
+                           _first, _last, _erase_first, _erase_last,
+                           [&]( size_t _i ) {
+                               emplace_at( __j, static_cast<key_reference>(_base.__m_keys[_i]),
+                                           static_cast<value_reference>(_base.__m_values[_i]) );
+                               ++__n;
+                               __j = __eytzinger::__inorder_next( __j, __count );
+                           },
+                           [&]( const _ForwardIterator &_i ) {
+                               emplace_at( __j, (*_i).first, (*_i).second );
+                               ++__n;
+                               __j = __eytzinger::__inorder_next( __j, __count );
+                           } );
+    }
+    catch( ... ) {
+        for( __j = __eytzinger::__inorder_first(__count); __n--;
+             __j = __eytzinger::__inorder_next(__j, __count) )
+            destroy_at( __j );
+        deallocate();
+        std::rethrow_exception( std::current_exception() );
+    }
+}
+
+// Walks the _count nodes of _keys in order along with the changes, and calls _keep with the node
+// of every element which stays and _add with the iterator of every change, in the order of keys.
+// With _Validate set, throws std::invalid_argument if the changes or the keys to erase aren't
+// sorted.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <bool _Validate, typename _ForwardIterator, typename _KeyIterator,
+          typename _Keep, typename _Add>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+merge_walk( const _Key *_keys, size_t _count,
+            _ForwardIterator _first, _ForwardIterator _last,
+            _KeyIterator _erase_first, _KeyIterator _erase_last,
+            _Keep _keep, _Add _add ) const
+{
+    size_t __j = __eytzinger::__inorder_first( _count );
+    _KeyIterator __erased = _erase_last;
+    auto __step = [&] {
+        for( ; _erase_first != _erase_last && comp2(*_erase_first, _keys[__j]); ++_erase_first ) {
+            if( _Validate && __erased != _erase_last && comp2(*_erase_first, *__erased) )
+                throw_unsorted();
+            __erased = _erase_first;
+        }
+        if( _erase_first == _erase_last || comp2(_keys[__j], *_erase_first) )
+            _keep( __j );
+        __j = __eytzinger::__inorder_next( __j, _count );
+    };
+    
+    for( _ForwardIterator __prev = _last; _first != _last; __prev = _first, ++_first ) {
+        if( _Validate && __prev != _last && !comp2((*__prev).first, (*_first).first) )
+            throw_unsorted();
+        while( __j != _count && comp2(_keys[__j], (*_first).first) )
+            __step();
+        if( __j != _count && !comp2((*_first).first, _keys[__j]) )
+            __j = __eytzinger::__inorder_next( __j, _count ); // replaced
+        _add( _first );
+    }
+    while( __j != _count )
+        __step();
+    
+    for( ; _Validate && _erase_first != _erase_last; __erased = _erase_first++ )
+        if( __erased != _erase_last && comp2(*_erase_first, *__erased) )
+            throw_unsorted();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-template <class _K1, class _K2>
-bool fixed_eytzinger_map<_Key, _Value, _Compare>::
-comp2(const _K1& _v1, const _K2 &_v2) const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+clear() noexcept
 {
-    return _Compare::operator()(_v1, _v2);
+    __base::clear();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-template <class _K1, class _K2>
-bool fixed_eytzinger_map<_Key, _Value, _Compare>::
-equal2(const _K1& _v1, const _K2 &_v2) const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+swap( fixed_eytzinger_map& other ) noexcept
 {
-    return !_Compare::operator()(_v1, _v2) && !_Compare::operator()(_v2, _v1);
+    __base::swap(other);
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-bool fixed_eytzinger_map<_Key,_Value, _Compare>::empty() const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+bool fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::empty() const noexcept
 {
     return __m_count == 0;
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::size_type
-fixed_eytzinger_map<_Key, _Value, _Compare>::size() const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::size() const noexcept
 {
     return __m_count;
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::size_type
-fixed_eytzinger_map<_Key, _Value, _Compare>::max_size() const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::max_size() const noexcept
 {
     return std::numeric_limits<size_type>::max() / 4;
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::begin() noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::key_compare
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::key_comp() const
+{
+    return comparator();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::begin() noexcept
 {
     return iterator{ __m_keys, __m_values };
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::const_iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::begin() const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::begin() const noexcept
 {
     return const_iterator{ __m_keys, __m_values };
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::const_iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::cbegin() const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::cbegin() const noexcept
 {
     return begin();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::end() noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::end() noexcept
 {
     return iterator{ __m_keys + __m_count, __m_values + __m_count };
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::const_iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::end() const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::end() const noexcept
 {
     return const_iterator{ __m_keys + __m_count, __m_values + __m_count };
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::const_iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::cend() const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::cend() const noexcept
 {
     return end();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::const_iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::lower_bound(const _Key& _key) const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::ordered_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::ordered_begin() noexcept
 {
-    size_type i = __m_count, j = 0;
-    while( j < __m_count ) {
-        if( comp(__m_keys[j], _key) ){
-            j = 2 * j + 2; // right branch
-        }
-        else {
-            i = j;
-            j = 2 * j + 1; // left branch
-        }
-    }
+    return ordered_iterator{ __m_keys, __m_values,
+                             __eytzinger::__inorder_first(__m_count), __m_count };
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::ordered_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::ordered_end() noexcept
+{
+    return ordered_iterator{ __m_keys, __m_values, __m_count, __m_count };
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_ordered_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::ordered_begin() const noexcept
+{
+    return const_ordered_iterator{ __m_keys, __m_values,
+                                   __eytzinger::__inorder_first(__m_count), __m_count };
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_ordered_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::ordered_end() const noexcept
+{
+    return const_ordered_iterator{ __m_keys, __m_values, __m_count, __m_count };
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::reverse_ordered_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::ordered_rbegin() noexcept
+{
+    return reverse_ordered_iterator{ ordered_end() };
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::reverse_ordered_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::ordered_rend() noexcept
+{
+    return reverse_ordered_iterator{ ordered_begin() };
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_reverse_ordered_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::ordered_rbegin() const noexcept
+{
+    return const_reverse_ordered_iterator{ ordered_end() };
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_reverse_ordered_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::ordered_rend() const noexcept
+{
+    return const_reverse_ordered_iterator{ ordered_begin() };
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+lower_bound(const _Key& _key) const noexcept
+{
+    const size_type i =
+        __eytzinger::__lower_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
     return const_iterator{__m_keys + i, __m_values + i};
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template <typename _K2, typename _C, typename>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::const_iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::lower_bound(const _K2& _key) const noexcept
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::lower_bound(const _K2& _key) const noexcept
 {
-    size_type i = __m_count, j = 0;
-    while( j < __m_count ) {
-        if( comp2(__m_keys[j], _key) ){
-            j = 2 * j + 2; // right branch
-        }
-        else {
-            i = j;
-            j = 2 * j + 1; // left branch
-        }
-    }
+    const size_type i =
+        __eytzinger::__lower_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
     return const_iterator{__m_keys + i, __m_values + i};
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::lower_bound(const _Key& _key) noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::lower_bound(const _Key& _key) noexcept
 {
-    size_type i = __m_count, j = 0;
-    while( j < __m_count ) {
-        if( comp(__m_keys[j], _key) ){
-            j = 2 * j + 2; // right branch
-        }
-        else {
-            i = j;
-            j = 2 * j + 1; // left branch
-        }
-    }
+    const size_type i =
+        __eytzinger::__lower_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
     return iterator{__m_keys + i, __m_values + i};
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template <typename _K2, typename _C, typename>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::lower_bound(const _K2& _key) noexcept
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::lower_bound(const _K2& _key) noexcept
 {
-    size_type i = __m_count, j = 0;
-    while( j < __m_count ) {
-        if( comp2(__m_keys[j], _key) ){
-            j = 2 * j + 2; // right branch
-        }
-        else {
-            i = j;
-            j = 2 * j + 1; // left branch
-        }
-    }
+    const size_type i =
+        __eytzinger::__lower_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
     return iterator{__m_keys + i, __m_values + i};
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::upper_bound( const key_type& _key ) noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+upper_bound( const key_type& _key ) noexcept
 {
-    size_type i = __m_count, j = 0;
-    while( j < __m_count ) {
-        if( comp(_key, __m_keys[j]) ){
-            i = j;
-            j = 2 * j + 1; // left branch
-        }
-        else {
-            j = 2 * j + 2; // right branch
-        }
-    }
+    const size_type i =
+        __eytzinger::__upper_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
     return iterator{__m_keys + i, __m_values + i};
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template <typename _K2, typename _C, typename>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::upper_bound( const _K2& _key ) noexcept
-{
-    size_type i = __m_count, j = 0;
-    while( j < __m_count ) {
-        if( comp2(_key, __m_keys[j]) ){
-            i = j;
-            j = 2 * j + 1; // left branch
-        }
-        else {
-            j = 2 * j + 2; // right branch
-        }
-    }
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::upper_bound( const _K2& _key ) noexcept
+{
+    const size_type i =
+        __eytzinger::__upper_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
     return iterator{__m_keys + i, __m_values + i};
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::const_iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::upper_bound( const key_type& _key ) const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+upper_bound( const key_type& _key ) const noexcept
 {
-    size_type i = __m_count, j = 0;
-    while( j < __m_count ) {
-        if( comp(_key, __m_keys[j]) ){
-            i = j;
-            j = 2 * j + 1; // left branch
-        }
-        else {
-            j = 2 * j + 2; // right branch
-        }
-    }
+    const size_type i =
+        __eytzinger::__upper_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
     return const_iterator{__m_keys + i, __m_values + i};
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template <typename _K2, typename _C, typename>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::const_iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::upper_bound( const _K2& _key ) const noexcept
-{
-    size_type i = __m_count, j = 0;
-    while( j < __m_count ) {
-        if( comp2(_key, __m_keys[j]) ){
-            i = j;
-            j = 2 * j + 1; // left branch
-        }
-        else {
-            j = 2 * j + 2; // right branch
-        }
-    }
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+upper_bound( const _K2& _key ) const noexcept
+{
+    const size_type i =
+        __eytzinger::__upper_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
     return const_iterator{__m_keys + i, __m_values + i};
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::const_iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::find( const _Key& _key ) const noexcept
+// Both bounds are found in the Eytzinger layout. When hi goes before lo, the range is empty, which
+// is told by the keys at the bounds, as bounds of other types might be not comparable.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _Range, typename _K2>
+_Range fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+make_range( const _K2& _lo, const _K2& _hi ) const noexcept
+{
+    const size_type __lo =
+        __eytzinger::__lower_bound<prefetch_distance>(__m_keys, __m_count, _lo, comparator());
+    size_type __hi =
+        __eytzinger::__lower_bound<prefetch_distance>(__m_keys, __m_count, _hi, comparator());
+    if( __lo == __m_count || (__hi != __m_count && comp(__m_keys[__hi], __m_keys[__lo])) )
+        __hi = __lo;
+    typedef decltype(_Range().begin()) __iterator;
+    return _Range{ __iterator{ __m_keys, __m_values, __lo, __m_count },
+                   __iterator{ __m_keys, __m_values, __hi, __m_count } };
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::ordered_range
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+range( const key_type& _lo, const key_type& _hi ) noexcept
+{
+    return make_range<ordered_range>( _lo, _hi );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::ordered_range
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+range( const _K2& _lo, const _K2& _hi ) noexcept
+{
+    return make_range<ordered_range>( _lo, _hi );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_ordered_range
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+range( const key_type& _lo, const key_type& _hi ) const noexcept
+{
+    return make_range<const_ordered_range>( _lo, _hi );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_ordered_range
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+range( const _K2& _lo, const _K2& _hi ) const noexcept
+{
+    return make_range<const_ordered_range>( _lo, _hi );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::find( const _Key& _key ) const noexcept
 {
     const_iterator __p = lower_bound(_key);
-    if( __p != end() && !comp(_key, *__p.k) )
+    if( __p != end() && !comp(_key, __p->first) )
         return __p;
     return end();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template <typename _K2, typename _C, typename>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::const_iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::find( const _K2& _key ) const noexcept
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::find( const _K2& _key ) const noexcept
 {
     const_iterator __p = lower_bound(_key);
-    if( __p != end() && !comp2(_key, *__p.k) )
+    if( __p != end() && !comp2(_key, __p->first) )
         return __p;
     return end();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::find( const _Key& _key ) noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::find( const _Key& _key ) noexcept
 {
     iterator __p = lower_bound(_key);
-    if( __p != end() && !comp(_key, *__p.k) )
+    if( __p != end() && !comp(_key, __p->first) )
         return __p;
     return end();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template <typename _K2, typename _C, typename>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::iterator
-fixed_eytzinger_map<_Key, _Value, _Compare>::find( const _K2& _key ) noexcept
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::iterator
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::find( const _K2& _key ) noexcept
 {
     iterator __p = lower_bound(_key);
-    if( __p != end() && !comp2(_key, *__p.k) )
+    if( __p != end() && !comp2(_key, __p->first) )
         return __p;
     return end();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::range_pair
-fixed_eytzinger_map<_Key, _Value, _Compare>::equal_range( const _Key& _key ) noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::range_pair
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::equal_range( const _Key& _key ) noexcept
 {
     iterator __p = lower_bound(_key);
-    if( __p != end() && !comp(_key, *__p.k) )
+    if( __p != end() && !comp(_key, __p->first) )
         return {__p, std::next(__p, 1)};
     return {end(), end()};
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template <typename _K2, typename _C, typename>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::range_pair
-fixed_eytzinger_map<_Key, _Value, _Compare>::equal_range( const _K2& _key ) noexcept
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::range_pair
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::equal_range( const _K2& _key ) noexcept
 {
     iterator __p = lower_bound(_key);
-    if( __p != end() && !comp2(_key, *__p.k) )
+    if( __p != end() && !comp2(_key, __p->first) )
         return {__p, std::next(__p, 1)};
     return {end(), end()};
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::const_range_pair
-fixed_eytzinger_map<_Key, _Value, _Compare>::equal_range( const _Key& _key ) const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_range_pair
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+equal_range( const _Key& _key ) const noexcept
 {
     const_iterator __p = lower_bound(_key);
-    if( __p != end() && !comp(_key, *__p.k) )
+    if( __p != end() && !comp(_key, __p->first) )
         return {__p, std::next(__p, 1)};
     return {end(), end()};
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template <typename _K2, typename _C, typename>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::const_range_pair
-fixed_eytzinger_map<_Key, _Value, _Compare>::equal_range( const _K2& _key ) const noexcept
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::const_range_pair
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+equal_range( const _K2& _key ) const noexcept
 {
     const_iterator __p = lower_bound(_key);
-    if( __p != end() && !comp2(_key, *__p.k) )
+    if( __p != end() && !comp2(_key, __p->first) )
         return {__p, std::next(__p, 1)};
     return {end(), end()};
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::size_type
-fixed_eytzinger_map<_Key, _Value, _Compare>::count( const key_type& _key ) const noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+count( const key_type& _key ) const noexcept
 {
     const_iterator __p = lower_bound(_key);
-    if( __p != end() && !comp(_key, *__p.k) )
+    if( __p != end() && !comp(_key, __p->first) )
         return 1;
     return 0;
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template <typename _K2, typename _C, typename>
-typename fixed_eytzinger_map<_Key, _Value, _Compare>::size_type
-fixed_eytzinger_map<_Key, _Value, _Compare>::count( const _K2& _key ) const noexcept
+typename fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::count( const _K2& _key ) const noexcept
 {
     const_iterator __p = lower_bound(_key);
-    if( __p != end() && !comp2(_key, *__p.k) )
+    if( __p != end() && !comp2(_key, __p->first) )
         return 1;
     return 0;
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-_Value &fixed_eytzinger_map<_Key, _Value, _Compare>::
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+_Value &fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
 at( const key_type &_key )
 {
     iterator __p = lower_bound(_key);
-    if( __p != end() && !comp(_key, *__p.k) )
-        return *__p.v;
+    if( __p != end() && !comp(_key, __p->first) )
+        return __p->second;
     throw_at();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template <typename _K2, typename _C, typename>
-_Value& fixed_eytzinger_map<_Key, _Value, _Compare>::at( const _K2 &_key )
+_Value& fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::at( const _K2 &_key )
 {
     iterator __p = lower_bound(_key);
-    if( __p != end() && !comp2(_key, *__p.k) )
-        return *__p.v;
+    if( __p != end() && !comp2(_key, __p->first) )
+        return __p->second;
     throw_at();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-const _Value &fixed_eytzinger_map<_Key, _Value, _Compare>::
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+const _Value &fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
 at( const key_type &_key ) const
 {
     const_iterator __p = lower_bound(_key);
-    if( __p != end() && !comp(_key, *__p.k) )
-        return *__p.v;
+    if( __p != end() && !comp(_key, __p->first) )
+        return __p->second;
     throw_at();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template <typename _K2, typename _C, typename>
-const _Value& fixed_eytzinger_map<_Key, _Value, _Compare>::at( const _K2 &_key ) const
+const _Value& fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::at( const _K2 &_key ) const
 {
     const_iterator __p = lower_bound(_key);
-    if( __p != end() && !comp2(_key, *__p.k) )
-        return *__p.v;
+    if( __p != end() && !comp2(_key, __p->first) )
+        return __p->second;
     throw_at();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-_Value& fixed_eytzinger_map<_Key, _Value, _Compare>::
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+_Value& fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
 operator[]( const key_type& _key )
 {
     iterator __p = lower_bound(_key);
-    if( __p != end() && !comp(_key, *__p.k) )
-        return *__p.v;
+    if( __p != end() && !comp(_key, __p->first) )
+        return __p->second;
     throw_sb();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template <typename _K2, typename _C, typename>
-_Value& fixed_eytzinger_map<_Key, _Value, _Compare>::operator[]( const _K2 &_key )
+_Value& fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::operator[]( const _K2 &_key )
 {
     iterator __p = lower_bound(_key);
-    if( __p != end() && !comp2(_key, *__p.k) )
-        return *__p.v;
+    if( __p != end() && !comp2(_key, __p->first) )
+        return __p->second;
     throw_sb();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-const _Value& fixed_eytzinger_map<_Key, _Value, _Compare>::
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+const _Value& fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
 operator[]( const key_type& _key ) const
 {
     const_iterator __p = lower_bound(_key);
-    if( __p != end() && !comp(_key, *__p.k) )
-        return *__p.v;
+    if( __p != end() && !comp(_key, __p->first) )
+        return __p->second;
     throw_sb();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template <typename _K2, typename _C, typename>
-const _Value& fixed_eytzinger_map<_Key, _Value, _Compare>::operator[]( const _K2 &_key ) const
+const _Value& fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+operator[]( const _K2 &_key ) const
 {
     const_iterator __p = lower_bound(_key);
-    if( __p != end() && !comp2(_key, *__p.k) )
-        return *__p.v;
+    if( __p != end() && !comp2(_key, __p->first) )
+        return __p->second;
     throw_sb();
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-fixed_eytzinger_map<_Key, _Value, _Compare>&
-fixed_eytzinger_map<_Key, _Value, _Compare>::
-operator=( fixed_eytzinger_map&& other ) noexcept
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _ForwardIterator, typename _OutputIterator>
+_OutputIterator fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+count_batch( _ForwardIterator _first, _ForwardIterator _last, _OutputIterator _out ) const
+{
+    __base::template check_batch_iterator<_ForwardIterator>();
+    __eytzinger::__lower_bound_batch(__m_keys, __m_count, _first, _last, comparator(),
+                                     [&](_ForwardIterator _k, size_type _i){
+        *_out++ = size_type( _i != __m_count && !comp2(*_k, __m_keys[_i]) );
+    });
+    return _out;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _ForwardIterator, typename _OutputIterator>
+_OutputIterator fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+find_batch( _ForwardIterator _first, _ForwardIterator _last, _OutputIterator _out )
+{
+    __base::template check_batch_iterator<_ForwardIterator>();
+    __eytzinger::__lower_bound_batch(__m_keys, __m_count, _first, _last, comparator(),
+                                     [&](_ForwardIterator _k, size_type _i){
+        if( _i != __m_count && !comp2(*_k, __m_keys[_i]) )
+            *_out++ = iterator{__m_keys + _i, __m_values + _i};
+        else
+            *_out++ = end();
+    });
+    return _out;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _ForwardIterator, typename _OutputIterator>
+_OutputIterator fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+find_batch( _ForwardIterator _first, _ForwardIterator _last, _OutputIterator _out ) const
+{
+    __base::template check_batch_iterator<_ForwardIterator>();
+    __eytzinger::__lower_bound_batch(__m_keys, __m_count, _first, _last, comparator(),
+                                     [&](_ForwardIterator _k, size_type _i){
+        if( _i != __m_count && !comp2(*_k, __m_keys[_i]) )
+            *_out++ = const_iterator{__m_keys + _i, __m_values + _i};
+        else
+            *_out++ = end();
+    });
+    return _out;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _ForwardIterator, typename _OutputIterator>
+_OutputIterator fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+lower_bound_batch( _ForwardIterator _first, _ForwardIterator _last, _OutputIterator _out )
+{
+    __base::template check_batch_iterator<_ForwardIterator>();
+    __eytzinger::__lower_bound_batch(__m_keys, __m_count, _first, _last, comparator(),
+                                     [&](_ForwardIterator, size_type _i){
+        *_out++ = iterator{__m_keys + _i, __m_values + _i};
+    });
+    return _out;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _ForwardIterator, typename _OutputIterator>
+_OutputIterator fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+lower_bound_batch( _ForwardIterator _first, _ForwardIterator _last, _OutputIterator _out ) const
+{
+    __base::template check_batch_iterator<_ForwardIterator>();
+    __eytzinger::__lower_bound_batch(__m_keys, __m_count, _first, _last, comparator(),
+                                     [&](_ForwardIterator, size_type _i){
+        *_out++ = const_iterator{__m_keys + _i, __m_values + _i};
+    });
+    return _out;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>&
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+operator=( fixed_eytzinger_map&& other ) noexcept(
+    std::allocator_traits<_Allocator>::propagate_on_container_move_assignment::value )
 {
-    clear();
-    swap(other);
+    __base::operator=(std::move(other));
     return *this;
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-fixed_eytzinger_map<_Key, _Value, _Compare>&
-fixed_eytzinger_map<_Key, _Value, _Compare>::
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>&
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
 operator=( const fixed_eytzinger_map& other )
 {
-    fixed_eytzinger_map __tmp {other};
-    swap(__tmp);
+    __base::operator=(other);
     return *this;
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-fixed_eytzinger_map<_Key, _Value, _Compare>&
-fixed_eytzinger_map<_Key, _Value, _Compare>::
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>&
+fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
 operator=( std::initializer_list<value_type> l )
 {
-    fixed_eytzinger_map __tmp {l};
-    swap(__tmp);
+    fixed_eytzinger_map __tmp {l, comparator(), get_allocator()};
+    swap_data(__tmp);
     return *this;
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 template<typename _InputIterator>
-void fixed_eytzinger_map<_Key, _Value, _Compare>::
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
 assign(_InputIterator _begin, _InputIterator _end)
 {
     static_assert( std::is_constructible<value_type,
                         typename std::iterator_traits<_InputIterator>::reference>::
                         value,
                     "incompatible iterator type");
-    fixed_eytzinger_map __tmp {_begin, _end};
-    swap(__tmp);
+    fixed_eytzinger_map __tmp {_begin, _end, comparator(), get_allocator()};
+    swap_data(__tmp);
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-void fixed_eytzinger_map<_Key, _Value, _Compare>::
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
 assign( std::initializer_list<value_type> l )
 {
-    fixed_eytzinger_map __tmp {l};
-    swap(__tmp);
+    fixed_eytzinger_map __tmp {l, comparator(), get_allocator()};
+    swap_data(__tmp);
 }
 
-template <typename _Key, typename _Value, typename _Compare>
-struct fixed_eytzinger_map<_Key, _Value, _Compare>::pair_ptr_wrap :
-    std::pair<const _Key&, _Value&>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _VectorAllocator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+assign( std::vector<value_type, _VectorAllocator>&& _v )
 {
-    pair_ptr_wrap(const _Key *_k, _Value *_v) noexcept :
-        std::pair<const _Key&, _Value&>(*_k, *_v) {}
-    
-    const std::pair<const _Key&, _Value&>* operator->() const noexcept
-        { return this; }
-};
+    fixed_eytzinger_map __tmp {std::move(_v), comparator(), get_allocator()};
+    swap_data(__tmp);
+}
 
-template <typename _Key, typename _Value, typename _Compare>
-struct fixed_eytzinger_map<_Key, _Value, _Compare>::const_pair_ptr_wrap :
-    std::pair<const _Key&, const _Value&>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _InputIterator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+assign( fixed_eytzinger_sorted_unique_t _tag, _InputIterator _begin, _InputIterator _end )
 {
-    const_pair_ptr_wrap(const _Key *_k, const _Value *_v) noexcept :
-        std::pair<const _Key&, const _Value&>(*_k, *_v) {}
-    
-    const std::pair<const _Key&, const _Value&>* operator->() const noexcept
-        { return this; }
-};
+    fixed_eytzinger_map __tmp {_tag, _begin, _end, comparator(), get_allocator()};
+    swap_data(__tmp);
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _ForwardIterator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+rebuild( fixed_eytzinger_sorted_unique_t _tag, _ForwardIterator _begin, _ForwardIterator _end )
+{
+    rebuild( _tag, _begin, _end,
+             static_cast<const _Key*>(nullptr), static_cast<const _Key*>(nullptr) );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _ForwardIterator, typename _KeyIterator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+rebuild( fixed_eytzinger_sorted_unique_t,
+         _ForwardIterator _begin,
+         _ForwardIterator _end,
+         _KeyIterator _erase_begin,
+         _KeyIterator _erase_end )
+{
+    typedef typename std::iterator_traits<_ForwardIterator>::reference reference;
+    constexpr bool __move =
+        std::is_nothrow_constructible<_Key, decltype((std::declval<reference>().first))>::value &&
+        std::is_nothrow_constructible<_Value, decltype((std::declval<reference>().second))>::value;
+    fixed_eytzinger_map __tmp {comparator(), get_allocator()};
+    __tmp.template init_merge<__move>( *this, _begin, _end, _erase_begin, _erase_end );
+    swap_data(__tmp);
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _Executor, typename _InputIterator>
+void fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>::
+assign( const fixed_eytzinger_parallel_t<_Executor>& _par,
+        _InputIterator _begin,
+        _InputIterator _end )
+{
+    fixed_eytzinger_map __tmp {_par, _begin, _end, comparator(), get_allocator()};
+    swap_data(__tmp);
+}
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 inline bool
-operator==(const fixed_eytzinger_map<_Key, _Value, _Compare>& __x,
-           const fixed_eytzinger_map<_Key, _Value, _Compare>& __y)
+operator==(const fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>& __x,
+           const fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>& __y)
 {
     return __x.size() == __y.size() && std::equal(__x.begin(), __x.end(), __y.begin());
 }
 
-template <typename _Key, typename _Value, typename _Compare>
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
 inline bool
-operator!=(const fixed_eytzinger_map<_Key, _Value, _Compare>& __x,
-           const fixed_eytzinger_map<_Key, _Value, _Compare>& __y)
+operator!=(const fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>& __x,
+           const fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>& __y)
 {
     return !(__x == __y);
 }
 
+// Returns a map with the elements of both maps, where the elements of __y replace the elements of
+// __x with equal keys. Takes linear time.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+inline fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>
+fixed_eytzinger_merge(const fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>& __x,
+                      const fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>& __y)
+{
+    return fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>(
+        __x, fixed_eytzinger_sorted_unique, __y.ordered_begin(), __y.ordered_end() );
+}
+
 namespace std
 {
-template <typename _Key, typename _Value, typename _Compare>
-inline void swap(fixed_eytzinger_map<_Key, _Value, _Compare>& __x,
-                 fixed_eytzinger_map<_Key, _Value, _Compare>& __y )
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+inline void swap(fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>& __x,
+                 fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator>& __y )
 {
     __y.swap( __x );
 }
 }
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+
+// fixed_eytzinger_map which takes its memory from a std::pmr::memory_resource, e.g. from a
+// std::pmr::monotonic_buffer_resource.
+template <typename _Key, typename _Value, class _Compare = std::less<_Key> >
+using fixed_eytzinger_pmr_map =
+    fixed_eytzinger_map<_Key, _Value, _Compare,
+                        std::pmr::polymorphic_allocator< std::pair<_Key, _Value> > >;
+#endif
+#endif
@@ -0,0 +1,477 @@
+/* Copyright (c) 2017 Michael Kazakov <mike.kazakov@gmail.com>
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#pragma once
+
+#include "fixed_eytzinger_view.h"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <system_error>
+#include <string>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <atomic>
+#include <ctime>
+#endif
+
+// Identifies the comparator of a saved map, so that a file is never opened with an ordering other
+// than the one it was laid out with. std::less and std::greater are tagged out of the box. Maps and
+// views with other comparators can't be saved or opened until this is specialized for them with a
+// nonzero value distinct from the tags of other orderings.
+template <class _Compare>
+struct fixed_eytzinger_comparator_tag : std::integral_constant<std::uint64_t, 0> {};
+template <class _T>
+struct fixed_eytzinger_comparator_tag< std::less<_T> >
+    : std::integral_constant<std::uint64_t, 1> {};
+template <class _T>
+struct fixed_eytzinger_comparator_tag< std::greater<_T> >
+    : std::integral_constant<std::uint64_t, 2> {};
+
+namespace __eytzinger
+{
+
+// Header of a file written by save(). The file holds the arrays of keys and values exactly as they
+// are laid out in memory, with the same cache line alignment relative to the start of the file, so
+// that a mapping of the file can be searched in place. Numbers are stored in the native byte order,
+// which is told by __byte_order.
+struct __file_header
+{
+    char            __magic[8];
+    std::uint32_t   __version;
+    std::uint32_t   __byte_order;
+    std::uint64_t   __count;
+    std::uint32_t   __key_size;
+    std::uint32_t   __key_align;
+    std::uint32_t   __value_size;
+    std::uint32_t   __value_align;
+    std::uint64_t   __comparator;
+    std::uint64_t   __keys_offset;
+    std::uint64_t   __values_offset;
+    std::uint64_t   __file_size;
+    std::uint64_t   __checksum;     // of the bytes of keys followed by the bytes of values
+};
+
+static const char           __file_magic[8] = {'E', 'Y', 'T', 'Z', 'M', 'A', 'P', '\0'};
+static const std::uint32_t  __file_version = 1;
+static const std::uint32_t  __file_byte_order = 0x01020304;
+
+// Fills in everything but the checksum.
+template <class _Key, class _Value, class _Compare>
+inline __file_header __make_file_header( size_t _count ) noexcept
+{
+    __file_header __h;
+    std::memset( &__h, 0, sizeof(__h) );
+    std::memcpy( __h.__magic, __file_magic, sizeof(__file_magic) );
+    __h.__version = __file_version;
+    __h.__byte_order = __file_byte_order;
+    __h.__count = _count;
+    __h.__key_size = sizeof(_Key);
+    __h.__key_align = alignof(_Key);
+    __h.__value_size = sizeof(_Value);
+    __h.__value_align = alignof(_Value);
+    __h.__comparator = fixed_eytzinger_comparator_tag<_Compare>::value;
+    __h.__keys_offset = ((sizeof(__file_header) + 63) & ~std::uint64_t(63)) + sizeof(_Key);
+    __h.__values_offset = (__h.__keys_offset + _count * sizeof(_Key) + 63) & ~std::uint64_t(63);
+    __h.__file_size = __h.__values_offset + _count * sizeof(_Value);
+    return __h;
+}
+
+// 64-bit FNV-1a taken over 8-byte words, continues from _seed.
+inline std::uint64_t __checksum( const void *_data, size_t _size,
+                                 std::uint64_t _seed = 0xcbf29ce484222325ULL ) noexcept
+{
+    const unsigned char *__p = static_cast<const unsigned char*>(_data);
+    std::uint64_t __h = _seed, __w;
+    for( ; _size >= 8; __p += 8, _size -= 8 ) {
+        std::memcpy( &__w, __p, 8 );
+        __h = (__h ^ __w) * 0x100000001b3ULL;
+    }
+    for( ; _size != 0; ++__p, --_size )
+        __h = (__h ^ *__p) * 0x100000001b3ULL;
+    return __h;
+}
+
+[[noreturn]] inline void __throw_save( int _error, const char *_what )
+{
+    throw std::system_error(_error ? _error : EIO, std::generic_category(),
+                            std::string("save: ") + _what);
+}
+
+// Creates a file with a unique name in the directory of _path, so that concurrent saves don't
+// write into the same file. Sets _name to the name of the file, returns nullptr with errno set on
+// failure.
+inline std::FILE *__create_temporary( const char *_path, std::string &_name )
+{
+#if defined(__unix__) || defined(__APPLE__)
+    _name = std::string(_path) + ".XXXXXX";
+    const int __fd = ::mkstemp( &_name[0] );
+    if( __fd < 0 )
+        return nullptr;
+    std::FILE *__f = nullptr;
+    // mkstemp() makes the file private to the owner, the saved map is meant to be shared
+    if( ::fchmod(__fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) != 0 ||
+        !(__f = ::fdopen(__fd, "wb")) ) {
+        const int __error = errno;
+        ::close( __fd );
+        ::unlink( _name.c_str() );
+        errno = __error;
+    }
+    return __f;
+#else
+    static std::atomic<unsigned> __counter{ 0 };
+    _name = std::string(_path) + ".tmp" + std::to_string( (unsigned long long)std::time(nullptr) ) +
+        "." + std::to_string( ++__counter );
+    return std::fopen( _name.c_str(), "wb" );
+#endif
+}
+
+// Replaces _path with _temporary. rename() does it atomically on POSIX systems. Elsewhere it
+// doesn't replace an existing file, which is removed first, so a failure in between leaves no
+// file at _path.
+inline bool __replace_file( const char *_temporary, const char *_path ) noexcept
+{
+#if defined(__unix__) || defined(__APPLE__)
+    return std::rename( _temporary, _path ) == 0;
+#else
+    return std::rename( _temporary, _path ) == 0 ||
+        (std::remove( _path ) == 0 && std::rename( _temporary, _path ) == 0);
+#endif
+}
+
+}
+
+// fixed_eytzinger_map_view is a read-only map over a file written by save() from a map.
+// The file is mapped into memory and searched in place, so opening it takes constant time no
+// matter how big it is, and processes which open the same file share its pages. Lookups are those
+// of fixed_eytzinger_view. On platforms without mmap() the file is read into memory.
+
+template <typename _Key, typename _Value, class _Compare = std::less<_Key> >
+class fixed_eytzinger_map_view : public fixed_eytzinger_view<_Key, _Value, _Compare>
+{
+public:
+    static_assert( std::is_trivially_copyable<_Key>::value &&
+                   std::is_trivially_copyable<_Value>::value,
+                   "only maps with trivially copyable keys and values can be viewed" );
+    static_assert( fixed_eytzinger_comparator_tag<_Compare>::value != 0,
+                   "fixed_eytzinger_comparator_tag has to be specialized for the comparator" );
+    
+    // Construction
+    // Opens a file written by save() from a fixed_eytzinger_map<_Key, _Value, _Compare>. Throws
+    // std::system_error if the file can't be read, and std::runtime_error if it's not a saved
+    // map, has another version of the format or was saved with other key, value or comparator
+    // types. Keys and values are not read at this point, see verify().
+    explicit fixed_eytzinger_map_view( const char *path, const _Compare& comp = _Compare() );
+    
+    // A view of a saved map which is already in memory, e.g. mapped by the caller. The memory is
+    // not owned by the view and must outlive it. Throws as the constructor from a file does, and
+    // std::invalid_argument if the keys or values in data are misaligned for their types.
+    fixed_eytzinger_map_view( const void *data, size_t size, const _Compare& comp = _Compare() );
+    
+    fixed_eytzinger_map_view( fixed_eytzinger_map_view&& other ) noexcept;
+    fixed_eytzinger_map_view( const fixed_eytzinger_map_view& ) = delete;
+    
+    
+    // Destruction
+    ~fixed_eytzinger_map_view();
+    
+    
+    // Assignment
+    fixed_eytzinger_map_view& operator=( fixed_eytzinger_map_view&& other ) noexcept;
+    fixed_eytzinger_map_view& operator=( const fixed_eytzinger_map_view& ) = delete;
+    void swap( fixed_eytzinger_map_view& other ) noexcept;
+    
+    
+    // Integrity
+    // Checks the keys and values against the checksum stored on save(), which reads them all.
+    bool verify() const noexcept;
+    
+private:
+    typedef fixed_eytzinger_view<_Key, _Value, _Compare> view_type;
+    
+    void attach( const void *_data, size_t _size );
+    void release() noexcept;
+    
+    [[noreturn]] static void throw_io( int _error, const char *_what )
+    { throw std::system_error(_error ? _error : EIO, std::generic_category(),
+                              std::string("fixed_eytzinger_map_view: ") + _what); }
+    [[noreturn]] static void throw_format( const char *_what )
+    { throw std::runtime_error(std::string("fixed_eytzinger_map_view: ") + _what); }
+    
+    const void         *__m_data;       // the saved map
+    void               *__m_owned;      // the mapping or the buffer which the view has to free
+    size_t              __m_owned_size;
+};
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_map_view<_Key, _Value, _Compare>::
+fixed_eytzinger_map_view( const char *_path, const _Compare& _comp ) :
+    view_type( nullptr, nullptr, 0, _comp ),
+    __m_data( nullptr ),
+    __m_owned( nullptr ),
+    __m_owned_size( 0 )
+{
+#if defined(__unix__) || defined(__APPLE__)
+    const int __fd = ::open( _path, O_RDONLY );
+    if( __fd < 0 )
+        throw_io( errno, "can't open the file" );
+    struct stat __st;
+    if( ::fstat(__fd, &__st) != 0 ) {
+        const int __error = errno;
+        ::close( __fd );
+        throw_io( __error, "can't open the file" );
+    }
+    if( size_t(__st.st_size) < sizeof(__eytzinger::__file_header) ) {
+        ::close( __fd );
+        throw_format( "not a saved map" );
+    }
+    void *__p = ::mmap( nullptr, size_t(__st.st_size), PROT_READ, MAP_SHARED, __fd, 0 );
+    const int __error = errno;
+    ::close( __fd );
+    if( __p == MAP_FAILED )
+        throw_io( __error, "can't map the file" );
+    __m_owned = __p;
+    __m_owned_size = size_t(__st.st_size);
+#else
+    std::FILE *__f = std::fopen( _path, "rb" );
+    if( !__f )
+        throw_io( errno, "can't open the file" );
+    long __size = -1;
+    if( std::fseek(__f, 0, SEEK_END) == 0 )
+        __size = std::ftell( __f );
+    if( __size < long(sizeof(__eytzinger::__file_header)) || std::fseek(__f, 0, SEEK_SET) != 0 ) {
+        std::fclose( __f );
+        throw_format( "not a saved map" );
+    }
+    try {
+        __m_owned = ::operator new( size_t(__size) );
+    }
+    catch( ... ) {
+        std::fclose( __f );
+        std::rethrow_exception( std::current_exception() );
+    }
+    __m_owned_size = size_t(__size);
+    const bool __ok = std::fread( __m_owned, 1, __m_owned_size, __f ) == __m_owned_size;
+    const int __error = errno;
+    std::fclose( __f );
+    if( !__ok ) {
+        release();
+        throw_io( __error, "can't read the file" );
+    }
+#endif
+    try {
+        attach( __m_owned, __m_owned_size );
+    }
+    catch( ... ) {
+        release();
+        std::rethrow_exception( std::current_exception() );
+    }
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_map_view<_Key, _Value, _Compare>::
+fixed_eytzinger_map_view( const void *_data, size_t _size, const _Compare& _comp ) :
+    view_type( nullptr, nullptr, 0, _comp ),
+    __m_data( nullptr ),
+    __m_owned( nullptr ),
+    __m_owned_size( 0 )
+{
+    attach( _data, _size );
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_map_view<_Key, _Value, _Compare>::
+fixed_eytzinger_map_view( fixed_eytzinger_map_view&& _other ) noexcept :
+    view_type( _other ),
+    __m_data( _other.__m_data ),
+    __m_owned( _other.__m_owned ),
+    __m_owned_size( _other.__m_owned_size )
+{
+    static_cast<view_type&>(_other) = view_type( nullptr, nullptr, 0, _other.key_comp() );
+    _other.__m_data = nullptr;
+    _other.__m_owned = nullptr;
+    _other.__m_owned_size = 0;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_map_view<_Key, _Value, _Compare>::~fixed_eytzinger_map_view()
+{
+    release();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_map_view<_Key, _Value, _Compare>&
+fixed_eytzinger_map_view<_Key, _Value, _Compare>::
+operator=( fixed_eytzinger_map_view&& _other ) noexcept
+{
+    fixed_eytzinger_map_view __tmp( std::move(_other) );
+    swap( __tmp );
+    return *this;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+void fixed_eytzinger_map_view<_Key, _Value, _Compare>::
+swap( fixed_eytzinger_map_view& _other ) noexcept
+{
+    view_type::swap( _other );
+    std::swap(__m_data, _other.__m_data);
+    std::swap(__m_owned, _other.__m_owned);
+    std::swap(__m_owned_size, _other.__m_owned_size);
+}
+
+// Validates the header against the types of this view and points to the keys and values. The
+// layout is recomputed from the count, so a damaged header can't make lookups leave the data.
+template <typename _Key, typename _Value, typename _Compare>
+void fixed_eytzinger_map_view<_Key, _Value, _Compare>::attach( const void *_data, size_t _size )
+{
+    __eytzinger::__file_header __h;
+    if( _size < sizeof(__h) )
+        throw_format( "not a saved map" );
+    std::memcpy( &__h, _data, sizeof(__h) );
+    if( std::memcmp(__h.__magic, __eytzinger::__file_magic, sizeof(__h.__magic)) != 0 )
+        throw_format( "not a saved map" );
+    if( __h.__byte_order != __eytzinger::__file_byte_order )
+        throw_format( "the map was saved with another byte order" );
+    if( __h.__version != __eytzinger::__file_version )
+        throw_format( "unsupported version of the format" );
+    if( __h.__key_size != sizeof(_Key) || __h.__key_align != alignof(_Key) ||
+        __h.__value_size != sizeof(_Value) || __h.__value_align != alignof(_Value) )
+        throw_format( "the map was saved with other key or value types" );
+    if( __h.__comparator != fixed_eytzinger_comparator_tag<_Compare>::value )
+        throw_format( "the map was saved with another comparator" );
+    if( __h.__count > _size / (sizeof(_Key) + sizeof(_Value)) )
+        throw_format( "the file is truncated" );
+    
+    const __eytzinger::__file_header __e =
+        __eytzinger::__make_file_header<_Key, _Value, _Compare>( size_t(__h.__count) );
+    if( __h.__keys_offset != __e.__keys_offset || __h.__values_offset != __e.__values_offset ||
+        __h.__file_size != __e.__file_size )
+        throw_format( "the header is damaged" );
+    if( __h.__file_size > _size )
+        throw_format( "the file is truncated" );
+    
+    const char *__base = static_cast<const char*>(_data);
+    if( reinterpret_cast<std::uintptr_t>(__base + __h.__keys_offset) % alignof(_Key) != 0 ||
+        reinterpret_cast<std::uintptr_t>(__base + __h.__values_offset) % alignof(_Value) != 0 )
+        throw std::invalid_argument("fixed_eytzinger_map_view: the data is misaligned");
+    
+    static_cast<view_type&>(*this) =
+        view_type( reinterpret_cast<const _Key*>(__base + __h.__keys_offset),
+                   reinterpret_cast<const _Value*>(__base + __h.__values_offset),
+                   size_t(__h.__count),
+                   this->key_comp() );
+    __m_data = _data;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+void fixed_eytzinger_map_view<_Key, _Value, _Compare>::release() noexcept
+{
+    if( __m_owned ) {
+#if defined(__unix__) || defined(__APPLE__)
+        ::munmap( __m_owned, __m_owned_size );
+#else
+        ::operator delete( __m_owned );
+#endif
+    }
+    static_cast<view_type&>(*this) = view_type( nullptr, nullptr, 0, this->key_comp() );
+    __m_data = nullptr;
+    __m_owned = nullptr;
+    __m_owned_size = 0;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+bool fixed_eytzinger_map_view<_Key, _Value, _Compare>::verify() const noexcept
+{
+    if( !__m_data )
+        return true;
+    __eytzinger::__file_header __h;
+    std::memcpy( &__h, __m_data, sizeof(__h) );
+    const char *__base = static_cast<const char*>(__m_data);
+    const size_t __count = size_t(__h.__count);
+    return __h.__checksum ==
+        __eytzinger::__checksum( __base + __h.__values_offset, __count * sizeof(_Value),
+            __eytzinger::__checksum(__base + __h.__keys_offset, __count * sizeof(_Key)) );
+}
+
+// Writes the keys and values of the map to a file which fixed_eytzinger_map_view can map and search
+// in place. Keys and values must be trivially copyable. The file is written under a unique
+// temporary name and then renamed over path, so processes which have the old file mapped are not
+// disturbed. Throws std::system_error if the file can't be written.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+void save( const fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator> &_map, const char *_path )
+{
+    static_assert( std::is_trivially_copyable<_Key>::value &&
+                   std::is_trivially_copyable<_Value>::value,
+                   "only maps with trivially copyable keys and values can be saved" );
+    static_assert( fixed_eytzinger_comparator_tag<_Compare>::value != 0,
+                   "fixed_eytzinger_comparator_tag has to be specialized for the comparator" );
+    typedef __eytzinger::__access access;
+    const size_t __count = access::count(_map);
+    const _Key *__keys = access::keys(_map);
+    const _Value *__values = access::values(_map);
+    __eytzinger::__file_header __h =
+        __eytzinger::__make_file_header<_Key, _Value, _Compare>( __count );
+    const size_t __keys_size = __count * sizeof(_Key);
+    const size_t __values_size = __count * sizeof(_Value);
+    __h.__checksum = __eytzinger::__checksum( __values, __values_size,
+                                              __eytzinger::__checksum(__keys, __keys_size) );
+    
+    static const char __zeros[64] = {};
+    std::string __tmp;
+    std::FILE *__f = __eytzinger::__create_temporary( _path, __tmp );
+    if( !__f )
+        __eytzinger::__throw_save( errno, "can't create the file" );
+    const auto __write = [__f](const void *_p, size_t _n) {
+        return _n == 0 || std::fwrite(_p, 1, _n, __f) == _n;
+    };
+    const auto __pad = [&__write](size_t _n) {
+        for( ; _n > sizeof(__zeros); _n -= sizeof(__zeros) )
+            if( !__write(__zeros, sizeof(__zeros)) )
+                return false;
+        return __write( __zeros, _n );
+    };
+    bool __ok = __write( &__h, sizeof(__h) ) &&
+                __pad( size_t(__h.__keys_offset) - sizeof(__h) ) &&
+                __write( __keys, __keys_size ) &&
+                __pad( size_t(__h.__values_offset - __h.__keys_offset) - __keys_size ) &&
+                __write( __values, __values_size );
+    int __error = errno;
+    if( std::fclose(__f) != 0 && __ok ) {
+        __ok = false;
+        __error = errno;
+    }
+    if( !__ok ) {
+        std::remove( __tmp.c_str() );
+        __eytzinger::__throw_save( __error, "can't write the file" );
+    }
+    
+    if( !__eytzinger::__replace_file(__tmp.c_str(), _path) ) {
+        __error = errno;
+        std::remove( __tmp.c_str() );
+        __eytzinger::__throw_save( __error, "can't rename the file" );
+    }
+}
+
+namespace std
+{
+template <typename _Key, typename _Value, typename _Compare>
+inline void swap(fixed_eytzinger_map_view<_Key, _Value, _Compare>& __x,
+                 fixed_eytzinger_map_view<_Key, _Value, _Compare>& __y )
+{
+    __y.swap( __x );
+}
+}
@@ -0,0 +1,625 @@
+/* Copyright (c) 2017 Michael Kazakov <mike.kazakov@gmail.com>
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#pragma once
+
+#include "fixed_eytzinger_map.h"
+
+// fixed_eytzinger_multimap keeps every entry of the input, including ones with equal keys. Distinct
+// keys are laid out in an Eytzinger tree, exactly as in fixed_eytzinger_map, and the values of each
+// key are stored contiguously, in the order in which they came in the input. Groups of values go
+// in the same order as the nodes of their keys, so a node only stores where its group ends: the
+// group of node j starts where the group of node j-1 ends. Looking a key up takes one descent over
+// the distinct keys, and its values are then a contiguous run.
+
+namespace __eytzinger
+{
+
+// Iterates over the entries of a multimap in the order of nodes, and over the values of a node in
+// the input order. _Value is const for a constant iterator.
+template <class _Key, class _Value>
+struct __multi_iterator
+{
+    typedef std::bidirectional_iterator_tag         iterator_category;
+    typedef ptrdiff_t                               difference_type;
+    typedef std::pair<_Key, typename std::remove_const<_Value>::type> value_type;
+    typedef __pair_ptr_wrap<_Key, _Value>           pointer;
+    typedef std::pair<const _Key&, _Value&>         reference;
+
+    __multi_iterator() noexcept : k(nullptr), e(nullptr), v(nullptr), j(0), p(0)
+    { }
+    __multi_iterator(const _Key *_k, const size_t *_e, _Value *_v, size_t _j, size_t _p) noexcept :
+        k(_k), e(_e), v(_v), j(_j), p(_p)
+    { }
+    template <class _V2, class = typename std::enable_if<
+        !std::is_same<_V2, _Value>::value && std::is_same<const _V2, _Value>::value>::type>
+    __multi_iterator(const __multi_iterator<_Key, _V2> &_i) noexcept :
+        k(_i.k), e(_i.e), v(_i.v), j(_i.j), p(_i.p)
+    { }
+    reference operator *() const noexcept
+    {
+        return reference{ k[j], v[p] };
+    }
+    pointer operator->() const noexcept
+    {
+        return pointer{ k + j, v + p };
+    }
+    __multi_iterator &operator++() noexcept
+    {
+        if( ++p == e[j] )
+            ++j;
+        return *this;
+    }
+    __multi_iterator operator++(int) noexcept
+    {
+        __multi_iterator __tmp = *this; ++(*this); return __tmp;
+    }
+    __multi_iterator &operator--() noexcept
+    {
+        if( p == (j ? e[j - 1] : 0) )
+            --j;
+        --p;
+        return *this;
+    }
+    __multi_iterator operator--(int) noexcept
+    {
+        __multi_iterator __tmp = *this; --(*this); return __tmp;
+    }
+    bool operator ==(const __multi_iterator &_rhs) const noexcept
+    {
+        return p == _rhs.p;
+    }
+    bool operator !=(const __multi_iterator &_rhs) const noexcept
+    {
+        return p != _rhs.p;
+    }
+private:
+    const _Key *k;
+    const size_t *e;
+    _Value *v;
+    size_t j;
+    size_t p;
+    template <class, class> friend struct __multi_iterator;
+};
+
+}
+
+template <typename _Key, typename _Value, class _Compare = std::less<_Key>,
+          class _Allocator = std::allocator< std::pair<_Key, _Value> > >
+class fixed_eytzinger_multimap
+{
+public:
+    typedef size_t                                  size_type;
+    typedef std::pair<_Key,_Value>                  value_type;
+    typedef _Key                                    key_type;
+    typedef _Value                                  mapped_type;
+    typedef _Compare                                key_compare;
+    typedef _Allocator                              allocator_type;
+    typedef __eytzinger::__multi_iterator<_Key, _Value>         iterator;
+    typedef __eytzinger::__multi_iterator<_Key, const _Value>   const_iterator;
+    typedef std::pair<iterator,iterator>            range_pair;
+    typedef std::pair<const_iterator,const_iterator>const_range_pair;
+
+    // Construction
+    // Entries with equal keys keep the order they have in the input.
+    fixed_eytzinger_multimap();
+    explicit fixed_eytzinger_multimap( const _Compare& comp,
+                                       const _Allocator& alloc = _Allocator() );
+    explicit fixed_eytzinger_multimap( const _Allocator& alloc );
+    fixed_eytzinger_multimap( const fixed_eytzinger_multimap& _other ) = default;
+    fixed_eytzinger_multimap( const fixed_eytzinger_multimap& _other, const _Allocator& alloc );
+    fixed_eytzinger_multimap( fixed_eytzinger_multimap&& other ) = default;
+    fixed_eytzinger_multimap( fixed_eytzinger_multimap&& other, const _Allocator& alloc );
+    fixed_eytzinger_multimap(std::initializer_list<value_type> l,
+                             const _Compare& comp = _Compare(),
+                             const _Allocator& alloc = _Allocator() );
+    fixed_eytzinger_multimap(std::initializer_list<value_type> l,
+                             const _Allocator& alloc );
+    template<typename _InputIterator>
+    fixed_eytzinger_multimap(_InputIterator begin,
+                             _InputIterator end,
+                             const _Compare& comp = _Compare(),
+                             const _Allocator& alloc = _Allocator() );
+    template<typename _InputIterator>
+    fixed_eytzinger_multimap(_InputIterator begin,
+                             _InputIterator end,
+                             const _Allocator& alloc );
+    template<typename _VectorAllocator>
+    fixed_eytzinger_multimap(std::vector<value_type, _VectorAllocator>&& v,
+                             const _Compare& comp = _Compare(),
+                             const _Allocator& alloc = _Allocator() );
+
+
+    // Allocator
+    allocator_type get_allocator() const noexcept;
+
+
+    // Iterators
+    iterator       begin()     noexcept;
+    iterator       end()       noexcept;
+    const_iterator begin()     const noexcept;
+    const_iterator end()       const noexcept;
+    const_iterator cbegin()    const noexcept;
+    const_iterator cend()      const noexcept;
+
+
+    // Modifiers
+    void clear() noexcept;
+    void swap( fixed_eytzinger_multimap& other ) noexcept;
+
+
+    // Capacity
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    size_type max_size() const noexcept;
+
+
+    // Lookup
+    size_type count( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    size_type count( const _K2& key ) const noexcept;
+
+    iterator find( const key_type& key ) noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    iterator find(const _K2& key) noexcept;
+
+    const_iterator find( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_iterator find(const _K2& key) const noexcept;
+
+    range_pair equal_range( const key_type& key ) noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    range_pair equal_range(const _K2& key) noexcept;
+
+    const_range_pair equal_range( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_range_pair equal_range(const _K2& key) const noexcept;
+
+
+    // Assignment
+    fixed_eytzinger_multimap& operator=( const fixed_eytzinger_multimap& other ) = default;
+    fixed_eytzinger_multimap& operator=( fixed_eytzinger_multimap&& other ) = default;
+    fixed_eytzinger_multimap& operator=( std::initializer_list<value_type> l );
+    template<typename _InputIterator>
+    void assign( _InputIterator begin, _InputIterator end );
+    void assign( std::initializer_list<value_type> l );
+    template<typename _VectorAllocator>
+    void assign( std::vector<value_type, _VectorAllocator>&& v );
+
+private:
+    typedef std::allocator_traits<_Allocator> alloc_traits;
+    typedef __eytzinger::__access access;
+    typedef fixed_eytzinger_map<_Key, size_type, _Compare,
+        typename alloc_traits::template rebind_alloc< std::pair<_Key, size_type> > > index_type;
+    typedef std::vector<_Value, typename alloc_traits::template rebind_alloc<_Value> >
+        values_type;
+    
+    static const unsigned prefetch_distance = fixed_eytzinger_prefetch_distance<_Key>::value;
+
+    template <typename _Vector>
+    void init( _Vector &_t );
+    template <typename _K2>
+    size_type node( const _K2& _key ) const noexcept;
+    size_type group_begin( size_type _j ) const noexcept
+    { return _j ? access::values(__m_index)[_j - 1] : 0; }
+    template <typename _Iterator, typename _Values>
+    _Iterator make_iterator( _Values *_values, size_type _j, size_type _p ) const noexcept
+    { return _Iterator{ access::keys(__m_index), access::values(__m_index), _values, _j, _p }; }
+    template <typename _Range, typename _Values>
+    _Range make_range( _Values *_values, size_type _j ) const noexcept;
+
+    index_type  __m_index;  // distinct keys and the ends of their groups of values
+    values_type __m_values;
+};
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::fixed_eytzinger_multimap( ) :
+    fixed_eytzinger_multimap( _Compare() )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_multimap( const _Compare& _comp, const _Allocator& _alloc ) :
+    __m_index( _comp, _alloc ),
+    __m_values( _alloc )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_multimap( const _Allocator& _alloc ) :
+    fixed_eytzinger_multimap( _Compare(), _alloc )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_multimap( const fixed_eytzinger_multimap& _other, const _Allocator& _alloc ) :
+    __m_index( _other.__m_index, _alloc ),
+    __m_values( _other.__m_values, _alloc )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_multimap( fixed_eytzinger_multimap&& _other, const _Allocator& _alloc ) :
+    __m_index( std::move(_other.__m_index), _alloc ),
+    __m_values( std::move(_other.__m_values), _alloc )
+{
+    _other.clear();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_multimap(std::initializer_list<value_type> _l,
+                         const _Compare& _comp,
+                         const _Allocator& _alloc):
+    fixed_eytzinger_multimap( _comp, _alloc )
+{
+    std::vector<value_type, typename alloc_traits::template rebind_alloc<value_type> >
+        t( std::begin(_l), std::end(_l), _alloc );
+    init( t );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_multimap(std::initializer_list<value_type> _l,
+                         const _Allocator& _alloc):
+    fixed_eytzinger_multimap( _l, _Compare(), _alloc )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _InputIterator>
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_multimap(_InputIterator _begin,
+                         _InputIterator _end,
+                         const _Compare& _comp,
+                         const _Allocator& _alloc ):
+    fixed_eytzinger_multimap( _comp, _alloc )
+{
+    static_assert( std::is_constructible<value_type,
+                        typename std::iterator_traits<_InputIterator>::reference>::
+                        value,
+                    "incompatible iterator type");
+    std::vector<value_type, typename alloc_traits::template rebind_alloc<value_type> >
+        t( _begin, _end, _alloc );
+    init( t );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _InputIterator>
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_multimap(_InputIterator _begin,
+                         _InputIterator _end,
+                         const _Allocator& _alloc ):
+    fixed_eytzinger_multimap( _begin, _end, _Compare(), _alloc )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _VectorAllocator>
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_multimap(std::vector<value_type, _VectorAllocator>&& _v,
+                         const _Compare& _comp,
+                         const _Allocator& _alloc ):
+    fixed_eytzinger_multimap( _comp, _alloc )
+{
+    std::vector<value_type, _VectorAllocator> t( std::move(_v) ); // freed once the map is built
+    _v.clear();
+    init( t );
+}
+
+// Sorts the input stably and builds the index over distinct keys, with the number of every key's
+// group in the sorted input as a value. Then the groups are moved into place in the order of
+// nodes, and the group numbers are replaced with where the groups end.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _Vector>
+void fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::init( _Vector &_t )
+{
+    const _Compare &__comp = access::comparator(__m_index);
+    std::stable_sort(std::begin(_t), std::end(_t), [&](const value_type &_v1,
+                                                       const value_type &_v2) {
+        return __comp(_v1.first, _v2.first);
+    });
+
+    typedef std::pair<_Key, size_type> __group;
+    std::vector<__group, typename alloc_traits::template rebind_alloc<__group> >
+        __groups( get_allocator() );
+    std::vector<size_type, typename alloc_traits::template rebind_alloc<size_type> >
+        __starts( get_allocator() );
+    for( size_type __i = 0; __i < _t.size(); ++__i )
+        if( __groups.empty() || __comp(__groups.back().first, _t[__i].first) ) {
+            __starts.push_back( __i );
+            __groups.emplace_back( std::move(_t[__i].first), __groups.size() );
+        }
+    __starts.push_back( _t.size() );
+
+    index_type __index( fixed_eytzinger_sorted_unique,
+                        std::make_move_iterator(__groups.begin()),
+                        std::make_move_iterator(__groups.end()),
+                        __comp,
+                        __m_index.get_allocator() );
+    values_type __values( get_allocator() );
+    __values.reserve( _t.size() );
+    for( size_type __j = 0; __j < access::count(__index); ++__j ) {
+        size_type &__g = access::values(__index)[__j];
+        for( size_type __i = __starts[__g]; __i < __starts[__g + 1]; ++__i )
+            __values.emplace_back( std::move(_t[__i].second) );
+        __g = __values.size();
+    }
+    __m_index.swap( __index );
+    __m_values.swap( __values );
+}
+
+// Node of the key, or the number of nodes if there's no such key.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _K2>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+node( const _K2& _key ) const noexcept
+{
+    const size_type __n = access::count(__m_index);
+    const size_type __j = __eytzinger::__lower_bound<prefetch_distance>(
+        access::keys(__m_index), __n, _key, access::comparator(__m_index) );
+    return __j != __n && !access::comparator(__m_index)(_key, access::keys(__m_index)[__j]) ?
+        __j : __n;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _Range, typename _Values>
+_Range fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+make_range( _Values *_values, size_type _j ) const noexcept
+{
+    typedef typename _Range::first_type __iterator;
+    if( _j == access::count(__m_index) )
+        return _Range{ make_iterator<__iterator>( _values, _j, __m_values.size() ),
+                       make_iterator<__iterator>( _values, _j, __m_values.size() ) };
+    return _Range{ make_iterator<__iterator>( _values, _j, group_begin(_j) ),
+                   make_iterator<__iterator>( _values, _j + 1, access::values(__m_index)[_j] ) };
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+_Allocator
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::get_allocator() const noexcept
+{
+    return _Allocator( __m_values.get_allocator() );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::iterator
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::begin() noexcept
+{
+    return make_iterator<iterator>( __m_values.data(), 0, 0 );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::iterator
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::end() noexcept
+{
+    return make_iterator<iterator>( __m_values.data(), access::count(__m_index),
+                                    __m_values.size() );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::begin() const noexcept
+{
+    return make_iterator<const_iterator>( __m_values.data(), 0, 0 );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::end() const noexcept
+{
+    return make_iterator<const_iterator>( __m_values.data(), access::count(__m_index),
+                                          __m_values.size() );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::cbegin() const noexcept
+{
+    return begin();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::cend() const noexcept
+{
+    return end();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+void fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::clear() noexcept
+{
+    __m_index.clear();
+    values_type( __m_values.get_allocator() ).swap( __m_values );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+void fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+swap( fixed_eytzinger_multimap& _other ) noexcept
+{
+    __m_index.swap( _other.__m_index );
+    __m_values.swap( _other.__m_values );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+bool fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::empty() const noexcept
+{
+    return __m_values.empty();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::size() const noexcept
+{
+    return __m_values.size();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::max_size() const noexcept
+{
+    return __m_values.max_size();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+count( const key_type& _key ) const noexcept
+{
+    const size_type __j = node( _key );
+    return __j == access::count(__m_index) ? 0 : access::values(__m_index)[__j] - group_begin(__j);
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+count( const _K2& _key ) const noexcept
+{
+    const size_type __j = node( _key );
+    return __j == access::count(__m_index) ? 0 : access::values(__m_index)[__j] - group_begin(__j);
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::iterator
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+find( const key_type& _key ) noexcept
+{
+    return make_range<range_pair>( __m_values.data(), node(_key) ).first;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::iterator
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+find( const _K2& _key ) noexcept
+{
+    return make_range<range_pair>( __m_values.data(), node(_key) ).first;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+find( const key_type& _key ) const noexcept
+{
+    return make_range<const_range_pair>( __m_values.data(), node(_key) ).first;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+find( const _K2& _key ) const noexcept
+{
+    return make_range<const_range_pair>( __m_values.data(), node(_key) ).first;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::range_pair
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+equal_range( const key_type& _key ) noexcept
+{
+    return make_range<range_pair>( __m_values.data(), node(_key) );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::range_pair
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+equal_range( const _K2& _key ) noexcept
+{
+    return make_range<range_pair>( __m_values.data(), node(_key) );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::const_range_pair
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+equal_range( const key_type& _key ) const noexcept
+{
+    return make_range<const_range_pair>( __m_values.data(), node(_key) );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::const_range_pair
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+equal_range( const _K2& _key ) const noexcept
+{
+    return make_range<const_range_pair>( __m_values.data(), node(_key) );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>&
+fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+operator=( std::initializer_list<value_type> _l )
+{
+    assign( _l );
+    return *this;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _InputIterator>
+void fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+assign(_InputIterator _begin, _InputIterator _end)
+{
+    fixed_eytzinger_multimap __tmp {_begin, _end, access::comparator(__m_index), get_allocator()};
+    swap(__tmp);
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+void fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+assign( std::initializer_list<value_type> _l )
+{
+    fixed_eytzinger_multimap __tmp {_l, access::comparator(__m_index), get_allocator()};
+    swap(__tmp);
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+template<typename _VectorAllocator>
+void fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>::
+assign( std::vector<value_type, _VectorAllocator>&& _v )
+{
+    fixed_eytzinger_multimap __tmp {std::move(_v), access::comparator(__m_index), get_allocator()};
+    swap(__tmp);
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+inline bool
+operator==(const fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>& __x,
+           const fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>& __y)
+{
+    return __x.size() == __y.size() && std::equal(__x.begin(), __x.end(), __y.begin());
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+inline bool
+operator!=(const fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>& __x,
+           const fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>& __y)
+{
+    return !(__x == __y);
+}
+
+namespace std
+{
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+inline void swap(fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>& __x,
+                 fixed_eytzinger_multimap<_Key, _Value, _Compare, _Allocator>& __y )
+{
+    __y.swap( __x );
+}
+}
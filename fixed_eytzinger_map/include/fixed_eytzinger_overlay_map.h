@@ -0,0 +1,393 @@
+/* Copyright (c) 2017 Michael Kazakov <mike.kazakov@gmail.com>
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#pragma once
+
+#include "fixed_eytzinger_map.h"
+#include <chrono>
+#include <future>
+#include <map>
+#include <set>
+
+// fixed_eytzinger_overlay_map is a mutable map made of an immutable fixed_eytzinger_map and a
+// small delta of changes made since it was built: a sorted map of inserted or assigned entries and
+// a set of erased keys. Lookups consult the delta first and the base after it. Once the delta
+// grows past a threshold it's merged with the base into a new base, in time linear in their sizes.
+// The merge can run on a background thread, while new changes go into a fresh delta; such a merge
+// is installed by the first modification after it completes, or by merge(). The merging thread
+// allocates the new base while this one allocates the delta, so only overlays with stateless
+// allocators, which share no memory resource, merge in background; others merge right away.
+// The overlay map is not thread-safe, like standard containers. It has no iterators, merge() and
+// then base() give a plain map to iterate.
+
+template <typename _Key, typename _Value, class _Compare = std::less<_Key>,
+          class _Allocator = std::allocator< std::pair<_Key, _Value> > >
+class fixed_eytzinger_overlay_map
+{
+public:
+    typedef size_t                                                  size_type;
+    typedef std::pair<_Key,_Value>                                  value_type;
+    typedef _Key                                                    key_type;
+    typedef _Value                                                  mapped_type;
+    typedef _Compare                                                key_compare;
+    typedef _Allocator                                              allocator_type;
+    typedef fixed_eytzinger_map<_Key, _Value, _Compare, _Allocator> base_type;
+    
+    static const size_type default_merge_threshold = 4096;
+    
+    // Construction
+    // background_merge is ignored unless the allocator is stateless.
+    explicit fixed_eytzinger_overlay_map( base_type base = base_type(),
+                                          size_type merge_threshold = default_merge_threshold,
+                                          bool background_merge = false );
+    // Leaves other empty, with an empty base which has the comparator and allocator of its base.
+    fixed_eytzinger_overlay_map( fixed_eytzinger_overlay_map&& other );
+    fixed_eytzinger_overlay_map( const fixed_eytzinger_overlay_map& ) = delete;
+    
+    
+    // Destruction
+    // Waits for a background merge, if there is one.
+    ~fixed_eytzinger_overlay_map() = default;
+    
+    
+    // Assignment
+    fixed_eytzinger_overlay_map& operator=( fixed_eytzinger_overlay_map&& other );
+    fixed_eytzinger_overlay_map& operator=( const fixed_eytzinger_overlay_map& ) = delete;
+    
+    
+    // Element access
+    // Throws std::out_of_range if there's no such key.
+    const mapped_type& at( const key_type& key ) const;
+    
+    
+    // Capacity
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    
+    
+    // Modifiers
+    // Each of these may complete a merge, which can throw whatever the construction of the map
+    // throws, the change itself is made anyway.
+    bool insert( const value_type& value );
+    bool insert_or_assign( const key_type& key, const mapped_type& value );
+    size_type erase( const key_type& key );
+    
+    
+    // Lookup
+    size_type count( const key_type& key ) const;
+    // Returns the value of the key or nullptr if there's no such key.
+    const mapped_type* find( const key_type& key ) const;
+    
+    
+    // Merging
+    // Merges all changes into the base, waiting for a background merge to complete first.
+    void merge();
+    // The map without the changes which are not merged yet.
+    const base_type& base() const noexcept;
+    // The number of changes which are not merged into the base yet.
+    size_type delta_size() const noexcept;
+    size_type merge_threshold() const noexcept;
+    bool background_merge() const noexcept;
+    
+private:
+    typedef std::allocator_traits<_Allocator> alloc_traits;
+    typedef std::map<_Key, _Value, _Compare,
+        typename alloc_traits::template rebind_alloc< std::pair<const _Key, _Value> > >
+        inserted_type;
+    typedef std::set<_Key, _Compare, typename alloc_traits::template rebind_alloc<_Key> >
+        erased_type;
+    struct delta
+    {
+        delta( const _Compare &_comp, const _Allocator &_alloc ) :
+            __inserted(_comp, typename inserted_type::allocator_type(_alloc)),
+            __erased(_comp, typename erased_type::allocator_type(_alloc)) {}
+        // tells whether the delta knows the key, and if it does, sets _value to it or to nullptr
+        bool lookup( const _Key &_key, const _Value *&_value ) const;
+        size_type size() const noexcept { return __inserted.size() + __erased.size(); }
+        inserted_type   __inserted;
+        erased_type     __erased;
+    };
+    
+    static base_type merged( const base_type &_base, const delta &_delta );
+    const mapped_type* lookup( const key_type &_key ) const;
+    bool below_delta( const key_type &_key ) const;
+    void changed();
+    void start_background_merge();
+    void install_background_merge();
+    
+    std::shared_ptr<const base_type>    __m_base;
+    std::shared_ptr<const delta>        __m_frozen;     // the delta being merged in background
+    std::future<base_type>              __m_merging;
+    delta                               __m_delta;
+    size_type                           __m_size;
+    size_type                           __m_threshold;
+    bool                                __m_background;
+};
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_overlay_map( base_type _base, size_type _merge_threshold, bool _background_merge ):
+    __m_base( std::make_shared<const base_type>(std::move(_base)) ),
+    __m_delta( __m_base->key_comp(), __m_base->get_allocator() ),
+    __m_size( __m_base->size() ),
+    __m_threshold( _merge_threshold ),
+    __m_background( _background_merge && std::is_empty<_Allocator>::value )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::
+fixed_eytzinger_overlay_map( fixed_eytzinger_overlay_map&& _other ):
+    __m_base( std::make_shared<const base_type>(_other.__m_base->key_comp(),
+                                                _other.__m_base->get_allocator()) ),
+    __m_delta( _other.__m_base->key_comp(), _other.__m_base->get_allocator() ),
+    __m_size( 0 ),
+    __m_threshold( _other.__m_threshold ),
+    __m_background( _other.__m_background )
+{
+    std::swap( __m_base, _other.__m_base );
+    std::swap( __m_frozen, _other.__m_frozen );
+    std::swap( __m_merging, _other.__m_merging );
+    std::swap( __m_delta, _other.__m_delta );
+    std::swap( __m_size, _other.__m_size );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>&
+fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::
+operator=( fixed_eytzinger_overlay_map&& _other )
+{
+    fixed_eytzinger_overlay_map __tmp( std::move(_other) );
+    __m_merging = std::move( __tmp.__m_merging );
+    __m_base = std::move( __tmp.__m_base );
+    __m_frozen = std::move( __tmp.__m_frozen );
+    __m_delta = std::move( __tmp.__m_delta );
+    __m_size = __tmp.__m_size;
+    __m_threshold = __tmp.__m_threshold;
+    __m_background = __tmp.__m_background;
+    return *this;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+bool fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::delta::
+lookup( const _Key &_key, const _Value *&_value ) const
+{
+    if( !__inserted.empty() ) {
+        const auto __i = __inserted.find( _key );
+        if( __i != __inserted.end() ) {
+            _value = &__i->second;
+            return true;
+        }
+    }
+    if( !__erased.empty() && __erased.count(_key) ) {
+        _value = nullptr;
+        return true;
+    }
+    return false;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+const _Value* fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::
+lookup( const key_type &_key ) const
+{
+    const _Value *__value = nullptr;
+    if( __m_delta.lookup(_key, __value) || (__m_frozen && __m_frozen->lookup(_key, __value)) )
+        return __value;
+    const auto __i = __m_base->find( _key );
+    return __i == __m_base->end() ? nullptr : &__i->second;
+}
+
+// Tells whether the key is present below the active delta, which is when erasing it needs a mark.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+bool fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::
+below_delta( const key_type &_key ) const
+{
+    const _Value *__value = nullptr;
+    if( __m_frozen && __m_frozen->lookup(_key, __value) )
+        return __value != nullptr;
+    return __m_base->count( _key ) != 0;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+const _Value& fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::
+at( const key_type &_key ) const
+{
+    if( const _Value *__value = lookup(_key) )
+        return *__value;
+    throw std::out_of_range("fixed_eytzinger_overlay_map::at:  key not found");
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+bool fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::empty() const noexcept
+{
+    return __m_size == 0;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::size() const noexcept
+{
+    return __m_size;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::
+count( const key_type &_key ) const
+{
+    return lookup(_key) != nullptr;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+const _Value* fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::
+find( const key_type &_key ) const
+{
+    return lookup(_key);
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+bool fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::
+insert( const value_type &_value )
+{
+    if( lookup(_value.first) )
+        return false;
+    __m_delta.__inserted.emplace( _value );
+    __m_delta.__erased.erase( _value.first );
+    ++__m_size;
+    changed();
+    return true;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+bool fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::
+insert_or_assign( const key_type &_key, const mapped_type &_value )
+{
+    const bool __inserted = lookup(_key) == nullptr;
+    const auto __i = __m_delta.__inserted.find( _key );
+    if( __i != __m_delta.__inserted.end() )
+        __i->second = _value;
+    else
+        __m_delta.__inserted.emplace( _key, _value );
+    __m_delta.__erased.erase( _key );
+    __m_size += __inserted;
+    changed();
+    return __inserted;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::erase( const key_type &_key )
+{
+    if( !lookup(_key) )
+        return 0;
+    if( below_delta(_key) )
+        __m_delta.__erased.insert( _key );
+    __m_delta.__inserted.erase( _key );
+    --__m_size;
+    changed();
+    return 1;
+}
+
+// Picks up a completed background merge and starts a new merge if the delta is big enough.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+void fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::changed()
+{
+    if( __m_merging.valid() &&
+        __m_merging.wait_for(std::chrono::seconds(0)) == std::future_status::ready )
+        install_background_merge();
+    if( __m_frozen && !__m_merging.valid() )
+        start_background_merge(); // the previous one has failed
+    else if( __m_delta.size() > __m_threshold ) {
+        if( !__m_background )
+            merge();
+        else if( !__m_frozen )
+            start_background_merge();
+    }
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+void fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::start_background_merge()
+{
+    if( !__m_frozen ) {
+        __m_frozen = std::make_shared<const delta>( std::move(__m_delta) );
+        __m_delta = delta( __m_base->key_comp(), __m_base->get_allocator() );
+    }
+    const std::shared_ptr<const base_type> __base = __m_base;
+    const std::shared_ptr<const delta> __frozen = __m_frozen;
+    __m_merging = std::async( std::launch::async, [__base, __frozen]{
+        return merged( *__base, *__frozen );
+    });
+}
+
+// If the merge has failed, the frozen delta is kept and consulted by lookups, and the next
+// modification starts the merge again.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+void fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::install_background_merge()
+{
+    __m_base = std::make_shared<const base_type>( __m_merging.get() );
+    __m_frozen.reset();
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+void fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::merge()
+{
+    if( __m_merging.valid() )
+        install_background_merge();
+    else if( __m_frozen ) {
+        __m_base = std::make_shared<const base_type>( merged(*__m_base, *__m_frozen) );
+        __m_frozen.reset();
+    }
+    if( __m_delta.size() != 0 ) {
+        __m_base = std::make_shared<const base_type>( merged(*__m_base, __m_delta) );
+        __m_delta = delta( __m_base->key_comp(), __m_base->get_allocator() );
+    }
+}
+
+// The delta is sorted, so the base is rebuilt with it in linear time.
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::base_type
+fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::
+merged( const base_type &_base, const delta &_delta )
+{
+    return base_type( _base, fixed_eytzinger_sorted_unique,
+                      _delta.__inserted.begin(), _delta.__inserted.end(),
+                      _delta.__erased.begin(), _delta.__erased.end() );
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+const typename fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::base_type&
+fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::base() const noexcept
+{
+    return *__m_base;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::delta_size() const noexcept
+{
+    return __m_delta.size() + (__m_frozen ? __m_frozen->size() : 0);
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::size_type
+fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::merge_threshold() const noexcept
+{
+    return __m_threshold;
+}
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+bool fixed_eytzinger_overlay_map<_Key, _Value, _Compare, _Allocator>::
+background_merge() const noexcept
+{
+    return __m_background;
+}
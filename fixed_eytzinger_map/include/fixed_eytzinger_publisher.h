@@ -0,0 +1,188 @@
+/* Copyright (c) 2017 Michael Kazakov <mike.kazakov@gmail.com>
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// fixed_eytzinger_publisher holds a container which is shared by concurrent readers and replaced
+// as a whole by writers, e.g. a fixed_eytzinger_map rebuilt every few minutes. A reader takes a
+// snapshot, which costs two atomic increments and never waits, and looks up in it for as long as
+// the snapshot lives. A writer publishes a new container, waits until no snapshot of the old one
+// is left and destroys the old one.
+//
+// Readers count themselves in one of two counters of a slot, picked by the parity of the current
+// epoch. Slots are spread over threads and kept on separate cache lines, so readers on different
+// cores don't contend. A writer swaps the container and then advances the epoch twice, each time
+// waiting for the counters of the previous parity to drain, after which no reader can still hold
+// the old container. A thread must release its snapshots before it publishes, otherwise it waits
+// for itself.
+
+template <class _Container>
+class fixed_eytzinger_publisher
+{
+public:
+    typedef _Container container_type;
+    
+    // A read-only handle to the container published at the moment the snapshot was taken.
+    // The container stays alive until the snapshot is destroyed.
+    class snapshot
+    {
+    public:
+        snapshot() noexcept : __m_container(nullptr), __m_readers(nullptr) {}
+        snapshot( snapshot&& _other ) noexcept :
+            __m_container(_other.__m_container), __m_readers(_other.__m_readers)
+        {
+            _other.__m_container = nullptr;
+            _other.__m_readers = nullptr;
+        }
+        snapshot( const snapshot& ) = delete;
+        ~snapshot() { release(); }
+        snapshot& operator=( snapshot&& _other ) noexcept
+        {
+            release();
+            std::swap(__m_container, _other.__m_container);
+            std::swap(__m_readers, _other.__m_readers);
+            return *this;
+        }
+        snapshot& operator=( const snapshot& ) = delete;
+        
+        const _Container& operator*()  const noexcept { return *__m_container; }
+        const _Container* operator->() const noexcept { return __m_container; }
+        const _Container* get()        const noexcept { return __m_container; }
+        explicit operator bool()       const noexcept { return __m_container != nullptr; }
+        
+        void release() noexcept
+        {
+            if( __m_readers )
+                __m_readers->fetch_sub(1);
+            __m_container = nullptr;
+            __m_readers = nullptr;
+        }
+        
+    private:
+        snapshot( const _Container *_c, std::atomic<size_t> *_r ) noexcept :
+            __m_container(_c), __m_readers(_r) {}
+        const _Container    *__m_container;
+        std::atomic<size_t> *__m_readers;
+        friend class fixed_eytzinger_publisher;
+    };
+    
+    
+    // Construction
+    fixed_eytzinger_publisher();
+    explicit fixed_eytzinger_publisher( _Container container );
+    fixed_eytzinger_publisher( const fixed_eytzinger_publisher& ) = delete;
+    
+    
+    // Destruction
+    // No snapshots must be left by then.
+    ~fixed_eytzinger_publisher();
+    
+    
+    // Reading
+    // Wait-free.
+    snapshot read() const noexcept;
+    
+    
+    // Publishing
+    // Installs the new container, then blocks until all snapshots of the previous one are
+    // released and destroys it. Concurrent publishers are serialized.
+    void publish( _Container container );
+    
+    fixed_eytzinger_publisher& operator=( const fixed_eytzinger_publisher& ) = delete;
+    
+private:
+    static const size_t slots_number = 64;
+    struct alignas(64) slot
+    {
+        std::atomic<size_t> __readers[2];
+    };
+    static size_t thread_slot() noexcept;
+    void synchronize() noexcept;
+    
+    std::atomic<const _Container*>  __m_current;
+    std::atomic<size_t>             __m_epoch;
+    std::mutex                      __m_publishing;
+    mutable slot                    __m_slots[slots_number];
+};
+
+template <class _Container>
+fixed_eytzinger_publisher<_Container>::fixed_eytzinger_publisher() :
+    fixed_eytzinger_publisher( _Container() )
+{
+}
+
+template <class _Container>
+fixed_eytzinger_publisher<_Container>::fixed_eytzinger_publisher( _Container _container ) :
+    __m_current( new _Container(std::move(_container)) ),
+    __m_epoch( 0 )
+{
+    for( slot &__s: __m_slots ) {
+        __s.__readers[0].store(0, std::memory_order_relaxed);
+        __s.__readers[1].store(0, std::memory_order_relaxed);
+    }
+}
+
+template <class _Container>
+fixed_eytzinger_publisher<_Container>::~fixed_eytzinger_publisher()
+{
+    delete __m_current.load();
+}
+
+// Threads get slots round-robin in the order they first read.
+template <class _Container>
+size_t fixed_eytzinger_publisher<_Container>::thread_slot() noexcept
+{
+    static std::atomic<size_t> __next{0};
+    static thread_local const size_t __slot =
+        __next.fetch_add(1, std::memory_order_relaxed) % slots_number;
+    return __slot;
+}
+
+template <class _Container>
+typename fixed_eytzinger_publisher<_Container>::snapshot
+fixed_eytzinger_publisher<_Container>::read() const noexcept
+{
+    std::atomic<size_t> &__readers =
+        __m_slots[thread_slot()].__readers[__m_epoch.load() & 1];
+    __readers.fetch_add(1);
+    return snapshot( __m_current.load(), &__readers );
+}
+
+template <class _Container>
+void fixed_eytzinger_publisher<_Container>::publish( _Container _container )
+{
+    std::unique_ptr<const _Container> __next( new _Container(std::move(_container)) );
+    std::lock_guard<std::mutex> __lock( __m_publishing );
+    std::unique_ptr<const _Container> __previous( __m_current.exchange(__next.release()) );
+    synchronize();
+}
+
+// A reader which counted itself under the previous parity might still hold the old container.
+// Such a reader could have picked the parity before the last flip, which is why two flips are
+// needed.
+template <class _Container>
+void fixed_eytzinger_publisher<_Container>::synchronize() noexcept
+{
+    for( int __flip = 0; __flip < 2; ++__flip ) {
+        const size_t __parity = __m_epoch.fetch_add(1) & 1;
+        for( slot &__s: __m_slots )
+            while( __s.__readers[__parity].load() != 0 )
+                std::this_thread::yield();
+    }
+}
@@ -0,0 +1,588 @@
+/* Copyright (c) 2017 Michael Kazakov <mike.kazakov@gmail.com>
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#pragma once
+
+#include "fixed_eytzinger_map.h"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// fixed_eytzinger_radix_map is an immutable map which splits its keys into buckets by the top
+// bits of an order-preserving projection of keys to 64-bit integers, taken over the range of
+// the keys in the map. Every bucket is a small Eytzinger tree of its own, and all of them lie
+// one after another in a single array of keys and a parallel array of values. A directory of
+// offsets into these arrays, about one entry per eight keys and at most 2^max_bits entries, is
+// indexed by the bucket of a key. A lookup is one access to the directory and a descent of a
+// few levels, instead of a descent from the root which pays the top levels on every call.
+// The directory takes two words per bucket, i.e. about two bytes per key. Keys and values are
+// kept in the storage of fixed_eytzinger_map, an empty map has no directory.
+// This suits integers and hashes, which spread over the buckets evenly. Heavily skewed keys
+// crowd into few buckets, where lookups become those of a plain map.
+// Elements are iterated in the order of the layout, not in the order of keys.
+
+// Maps keys to unsigned integers in a way which preserves their order, so that the top bits of
+// the result can pick a bucket: a key which is not greater than another must not be projected
+// to a greater value. Defined for integral and floating-point keys ordered by std::less. Other
+// keys need a projection of their own, e.g. strings can be projected to their first eight bytes
+// read as a big-endian integer.
+template <typename _Key, typename = void>
+struct fixed_eytzinger_radix_projection;
+
+template <typename _Key>
+struct fixed_eytzinger_radix_projection<_Key, typename std::enable_if<
+    std::is_integral<_Key>::value && !std::is_same<_Key, bool>::value>::type>
+{
+    std::uint64_t operator()( _Key _key ) const noexcept
+    {
+        // signed keys are offset so that negative ones go first
+        typedef typename std::make_unsigned<_Key>::type __unsigned;
+        const __unsigned __offset =
+            std::is_signed<_Key>::value ? __unsigned(std::numeric_limits<_Key>::min()) : 0;
+        return std::uint64_t( __unsigned(_key) ^ __offset );
+    }
+};
+
+template <typename _Key>
+struct fixed_eytzinger_radix_projection<_Key, typename std::enable_if<
+    std::is_floating_point<_Key>::value>::type>
+{
+    std::uint64_t operator()( _Key _key ) const noexcept
+    {
+        // IEEE 754 doubles order as integers once the bits of negative ones are flipped, and the
+        // sign bit of others is set. Adding zero turns -0 into +0, which is equal to it.
+        const double __d = double(_key) + 0.;
+        std::uint64_t __bits;
+        std::memcpy( &__bits, &__d, sizeof(__bits) );
+        return __bits >> 63 ? ~__bits : __bits | (std::uint64_t(1) << 63);
+    }
+};
+
+template <typename _Key, typename _Value,
+          class _Projection = fixed_eytzinger_radix_projection<_Key>,
+          class _Compare = std::less<_Key>,
+          class _Allocator = std::allocator< std::pair<_Key, _Value> > >
+class fixed_eytzinger_radix_map : private __eytzinger::__storage<_Key, _Value, _Compare, _Allocator>
+{
+public:
+    typedef size_t                                              size_type;
+    typedef std::pair<_Key,_Value>                              value_type;
+    typedef _Key                                                key_type;
+    typedef _Value                                              mapped_type;
+    typedef _Compare                                            key_compare;
+    typedef _Projection                                         projection_type;
+    typedef _Allocator                                          allocator_type;
+    typedef __eytzinger::__const_proxy_iterator<_Key, _Value>   iterator;
+    typedef __eytzinger::__const_proxy_iterator<_Key, _Value>   const_iterator;
+    typedef std::pair<const_iterator,const_iterator>            const_range_pair;
+    
+    static_assert( std::is_nothrow_move_constructible<key_type>::value,
+        "key_type must be nothrow move constructible" );
+    static_assert( std::is_nothrow_move_constructible<mapped_type>::value,
+        "mapped_type must be nothrow move constructible" );
+    static_assert( !std::is_same<_Projection, fixed_eytzinger_radix_projection<_Key>>::value ||
+                   __eytzinger::__is_std_less<_Key, _Compare>::value,
+        "the default projection requires keys ordered by std::less" );
+    
+    // The limit of bits which pick a bucket.
+    static const unsigned max_bits = 24;
+    
+    // Construction
+    // The input is copied and sorted, unless it's marked as sorted and unique, and then the
+    // buckets are laid out in linear time. The projection is default constructed.
+    fixed_eytzinger_radix_map();
+    explicit fixed_eytzinger_radix_map( const _Compare& comp,
+                                        const _Allocator& alloc = _Allocator() );
+    fixed_eytzinger_radix_map(std::initializer_list<value_type> l,
+                              const _Compare& comp = _Compare(),
+                              const _Allocator& alloc = _Allocator() );
+    template<typename _InputIterator>
+    fixed_eytzinger_radix_map(_InputIterator begin,
+                              _InputIterator end,
+                              const _Compare& comp = _Compare(),
+                              const _Allocator& alloc = _Allocator() );
+    
+    // Construction from input which is sorted and has unique keys.
+    // Throws std::invalid_argument if the input isn't sorted or has duplicates.
+    template<typename _InputIterator>
+    fixed_eytzinger_radix_map(fixed_eytzinger_sorted_unique_t,
+                              _InputIterator begin,
+                              _InputIterator end,
+                              const _Compare& comp = _Compare(),
+                              const _Allocator& alloc = _Allocator() );
+    
+    fixed_eytzinger_radix_map( const fixed_eytzinger_radix_map& other ) = default;
+    fixed_eytzinger_radix_map( const fixed_eytzinger_radix_map& other, const _Allocator& alloc );
+    fixed_eytzinger_radix_map( fixed_eytzinger_radix_map&& other ) noexcept = default;
+    
+    
+    // Assignment
+    fixed_eytzinger_radix_map& operator=( const fixed_eytzinger_radix_map& other );
+    fixed_eytzinger_radix_map& operator=( fixed_eytzinger_radix_map&& other ) noexcept(
+        std::allocator_traits<_Allocator>::propagate_on_container_move_assignment::value );
+    
+    
+    // Allocator
+    allocator_type get_allocator() const noexcept;
+    
+    
+    // Element access
+    const mapped_type& at( const key_type& key ) const;
+    
+    
+    // Iterators
+    const_iterator begin()     const noexcept;
+    const_iterator end()       const noexcept;
+    const_iterator cbegin()    const noexcept;
+    const_iterator cend()      const noexcept;
+    
+    
+    // Modifiers
+    void swap( fixed_eytzinger_radix_map& other ) noexcept;
+    
+    
+    // Capacity
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    
+    
+    // Observers
+    key_compare key_comp() const;
+    // 0 for an empty map.
+    size_type buckets() const noexcept;
+    
+    
+    // Lookup
+    size_type count( const key_type& key ) const noexcept;
+    const_iterator find( const key_type& key ) const noexcept;
+    const_range_pair equal_range( const key_type& key ) const noexcept;
+    const_iterator lower_bound( const key_type& key ) const noexcept;
+    const_iterator upper_bound( const key_type& key ) const noexcept;
+    
+private:
+    typedef __eytzinger::__storage<_Key, _Value, _Compare, _Allocator> __base;
+    typedef typename __base::alloc_traits alloc_traits;
+    typedef typename __base::propagation propagation;
+    typedef typename __base::scratch_type scratch_type;
+    typedef std::vector<size_type, typename alloc_traits::template rebind_alloc<size_type> >
+        directory_type;
+    
+    void init( scratch_type &_t, bool _sorted );
+    size_type bucket( const key_type &_key ) const noexcept;
+    template <bool _Upper>
+    size_type bound_index( const key_type &_key ) const noexcept;
+    size_type find_index( const key_type &_key ) const noexcept;
+    const_iterator at_index( size_type _i ) const noexcept;
+    static const unsigned prefetch_distance = fixed_eytzinger_prefetch_distance<_Key>::value;
+    [[noreturn]] static void throw_at()
+    { throw std::out_of_range("fixed_eytzinger_radix_map::at:  key not found"); }
+    
+    using __base::__m_count;
+    using __base::__m_keys;
+    using __base::__m_values;
+    using __base::__m_alloc;
+    using __base::alloc_init;
+    using __base::emplace_at;
+    using __base::comparator;
+    using __base::comp;
+    
+    directory_type  __m_offsets;    // the first element of every bucket, then the count
+    directory_type  __m_successors; // the first element in order after every bucket
+    std::uint64_t   __m_min;        // bucket = (projection - __m_min) >> __m_shift
+    unsigned        __m_shift;
+};
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+fixed_eytzinger_radix_map() :
+    fixed_eytzinger_radix_map( _Compare() )
+{
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+fixed_eytzinger_radix_map( const _Compare& _comp, const _Allocator& _alloc ) :
+    __base( _comp, _alloc ),
+    __m_offsets( _alloc ),
+    __m_successors( _alloc ),
+    __m_min( 0 ),
+    __m_shift( 0 )
+{
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+fixed_eytzinger_radix_map(std::initializer_list<value_type> _l,
+                          const _Compare& _comp,
+                          const _Allocator& _alloc ) :
+    fixed_eytzinger_radix_map( std::begin(_l), std::end(_l), _comp, _alloc )
+{
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+template<typename _InputIterator>
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+fixed_eytzinger_radix_map(_InputIterator _begin,
+                          _InputIterator _end,
+                          const _Compare& _comp,
+                          const _Allocator& _alloc ) :
+    fixed_eytzinger_radix_map( _comp, _alloc )
+{
+    scratch_type __t( _begin, _end, _alloc );
+    init( __t, false );
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+template<typename _InputIterator>
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+fixed_eytzinger_radix_map(fixed_eytzinger_sorted_unique_t,
+                          _InputIterator _begin,
+                          _InputIterator _end,
+                          const _Compare& _comp,
+                          const _Allocator& _alloc ) :
+    fixed_eytzinger_radix_map( _comp, _alloc )
+{
+    scratch_type __t( _begin, _end, _alloc );
+    init( __t, true );
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+fixed_eytzinger_radix_map( const fixed_eytzinger_radix_map& _other, const _Allocator& _alloc ) :
+    __base( _other, _alloc ),
+    __m_offsets( _other.__m_offsets, _alloc ),
+    __m_successors( _other.__m_successors, _alloc ),
+    __m_min( _other.__m_min ),
+    __m_shift( _other.__m_shift )
+{
+}
+
+// The copy is made with the allocator this map ends up with and then taken over.
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>&
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+operator=( const fixed_eytzinger_radix_map& _other )
+{
+    if( this != &_other )
+        *this = fixed_eytzinger_radix_map( _other,
+            propagation::__copy_allocator(__m_alloc, _other.__m_alloc) );
+    return *this;
+}
+
+// The directory of a map whose storage can't be taken over is copied first, so that nothing
+// changes if the storage can't be moved.
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>&
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+operator=( fixed_eytzinger_radix_map&& _other ) noexcept(
+    std::allocator_traits<_Allocator>::propagate_on_container_move_assignment::value )
+{
+    if( propagation::__can_take(__m_alloc, _other.__m_alloc) ) {
+        __base::operator=( std::move(_other) );
+        __m_offsets = std::move( _other.__m_offsets );
+        __m_successors = std::move( _other.__m_successors );
+    }
+    else {
+        directory_type __offsets( _other.__m_offsets, __m_offsets.get_allocator() );
+        directory_type __successors( _other.__m_successors, __m_successors.get_allocator() );
+        __base::operator=( std::move(_other) );
+        __m_offsets.swap( __offsets );
+        __m_successors.swap( __successors );
+    }
+    _other.__m_offsets.clear();
+    _other.__m_successors.clear();
+    __m_min = _other.__m_min;
+    __m_shift = _other.__m_shift;
+    return *this;
+}
+
+// Picks the number of buckets, a power of two up to one per eight keys, and the shift which
+// brings the range of projected keys under it. Then every bucket is laid out as a tree of its
+// own: the node at index j of a tree of n nodes holds the element which goes in order as the
+// rank of j, as in fixed_eytzinger_map.
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+void fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+init( scratch_type &_t, bool _sorted )
+{
+    if( !_sorted ) {
+        std::sort(_t.begin(), _t.end(), [this](const value_type &_v1, const value_type &_v2) {
+            return comp(_v1.first, _v2.first);
+        });
+        _t.erase( std::unique( _t.begin(), _t.end(),
+                               [this](const value_type &_v1, const value_type &_v2){
+            return !comp(_v1.first, _v2.first) && !comp(_v2.first, _v1.first);
+        }), _t.end());
+    }
+    else {
+        for( size_type __i = 1; __i < _t.size(); ++__i )
+            if( !comp(_t[__i - 1].first, _t[__i].first) )
+                throw std::invalid_argument(
+                    "fixed_eytzinger_radix_map: keys are not sorted or not unique");
+    }
+    
+    const size_type __count = _t.size();
+    if( __count == 0 )
+        return;
+    const _Projection __projection{};
+    __m_min = __projection( _t.front().first );
+    const std::uint64_t __span = __projection( _t.back().first ) - __m_min;
+    size_type __limit = 1;
+    while( __limit < (size_type(1) << max_bits) && __limit * 2 * 8 <= __count )
+        __limit *= 2;
+    while( __m_shift < 63 && (__span >> __m_shift) >= __limit )
+        ++__m_shift;
+    const size_type __buckets = size_type(__span >> __m_shift) + 1;
+    
+    __m_offsets.assign( __buckets + 1, 0 );
+    for( const value_type &__v: _t )
+        ++__m_offsets[bucket(__v.first) + 1];
+    for( size_type __b = 0; __b < __buckets; ++__b )
+        __m_offsets[__b + 1] += __m_offsets[__b];
+    
+    __m_successors.assign( __buckets, __count );
+    for( size_type __b = __buckets, __next = __count; __b-- > 0; ) {
+        __m_successors[__b] = __next;
+        const size_type __first = __m_offsets[__b], __n = __m_offsets[__b + 1] - __first;
+        if( __n != 0 )
+            __next = __first + __eytzinger::__inorder_first( __n );
+    }
+    
+    // keys and values are nothrow move constructible, nothing throws once they are allocated
+    alloc_init( __count );
+    for( size_type __b = 0; __b < __buckets; ++__b ) {
+        const size_type __first = __m_offsets[__b], __n = __m_offsets[__b + 1] - __first;
+        size_type __rank = __first;
+        for( size_type __j = __eytzinger::__inorder_first(__n); __j != __n;
+             __j = __eytzinger::__inorder_next(__j, __n), ++__rank )
+            emplace_at( __first + __j, std::move(_t[__rank].first), std::move(_t[__rank].second) );
+    }
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::size_type
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+bucket( const key_type &_key ) const noexcept
+{
+    const std::uint64_t __p = _Projection{}( _key );
+    const size_type __last = __m_offsets.size() - 2;
+    if( __p <= __m_min )
+        return 0;
+    const std::uint64_t __b = (__p - __m_min) >> __m_shift;
+    return __b < __last ? size_type(__b) : __last;
+}
+
+// Keys of other buckets are all less or all greater than the key, so the bound is in its bucket
+// or is the first element after it.
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+template <bool _Upper>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::size_type
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+bound_index( const key_type &_key ) const noexcept
+{
+    if( __m_count == 0 )
+        return 0;
+    const size_type __b = bucket( _key );
+    const size_type __first = __m_offsets[__b], __n = __m_offsets[__b + 1] - __first;
+    const size_type __i = _Upper ?
+        __eytzinger::__upper_bound<prefetch_distance>( __m_keys + __first, __n, _key,
+                                                       comparator() ) :
+        __eytzinger::__lower_bound<prefetch_distance>( __m_keys + __first, __n, _key,
+                                                       comparator() );
+    return __i != __n ? __first + __i : __m_successors[__b];
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::size_type
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+find_index( const key_type &_key ) const noexcept
+{
+    const size_type __i = bound_index<false>( _key );
+    return __i != size() && !comp(_key, __m_keys[__i]) ? __i : size();
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+const_iterator
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+at_index( size_type _i ) const noexcept
+{
+    return const_iterator{__m_keys + _i, __m_values + _i};
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+allocator_type
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+get_allocator() const noexcept
+{
+    return __base::get_allocator();
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+const _Value &fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+at( const key_type &_key ) const
+{
+    const size_type __i = find_index( _key );
+    if( __i == size() )
+        throw_at();
+    return __m_values[__i];
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+const_iterator
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+begin() const noexcept
+{
+    return at_index( 0 );
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+const_iterator
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+end() const noexcept
+{
+    return at_index( size() );
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+const_iterator
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+cbegin() const noexcept
+{
+    return begin();
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+const_iterator
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+cend() const noexcept
+{
+    return end();
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+void fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+swap( fixed_eytzinger_radix_map& _other ) noexcept
+{
+    __base::swap( _other );
+    __m_offsets.swap( _other.__m_offsets );
+    __m_successors.swap( _other.__m_successors );
+    std::swap( __m_min, _other.__m_min );
+    std::swap( __m_shift, _other.__m_shift );
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+bool fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+empty() const noexcept
+{
+    return __m_count == 0;
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::size_type
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+size() const noexcept
+{
+    return __m_count;
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::key_compare
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+key_comp() const
+{
+    return comparator();
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::size_type
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+buckets() const noexcept
+{
+    return __m_successors.size();
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::size_type
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+count( const key_type& _key ) const noexcept
+{
+    return find_index(_key) != size();
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+const_iterator
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+find( const key_type& _key ) const noexcept
+{
+    return at_index( find_index(_key) );
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+const_range_pair
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+equal_range( const key_type& _key ) const noexcept
+{
+    const const_iterator __p = find(_key);
+    return {__p, __p == end() ? __p : std::next(__p, 1)};
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+const_iterator
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+lower_bound( const key_type& _key ) const noexcept
+{
+    return at_index( bound_index<false>(_key) );
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+typename fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+const_iterator
+fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>::
+upper_bound( const key_type& _key ) const noexcept
+{
+    return at_index( bound_index<true>(_key) );
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+inline bool
+operator==(const fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>& __x,
+           const fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>& __y)
+{
+    return __x.size() == __y.size() && std::equal(__x.begin(), __x.end(), __y.begin());
+}
+
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+inline bool
+operator!=(const fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>& __x,
+           const fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>& __y)
+{
+    return !(__x == __y);
+}
+
+namespace std
+{
+template <typename _Key, typename _Value, class _Projection, class _Compare, class _Allocator>
+inline void swap(fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>& __x,
+                 fixed_eytzinger_radix_map<_Key, _Value, _Projection, _Compare, _Allocator>& __y )
+{
+    __y.swap( __x );
+}
+}
@@ -0,0 +1,652 @@
+/* Copyright (c) 2017 Michael Kazakov <mike.kazakov@gmail.com>
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#pragma once
+
+#include "fixed_eytzinger_map.h"
+
+// fixed_eytzinger_set lays keys out exactly as fixed_eytzinger_map does and looks them up with the
+// same code, but has no values. Its iterators are plain pointers into the array of keys, which
+// go in the layout order, like the iterators of the map.
+
+template <typename _Key, class _Compare = std::less<_Key>, class _Allocator = std::allocator<_Key> >
+class fixed_eytzinger_set : private __eytzinger::__storage<_Key, void, _Compare, _Allocator>
+{
+public:
+    typedef size_t                                  size_type;
+    typedef _Key                                    value_type;
+    typedef _Key                                    key_type;
+    typedef _Compare                                key_compare;
+    typedef _Compare                                value_compare;
+    typedef _Allocator                              allocator_type;
+    typedef const _Key*                             iterator;
+    typedef const _Key*                             const_iterator;
+    typedef std::pair<iterator,iterator>            range_pair;
+
+    static_assert( std::is_nothrow_move_constructible<key_type>::value,
+        "key_type must be nothrow move constructible" );
+
+    // Construction
+    fixed_eytzinger_set();
+    explicit fixed_eytzinger_set( const _Compare& comp,
+                                  const _Allocator& alloc = _Allocator() );
+    explicit fixed_eytzinger_set( const _Allocator& alloc );
+    fixed_eytzinger_set( const fixed_eytzinger_set& _other );
+    fixed_eytzinger_set( const fixed_eytzinger_set& _other, const _Allocator& alloc );
+    fixed_eytzinger_set( fixed_eytzinger_set&& other );
+    fixed_eytzinger_set( fixed_eytzinger_set&& other, const _Allocator& alloc );
+    fixed_eytzinger_set(std::initializer_list<value_type> l,
+                        const _Compare& comp = _Compare(),
+                        const _Allocator& alloc = _Allocator() );
+    fixed_eytzinger_set(std::initializer_list<value_type> l,
+                        const _Allocator& alloc );
+    template<typename _InputIterator>
+    fixed_eytzinger_set(_InputIterator begin,
+                        _InputIterator end,
+                        const _Compare& comp = _Compare(),
+                        const _Allocator& alloc = _Allocator() );
+    template<typename _InputIterator>
+    fixed_eytzinger_set(_InputIterator begin,
+                        _InputIterator end,
+                        const _Allocator& alloc );
+
+    // Construction which takes over the vector and sorts it in place, the vector is left empty.
+    template<typename _VectorAllocator>
+    fixed_eytzinger_set(std::vector<value_type, _VectorAllocator>&& v,
+                        const _Compare& comp = _Compare(),
+                        const _Allocator& alloc = _Allocator() );
+
+    // Construction from input which is sorted and has unique keys, takes linear time.
+    // Throws std::invalid_argument if the input isn't sorted or has duplicates.
+    fixed_eytzinger_set(fixed_eytzinger_sorted_unique_t,
+                        std::initializer_list<value_type> l,
+                        const _Compare& comp = _Compare(),
+                        const _Allocator& alloc = _Allocator() );
+    template<typename _InputIterator>
+    fixed_eytzinger_set(fixed_eytzinger_sorted_unique_t,
+                        _InputIterator begin,
+                        _InputIterator end,
+                        const _Compare& comp = _Compare(),
+                        const _Allocator& alloc = _Allocator() );
+
+
+    // Allocator
+    allocator_type get_allocator() const noexcept;
+
+
+    // Iterators
+    const_iterator begin()     const noexcept;
+    const_iterator end()       const noexcept;
+    const_iterator cbegin()    const noexcept;
+    const_iterator cend()      const noexcept;
+
+
+    // Modifiers
+    void clear() noexcept;
+    void swap( fixed_eytzinger_set& other ) noexcept;
+
+
+    // Capacity
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    size_type max_size() const noexcept;
+
+
+    // Observers
+    key_compare key_comp() const;
+    value_compare value_comp() const;
+
+
+    // Lookup
+    size_type count( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    size_type count( const _K2& key ) const noexcept;
+
+    const_iterator find( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_iterator find(const _K2& key) const noexcept;
+
+    range_pair equal_range( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    range_pair equal_range(const _K2& key) const noexcept;
+
+    const_iterator lower_bound( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_iterator lower_bound(const _K2& key) const noexcept;
+
+    const_iterator upper_bound( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_iterator upper_bound(const _K2& key) const noexcept;
+
+
+    // Batch lookup
+    // Each of these looks up every key in [first, last) and writes one result per key to out.
+    template <typename _ForwardIterator, typename _OutputIterator>
+    _OutputIterator count_batch(_ForwardIterator first,
+                                _ForwardIterator last,
+                                _OutputIterator out ) const;
+
+    template <typename _ForwardIterator, typename _OutputIterator>
+    _OutputIterator find_batch(_ForwardIterator first,
+                               _ForwardIterator last,
+                               _OutputIterator out ) const;
+
+    template <typename _ForwardIterator, typename _OutputIterator>
+    _OutputIterator lower_bound_batch(_ForwardIterator first,
+                                      _ForwardIterator last,
+                                      _OutputIterator out ) const;
+
+
+    // Assignment
+    fixed_eytzinger_set& operator=( const fixed_eytzinger_set& other );
+    fixed_eytzinger_set& operator=( fixed_eytzinger_set&& other ) noexcept(
+        std::allocator_traits<_Allocator>::propagate_on_container_move_assignment::value );
+    fixed_eytzinger_set& operator=( std::initializer_list<value_type> l );
+    template<typename _InputIterator>
+    void assign( _InputIterator begin, _InputIterator end );
+    void assign( std::initializer_list<value_type> l );
+    template<typename _VectorAllocator>
+    void assign( std::vector<value_type, _VectorAllocator>&& v );
+    template<typename _InputIterator>
+    void assign( fixed_eytzinger_sorted_unique_t, _InputIterator begin, _InputIterator end );
+
+private:
+    typedef __eytzinger::__storage<_Key, void, _Compare, _Allocator> __base;
+    typedef typename __base::scratch_type scratch_type;
+
+    template <typename _Vector>
+    void init( _Vector &_t );
+    static const unsigned prefetch_distance = fixed_eytzinger_prefetch_distance<_Key>::value;
+    template <class _K2>
+    const_iterator find_impl(const _K2& _key) const noexcept;
+
+    using __base::__m_count;
+    using __base::__m_keys;
+    using __base::__m_alloc;
+    using __base::init_sorted;
+    using __base::swap_data;
+    using __base::comparator;
+    using __base::comp;
+    using __base::equal;
+    using __base::comp2;
+};
+
+template <typename _Key, typename _Compare, typename _Allocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::fixed_eytzinger_set( ) :
+    fixed_eytzinger_set( _Compare() )
+{
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+fixed_eytzinger_set( const _Compare& _comp, const _Allocator& _alloc ) :
+    __base( _comp, _alloc )
+{
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+fixed_eytzinger_set( const _Allocator& _alloc ) :
+    fixed_eytzinger_set( _Compare(), _alloc )
+{
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+fixed_eytzinger_set( fixed_eytzinger_set&& _other ) :
+    __base( std::move(_other) )
+{
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+fixed_eytzinger_set( fixed_eytzinger_set&& _other, const _Allocator& _alloc ) :
+    __base( std::move(_other), _alloc )
+{
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+fixed_eytzinger_set( const fixed_eytzinger_set& _other ) :
+    __base( _other )
+{
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+fixed_eytzinger_set( const fixed_eytzinger_set& _other, const _Allocator& _alloc ) :
+    __base( _other, _alloc )
+{
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+fixed_eytzinger_set(std::initializer_list<value_type> _l,
+                    const _Compare& _comp,
+                    const _Allocator& _alloc):
+    fixed_eytzinger_set( _comp, _alloc )
+{
+    scratch_type t( std::begin(_l), std::end(_l), __m_alloc );
+    init( t );
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+fixed_eytzinger_set(std::initializer_list<value_type> _l,
+                    const _Allocator& _alloc):
+    fixed_eytzinger_set( _l, _Compare(), _alloc )
+{
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template<typename _InputIterator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+fixed_eytzinger_set(_InputIterator _begin,
+                    _InputIterator _end,
+                    const _Compare& _comp,
+                    const _Allocator& _alloc ):
+    fixed_eytzinger_set( _comp, _alloc )
+{
+    static_assert( std::is_constructible<value_type,
+                        typename std::iterator_traits<_InputIterator>::reference>::
+                        value,
+                    "incompatible iterator type");
+    scratch_type t( _begin, _end, __m_alloc );
+    init( t );
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template<typename _InputIterator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+fixed_eytzinger_set(_InputIterator _begin,
+                    _InputIterator _end,
+                    const _Allocator& _alloc ):
+    fixed_eytzinger_set( _begin, _end, _Compare(), _alloc )
+{
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template<typename _VectorAllocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+fixed_eytzinger_set(std::vector<value_type, _VectorAllocator>&& _v,
+                    const _Compare& _comp,
+                    const _Allocator& _alloc ):
+    fixed_eytzinger_set( _comp, _alloc )
+{
+    std::vector<value_type, _VectorAllocator> t( std::move(_v) ); // freed once the set is built
+    _v.clear();
+    init( t );
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+fixed_eytzinger_set(fixed_eytzinger_sorted_unique_t,
+                    std::initializer_list<value_type> _l,
+                    const _Compare& _comp,
+                    const _Allocator& _alloc):
+    fixed_eytzinger_set( _comp, _alloc )
+{
+    this->template init_fill<true>( _l.size(), std::begin(_l) );
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template<typename _InputIterator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+fixed_eytzinger_set(fixed_eytzinger_sorted_unique_t,
+                    _InputIterator _begin,
+                    _InputIterator _end,
+                    const _Compare& _comp,
+                    const _Allocator& _alloc ):
+    fixed_eytzinger_set( _comp, _alloc )
+{
+    static_assert( std::is_constructible<value_type,
+                        typename std::iterator_traits<_InputIterator>::reference>::
+                        value,
+                    "incompatible iterator type");
+    init_sorted( _begin, _end,
+                 typename std::iterator_traits<_InputIterator>::iterator_category() );
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+_Allocator fixed_eytzinger_set<_Key, _Compare, _Allocator>::get_allocator() const noexcept
+{
+    return __m_alloc;
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template <typename _Vector>
+void fixed_eytzinger_set<_Key, _Compare, _Allocator>::init( _Vector &_t )
+{
+    std::sort(std::begin(_t), std::end(_t), [this](const _Key &_v1, const _Key &_v2) {
+        return comp(_v1, _v2);
+    });
+    _t.erase( std::unique( _t.begin(), _t.end(), [this](const _Key &_v1, const _Key &_v2){
+        return equal(_v1, _v2);
+    }), _t.end());
+
+    this->template init_fill<false>( _t.size(), std::make_move_iterator(_t.begin()) );
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+void fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+clear() noexcept
+{
+    __base::clear();
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+void fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+swap( fixed_eytzinger_set& other ) noexcept
+{
+    __base::swap(other);
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::begin() const noexcept
+{
+    return __m_keys;
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::end() const noexcept
+{
+    return __m_keys + __m_count;
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::cbegin() const noexcept
+{
+    return begin();
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::cend() const noexcept
+{
+    return end();
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+bool fixed_eytzinger_set<_Key, _Compare, _Allocator>::empty() const noexcept
+{
+    return __m_count == 0;
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::size_type
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::size() const noexcept
+{
+    return __m_count;
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::size_type
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::max_size() const noexcept
+{
+    return std::numeric_limits<size_type>::max() / 4;
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::key_compare
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::key_comp() const
+{
+    return comparator();
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::value_compare
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::value_comp() const
+{
+    return comparator();
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template <class _K2>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::find_impl( const _K2& _key ) const noexcept
+{
+    const size_type i =
+        __eytzinger::__lower_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
+    return i != __m_count && !comp2(_key, __m_keys[i]) ? __m_keys + i : end();
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::size_type
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::count( const key_type& _key ) const noexcept
+{
+    return find_impl(_key) != end();
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::size_type
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::count( const _K2& _key ) const noexcept
+{
+    return find_impl(_key) != end();
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::find( const key_type& _key ) const noexcept
+{
+    return find_impl(_key);
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::find( const _K2& _key ) const noexcept
+{
+    return find_impl(_key);
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::range_pair
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+equal_range( const key_type& _key ) const noexcept
+{
+    const const_iterator __p = find_impl(_key);
+    return {__p, __p == end() ? __p : __p + 1};
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::range_pair
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+equal_range( const _K2& _key ) const noexcept
+{
+    const const_iterator __p = find_impl(_key);
+    return {__p, __p == end() ? __p : __p + 1};
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+lower_bound( const key_type& _key ) const noexcept
+{
+    return __m_keys +
+        __eytzinger::__lower_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+lower_bound( const _K2& _key ) const noexcept
+{
+    return __m_keys +
+        __eytzinger::__lower_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+upper_bound( const key_type& _key ) const noexcept
+{
+    return __m_keys +
+        __eytzinger::__upper_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_set<_Key, _Compare, _Allocator>::const_iterator
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+upper_bound( const _K2& _key ) const noexcept
+{
+    return __m_keys +
+        __eytzinger::__upper_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template <typename _ForwardIterator, typename _OutputIterator>
+_OutputIterator fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+count_batch( _ForwardIterator _first, _ForwardIterator _last, _OutputIterator _out ) const
+{
+    __base::template check_batch_iterator<_ForwardIterator>();
+    __eytzinger::__lower_bound_batch(__m_keys, __m_count, _first, _last, comparator(),
+                                     [&](_ForwardIterator _k, size_type _i){
+        *_out++ = size_type( _i != __m_count && !comp2(*_k, __m_keys[_i]) );
+    });
+    return _out;
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template <typename _ForwardIterator, typename _OutputIterator>
+_OutputIterator fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+find_batch( _ForwardIterator _first, _ForwardIterator _last, _OutputIterator _out ) const
+{
+    __base::template check_batch_iterator<_ForwardIterator>();
+    __eytzinger::__lower_bound_batch(__m_keys, __m_count, _first, _last, comparator(),
+                                     [&](_ForwardIterator _k, size_type _i){
+        if( _i != __m_count && !comp2(*_k, __m_keys[_i]) )
+            *_out++ = const_iterator(__m_keys + _i);
+        else
+            *_out++ = end();
+    });
+    return _out;
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template <typename _ForwardIterator, typename _OutputIterator>
+_OutputIterator fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+lower_bound_batch( _ForwardIterator _first, _ForwardIterator _last, _OutputIterator _out ) const
+{
+    __base::template check_batch_iterator<_ForwardIterator>();
+    __eytzinger::__lower_bound_batch(__m_keys, __m_count, _first, _last, comparator(),
+                                     [&](_ForwardIterator, size_type _i){
+        *_out++ = const_iterator(__m_keys + _i);
+    });
+    return _out;
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>&
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+operator=( fixed_eytzinger_set&& other ) noexcept(
+    std::allocator_traits<_Allocator>::propagate_on_container_move_assignment::value )
+{
+    __base::operator=(std::move(other));
+    return *this;
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>&
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+operator=( const fixed_eytzinger_set& other )
+{
+    __base::operator=(other);
+    return *this;
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+fixed_eytzinger_set<_Key, _Compare, _Allocator>&
+fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+operator=( std::initializer_list<value_type> l )
+{
+    assign( l );
+    return *this;
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template<typename _InputIterator>
+void fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+assign(_InputIterator _begin, _InputIterator _end)
+{
+    fixed_eytzinger_set __tmp (_begin, _end, comparator(), get_allocator());
+    swap_data(__tmp);
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+void fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+assign( std::initializer_list<value_type> l )
+{
+    fixed_eytzinger_set __tmp (l, comparator(), get_allocator());
+    swap_data(__tmp);
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template<typename _VectorAllocator>
+void fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+assign( std::vector<value_type, _VectorAllocator>&& _v )
+{
+    fixed_eytzinger_set __tmp (std::move(_v), comparator(), get_allocator());
+    swap_data(__tmp);
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+template<typename _InputIterator>
+void fixed_eytzinger_set<_Key, _Compare, _Allocator>::
+assign( fixed_eytzinger_sorted_unique_t _tag, _InputIterator _begin, _InputIterator _end )
+{
+    fixed_eytzinger_set __tmp (_tag, _begin, _end, comparator(), get_allocator());
+    swap_data(__tmp);
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+inline bool
+operator==(const fixed_eytzinger_set<_Key, _Compare, _Allocator>& __x,
+           const fixed_eytzinger_set<_Key, _Compare, _Allocator>& __y)
+{
+    return __x.size() == __y.size() && std::equal(__x.begin(), __x.end(), __y.begin());
+}
+
+template <typename _Key, typename _Compare, typename _Allocator>
+inline bool
+operator!=(const fixed_eytzinger_set<_Key, _Compare, _Allocator>& __x,
+           const fixed_eytzinger_set<_Key, _Compare, _Allocator>& __y)
+{
+    return !(__x == __y);
+}
+
+namespace std
+{
+template <typename _Key, typename _Compare, typename _Allocator>
+inline void swap(fixed_eytzinger_set<_Key, _Compare, _Allocator>& __x,
+                 fixed_eytzinger_set<_Key, _Compare, _Allocator>& __y )
+{
+    __y.swap( __x );
+}
+}
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+
+// fixed_eytzinger_set which takes its memory from a std::pmr::memory_resource.
+template <typename _Key, class _Compare = std::less<_Key> >
+using fixed_eytzinger_pmr_set =
+    fixed_eytzinger_set<_Key, _Compare, std::pmr::polymorphic_allocator<_Key> >;
+#endif
+#endif
@@ -0,0 +1,502 @@
+/* Copyright (c) 2017 Michael Kazakov <mike.kazakov@gmail.com>
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#pragma once
+
+#include "fixed_eytzinger_string_map.h"
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <string_view>
+
+// fixed_eytzinger_string_arena_map is an immutable map of string keys which keeps the characters
+// of all keys in a single arena, in the Eytzinger order of the keys, and a fixed_eytzinger_map of
+// std::string_view keys into it. Building it takes a handful of allocations for all the keys
+// instead of one per key, and a key takes 16 bytes for the view and 8 bytes for the prefix cache of
+// fixed_eytzinger_string_map on top of its characters, instead of a std::string with a heap block
+// for anything longer than the short string buffer. As in fixed_eytzinger_string_map, a descent
+// reads the characters only when the cached prefixes are equal.
+// Lookups take anything which converts to std::string_view, e.g. std::string or const char*.
+// Copies of the map point their views into their own arenas.
+
+template <typename _Value,
+          class _Allocator = std::allocator< std::pair<std::string_view, _Value> > >
+class fixed_eytzinger_string_arena_map
+{
+public:
+    typedef fixed_eytzinger_map<std::string_view, _Value, std::less<std::string_view>, _Allocator>
+        base_type;
+    typedef size_t                                                      size_type;
+    typedef std::pair<std::string_view,_Value>                          value_type;
+    typedef std::string_view                                            key_type;
+    typedef _Value                                                      mapped_type;
+    typedef std::less<std::string_view>                                 key_compare;
+    typedef _Allocator                                                  allocator_type;
+    typedef typename base_type::const_iterator                          const_iterator;
+    typedef typename base_type::const_range_pair                        const_range_pair;
+    typedef typename base_type::const_ordered_iterator                  const_ordered_iterator;
+    typedef typename base_type::const_ordered_range                     const_ordered_range;
+    
+    // Construction
+    // The keys of the input are copied into the arena, so they only have to live until the
+    // constructor returns.
+    fixed_eytzinger_string_arena_map();
+    explicit fixed_eytzinger_string_arena_map( const _Allocator& alloc );
+    fixed_eytzinger_string_arena_map( std::initializer_list<value_type> l,
+                                      const _Allocator& alloc = _Allocator() );
+    template<typename _InputIterator>
+    fixed_eytzinger_string_arena_map( _InputIterator begin,
+                                      _InputIterator end,
+                                      const _Allocator& alloc = _Allocator() );
+    
+    // Construction from input which is sorted and has unique keys.
+    // Throws std::invalid_argument if the input isn't sorted or has duplicates.
+    template<typename _InputIterator>
+    fixed_eytzinger_string_arena_map( fixed_eytzinger_sorted_unique_t,
+                                      _InputIterator begin,
+                                      _InputIterator end,
+                                      const _Allocator& alloc = _Allocator() );
+    
+    fixed_eytzinger_string_arena_map( const fixed_eytzinger_string_arena_map& other );
+    fixed_eytzinger_string_arena_map( fixed_eytzinger_string_arena_map&& other ) noexcept;
+    fixed_eytzinger_string_arena_map& operator=( const fixed_eytzinger_string_arena_map& other );
+    fixed_eytzinger_string_arena_map& operator=( fixed_eytzinger_string_arena_map&& other );
+    
+    allocator_type get_allocator() const noexcept;
+    
+    
+    // Element access
+    const mapped_type& at( const key_type& key ) const;
+    
+    
+    // Iterators
+    const_iterator begin()     const noexcept;
+    const_iterator end()       const noexcept;
+    const_iterator cbegin()    const noexcept;
+    const_iterator cend()      const noexcept;
+    const_ordered_iterator ordered_begin()     const noexcept;
+    const_ordered_iterator ordered_end()       const noexcept;
+    
+    
+    // Capacity
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    
+    
+    // Modifiers
+    void swap( fixed_eytzinger_string_arena_map& other ) noexcept;
+    
+    
+    // Observers
+    key_compare key_comp() const;
+    const base_type& base() const noexcept;
+    // Number of bytes taken by the characters of all keys.
+    size_type arena_size() const noexcept;
+    
+    
+    // Lookup
+    size_type count( const key_type& key ) const noexcept;
+    const_iterator find( const key_type& key ) const noexcept;
+    const_range_pair equal_range( const key_type& key ) const noexcept;
+    const_iterator lower_bound( const key_type& key ) const noexcept;
+    const_iterator upper_bound( const key_type& key ) const noexcept;
+    
+    // Elements with keys in [lo, hi), in the order of keys.
+    const_ordered_range range( const key_type& lo, const key_type& hi ) const noexcept;
+    
+private:
+    typedef std::allocator_traits<_Allocator> alloc_traits;
+    typedef __eytzinger::__access access;
+    typedef std::vector<char, typename alloc_traits::template rebind_alloc<char> > arena_type;
+    typedef std::vector<std::uint64_t,
+                        typename alloc_traits::template rebind_alloc<std::uint64_t> >
+        prefixes_type;
+    typedef std::vector<value_type, typename alloc_traits::template rebind_alloc<value_type> >
+        scratch_type;
+    
+    template <bool _Sorted, typename _InputIterator>
+    void init( _InputIterator _first, _InputIterator _last );
+    void rebase( const char *_old ) noexcept;
+    template <bool _Upper>
+    size_type bound_index( const key_type &_key ) const noexcept;
+    size_type lower_index( const key_type &_key ) const noexcept;
+    size_type find_index( const key_type &_key ) const noexcept;
+    const_iterator at_index( size_type _i ) const noexcept;
+    static const unsigned prefetch_distance =
+        fixed_eytzinger_prefetch_distance<std::uint64_t>::value;
+    [[noreturn]] static void throw_at()
+    { throw std::out_of_range("fixed_eytzinger_string_arena_map::at:  key not found"); }
+    
+    arena_type      __m_arena;      // characters of the keys, in the order of __m_base's keys
+    base_type       __m_base;
+    prefixes_type   __m_prefixes;   // prefixes of the keys past __m_common, in the same order
+    size_type       __m_common;     // length of the prefix shared by all keys
+};
+
+template <typename _Value, typename _Allocator>
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::fixed_eytzinger_string_arena_map() :
+    fixed_eytzinger_string_arena_map( _Allocator() )
+{
+}
+
+template <typename _Value, typename _Allocator>
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+fixed_eytzinger_string_arena_map( const _Allocator& _alloc ) :
+    __m_arena( _alloc ),
+    __m_base( _alloc ),
+    __m_prefixes( _alloc ),
+    __m_common( 0 )
+{
+}
+
+template <typename _Value, typename _Allocator>
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+fixed_eytzinger_string_arena_map( std::initializer_list<value_type> _l, const _Allocator& _alloc ) :
+    fixed_eytzinger_string_arena_map( _alloc )
+{
+    init<false>( _l.begin(), _l.end() );
+}
+
+template <typename _Value, typename _Allocator>
+template <typename _InputIterator>
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+fixed_eytzinger_string_arena_map( _InputIterator _begin, _InputIterator _end,
+                                  const _Allocator& _alloc ) :
+    fixed_eytzinger_string_arena_map( _alloc )
+{
+    init<false>( _begin, _end );
+}
+
+template <typename _Value, typename _Allocator>
+template <typename _InputIterator>
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+fixed_eytzinger_string_arena_map( fixed_eytzinger_sorted_unique_t, _InputIterator _begin,
+                                  _InputIterator _end, const _Allocator& _alloc ) :
+    fixed_eytzinger_string_arena_map( _alloc )
+{
+    init<true>( _begin, _end );
+}
+
+template <typename _Value, typename _Allocator>
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+fixed_eytzinger_string_arena_map( const fixed_eytzinger_string_arena_map& _other ) :
+    __m_arena( _other.__m_arena ),
+    __m_base( _other.__m_base ),
+    __m_prefixes( _other.__m_prefixes ),
+    __m_common( _other.__m_common )
+{
+    rebase( _other.__m_arena.data() );
+}
+
+// Moving a vector hands its buffer over, so the views stay valid.
+template <typename _Value, typename _Allocator>
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+fixed_eytzinger_string_arena_map( fixed_eytzinger_string_arena_map&& _other ) noexcept :
+    __m_arena( std::move(_other.__m_arena) ),
+    __m_base( std::move(_other.__m_base) ),
+    __m_prefixes( std::move(_other.__m_prefixes) ),
+    __m_common( _other.__m_common )
+{
+    _other.__m_common = 0;
+}
+
+template <typename _Value, typename _Allocator>
+fixed_eytzinger_string_arena_map<_Value, _Allocator>&
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+operator=( const fixed_eytzinger_string_arena_map& _other )
+{
+    if( this != &_other )
+        fixed_eytzinger_string_arena_map( _other ).swap( *this );
+    return *this;
+}
+
+// An allocator which doesn't propagate can make the arena copy the characters rather than take
+// the buffer over, in which case the views are moved over to the copy.
+template <typename _Value, typename _Allocator>
+fixed_eytzinger_string_arena_map<_Value, _Allocator>&
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+operator=( fixed_eytzinger_string_arena_map&& _other )
+{
+    if( this != &_other ) {
+        const char *__old = _other.__m_arena.data();
+        __m_arena = std::move( _other.__m_arena );
+        __m_base = std::move( _other.__m_base );
+        __m_prefixes = std::move( _other.__m_prefixes );
+        __m_common = _other.__m_common;
+        _other.__m_common = 0;
+        if( __m_arena.data() != __old )
+            rebase( __old );
+    }
+    return *this;
+}
+
+// Copies the keys into a temporary arena first, since the input can hand out temporaries, lets
+// the map sort them, and then copies them into the arena in the order the map laid them out in.
+template <typename _Value, typename _Allocator>
+template <bool _Sorted, typename _InputIterator>
+void fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+init( _InputIterator _first, _InputIterator _last )
+{
+    arena_type __bytes( __m_arena.get_allocator() );
+    prefixes_type __offsets( __m_prefixes.get_allocator() );
+    scratch_type __scratch( __m_arena.get_allocator() );
+    for( ; _first != _last; ++_first ) {
+        auto &&__e = *_first;
+        const std::string_view __key( __e.first );
+        __offsets.emplace_back( __bytes.size() );
+        __bytes.insert( __bytes.end(), __key.begin(), __key.end() );
+        __scratch.emplace_back( std::string_view(), std::forward<decltype(__e)>(__e).second );
+    }
+    for( size_type __i = 0; __i < __scratch.size(); ++__i )
+        __scratch[__i].first = std::string_view( __bytes.data() + __offsets[__i],
+                                                 (__i + 1 < __offsets.size() ?
+                                                  __offsets[__i + 1] : __bytes.size()) -
+                                                 __offsets[__i] );
+    
+    base_type __base( __m_base.get_allocator() );
+    if constexpr( _Sorted )
+        __base = base_type( fixed_eytzinger_sorted_unique,
+                            std::make_move_iterator(__scratch.begin()),
+                            std::make_move_iterator(__scratch.end()),
+                            key_compare(), __m_base.get_allocator() );
+    else
+        __base = base_type( std::move(__scratch), key_compare(), __m_base.get_allocator() );
+    
+    size_type __size = 0;
+    for( size_type __i = 0; __i < access::count(__base); ++__i )
+        __size += access::keys(__base)[__i].size();
+    arena_type __arena( __size, char(0), __m_arena.get_allocator() );
+    for( size_type __i = 0, __p = 0; __i < access::count(__base); ++__i ) {
+        std::string_view &__key = access::keys(__base)[__i];
+        std::copy( __key.begin(), __key.end(), __arena.data() + __p );
+        __key = std::string_view( __arena.data() + __p, __key.size() );
+        __p += __key.size();
+    }
+    __m_common = __eytzinger::__make_prefixes( access::keys(__base), access::count(__base),
+                                               __m_prefixes );
+    __m_arena.swap( __arena );
+    __m_base.swap( __base );
+}
+
+// Points the views at the arena of this map, the same characters having been at _old.
+template <typename _Value, typename _Allocator>
+void fixed_eytzinger_string_arena_map<_Value, _Allocator>::rebase( const char *_old ) noexcept
+{
+    for( size_type __i = 0; __i < access::count(__m_base); ++__i ) {
+        std::string_view &__key = access::keys(__m_base)[__i];
+        __key = std::string_view( __m_arena.data() + (__key.data() - _old), __key.size() );
+    }
+}
+
+template <typename _Value, typename _Allocator>
+template <bool _Upper>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::size_type
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+bound_index( const key_type &_key ) const noexcept
+{
+    return __eytzinger::__prefix_bound<_Upper, prefetch_distance>(
+        __m_prefixes.data(), access::keys(__m_base), access::count(__m_base), __m_common, _key );
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::size_type
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+lower_index( const key_type &_key ) const noexcept
+{
+    return bound_index<false>( _key );
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::size_type
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+find_index( const key_type &_key ) const noexcept
+{
+    const size_type __i = lower_index( _key ), __count = access::count(__m_base);
+    return __i != __count && _key == access::keys(__m_base)[__i] ? __i : __count;
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::at_index( size_type _i ) const noexcept
+{
+    return const_iterator{access::keys(__m_base) + _i, access::values(__m_base) + _i};
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::allocator_type
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::get_allocator() const noexcept
+{
+    return __m_base.get_allocator();
+}
+
+template <typename _Value, typename _Allocator>
+const _Value &fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+at( const key_type &_key ) const
+{
+    const size_type __i = find_index( _key );
+    if( __i == access::count(__m_base) )
+        throw_at();
+    return access::values(__m_base)[__i];
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::begin() const noexcept
+{
+    return __m_base.begin();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::end() const noexcept
+{
+    return __m_base.end();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::cbegin() const noexcept
+{
+    return __m_base.cbegin();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::cend() const noexcept
+{
+    return __m_base.cend();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::const_ordered_iterator
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::ordered_begin() const noexcept
+{
+    return __m_base.ordered_begin();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::const_ordered_iterator
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::ordered_end() const noexcept
+{
+    return __m_base.ordered_end();
+}
+
+template <typename _Value, typename _Allocator>
+bool fixed_eytzinger_string_arena_map<_Value, _Allocator>::empty() const noexcept
+{
+    return __m_base.empty();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::size_type
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::size() const noexcept
+{
+    return __m_base.size();
+}
+
+template <typename _Value, typename _Allocator>
+void fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+swap( fixed_eytzinger_string_arena_map& _other ) noexcept
+{
+    __m_arena.swap( _other.__m_arena );
+    __m_base.swap( _other.__m_base );
+    __m_prefixes.swap( _other.__m_prefixes );
+    std::swap( __m_common, _other.__m_common );
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::key_compare
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::key_comp() const
+{
+    return __m_base.key_comp();
+}
+
+template <typename _Value, typename _Allocator>
+const typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::base_type&
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::base() const noexcept
+{
+    return __m_base;
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::size_type
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::arena_size() const noexcept
+{
+    return __m_arena.size();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::size_type
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+count( const key_type& _key ) const noexcept
+{
+    return find_index(_key) != access::count(__m_base);
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::find( const key_type& _key ) const noexcept
+{
+    return at_index( find_index(_key) );
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::const_range_pair
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+equal_range( const key_type& _key ) const noexcept
+{
+    const const_iterator __p = find(_key);
+    return {__p, __p == end() ? __p : std::next(__p, 1)};
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+lower_bound( const key_type& _key ) const noexcept
+{
+    return at_index( lower_index(_key) );
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+upper_bound( const key_type& _key ) const noexcept
+{
+    return at_index( bound_index<true>(_key) );
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_arena_map<_Value, _Allocator>::const_ordered_range
+fixed_eytzinger_string_arena_map<_Value, _Allocator>::
+range( const key_type& _lo, const key_type& _hi ) const noexcept
+{
+    const size_type __count = access::count(__m_base), __lo = lower_index(_lo);
+    size_type __hi = lower_index(_hi);
+    const std::string_view *__keys = access::keys(__m_base);
+    if( __lo == __count || (__hi != __count && __keys[__hi] < __keys[__lo]) )
+        __hi = __lo;
+    return const_ordered_range{
+        const_ordered_iterator{ access::keys(__m_base), access::values(__m_base), __lo, __count },
+        const_ordered_iterator{ access::keys(__m_base), access::values(__m_base), __hi, __count } };
+}
+
+namespace std
+{
+template <typename _Value, typename _Allocator>
+inline void swap( fixed_eytzinger_string_arena_map<_Value, _Allocator>& __x,
+                  fixed_eytzinger_string_arena_map<_Value, _Allocator>& __y ) noexcept
+{
+    __y.swap( __x );
+}
+}
+
+#endif
@@ -0,0 +1,367 @@
+/* Copyright (c) 2017 Michael Kazakov <mike.kazakov@gmail.com>
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#pragma once
+
+#include "fixed_eytzinger_map.h"
+#include <cstdint>
+#include <string>
+
+// fixed_eytzinger_string_map is an immutable fixed_eytzinger_map of std::string keys with a cache
+// of key prefixes which saves a lookup most of the string comparisons. Next to the keys it keeps
+// the first eight bytes of every key packed into a big-endian integer, in the same Eytzinger order,
+// so the integers compare as the strings do as far as the prefixes go. A descent compares these
+// integers first and only reads the key itself when the prefixes are equal, so a level of the tree
+// costs one cache miss rather than a miss on the string object and another on its characters.
+// The bytes which all keys begin with, e.g. the scheme and the host of URLs of one site, are left
+// out of the cached prefixes and are compared once per lookup instead.
+// The cache takes eight bytes per key. Keys which still share long prefixes after that get little
+// from it, since most of the steps of a descent fall through to the strings.
+
+namespace __eytzinger {
+
+// The first eight bytes of a string, zero-padded and packed so that the first byte is the most
+// significant one. A prefix less than the other one means the string is less than the other one.
+inline std::uint64_t __string_prefix( const char *_s, size_t _size ) noexcept
+{
+    std::uint64_t __p = 0;
+    for( size_t __i = 0; __i < 8; ++__i )
+        __p = (__p << 8) | (__i < _size ? (unsigned char)_s[__i] : 0u);
+    return __p;
+}
+
+// A string looked up along with its prefix.
+template <class _Key>
+struct __prefixed_string
+{
+    std::uint64_t __m_prefix;
+    const _Key &__m_string;
+};
+
+// Compares a node of the prefix cache with a looked up string, the node's key being at the same
+// index in _keys as the node's prefix is in _prefixes.
+template <class _Key>
+struct __prefix_compare
+{
+    const std::uint64_t *__m_prefixes;
+    const _Key *__m_keys;
+    bool operator()( const std::uint64_t &_p, const __prefixed_string<_Key> &_s ) const noexcept
+    {
+        return _p != _s.__m_prefix ? _p < _s.__m_prefix :
+            __m_keys[&_p - __m_prefixes] < _s.__m_string;
+    }
+    bool operator()( const __prefixed_string<_Key> &_s, const std::uint64_t &_p ) const noexcept
+    {
+        return _p != _s.__m_prefix ? _s.__m_prefix < _p :
+            _s.__m_string < __m_keys[&_p - __m_prefixes];
+    }
+};
+
+// Fills the prefix cache of _count string keys in Eytzinger order and returns the length of the
+// prefix which all of them begin with, which the cached prefixes start after.
+template <class _Key, class _Prefixes>
+inline size_t __make_prefixes( const _Key *_keys, size_t _count, _Prefixes &_prefixes )
+{
+    size_t __common = 0;
+    if( _count != 0 ) { // the prefix shared by the first and the last keys is shared by all
+        const _Key &__first = _keys[__inorder_first(_count)];
+        const _Key &__last = _keys[__inorder_last(_count)];
+        const size_t __max = std::min( __first.size(), __last.size() );
+        while( __common < __max && __first[__common] == __last[__common] )
+            ++__common;
+    }
+    _prefixes.clear();
+    _prefixes.reserve( _count );
+    for( size_t __i = 0; __i < _count; ++__i )
+        _prefixes.emplace_back( __string_prefix(_keys[__i].data() + __common,
+                                                _keys[__i].size() - __common) );
+    return __common;
+}
+
+// Index of the first key which is not less than _key, or greater than it if _Upper is set, found
+// through the prefix cache. A key which doesn't begin with the prefix shared by all keys is less
+// or greater than all of them and needs no descent.
+template <bool _Upper, unsigned _Prefetch, class _Key>
+inline size_t __prefix_bound( const std::uint64_t *_prefixes, const _Key *_keys, size_t _count,
+                              size_t _common, const _Key &_key ) noexcept
+{
+    if( _common != 0 ) {
+        const int __c = _key.compare( 0, _common, _keys[0], 0, _common );
+        if( __c < 0 || (__c == 0 && _key.size() < _common) )
+            return __inorder_first( _count );
+        if( __c > 0 )
+            return _count;
+    }
+    const __prefixed_string<_Key> __probe{
+        __string_prefix(_key.data() + _common, _key.size() - _common), _key };
+    const __prefix_compare<_Key> __comp{ _prefixes, _keys };
+    if( _Upper )
+        return __upper_bound<_Prefetch>( _prefixes, _count, __probe, __comp );
+    return __lower_bound<_Prefetch>( _prefixes, _count, __probe, __comp );
+}
+
+}
+
+template <typename _Value,
+          class _Allocator = std::allocator< std::pair<std::string, _Value> > >
+class fixed_eytzinger_string_map
+{
+public:
+    typedef fixed_eytzinger_map<std::string, _Value, std::less<std::string>, _Allocator>
+        base_type;
+    typedef size_t                                                      size_type;
+    typedef std::pair<std::string,_Value>                               value_type;
+    typedef std::string                                                 key_type;
+    typedef _Value                                                      mapped_type;
+    typedef std::less<std::string>                                      key_compare;
+    typedef _Allocator                                                  allocator_type;
+    typedef typename base_type::const_iterator                          const_iterator;
+    typedef typename base_type::const_range_pair                        const_range_pair;
+    typedef typename base_type::const_ordered_iterator                  const_ordered_iterator;
+    typedef typename base_type::const_ordered_range                     const_ordered_range;
+    
+    // Construction
+    // Takes over the map and builds the cache in linear time.
+    fixed_eytzinger_string_map();
+    explicit fixed_eytzinger_string_map( base_type base );
+    
+    
+    // Element access
+    const mapped_type& at( const key_type& key ) const;
+    
+    
+    // Iterators
+    const_iterator begin()     const noexcept;
+    const_iterator end()       const noexcept;
+    const_iterator cbegin()    const noexcept;
+    const_iterator cend()      const noexcept;
+    const_ordered_iterator ordered_begin()     const noexcept;
+    const_ordered_iterator ordered_end()       const noexcept;
+    
+    
+    // Capacity
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    
+    
+    // Observers
+    key_compare key_comp() const;
+    const base_type& base() const noexcept;
+    
+    
+    // Lookup
+    size_type count( const key_type& key ) const noexcept;
+    const_iterator find( const key_type& key ) const noexcept;
+    const_range_pair equal_range( const key_type& key ) const noexcept;
+    const_iterator lower_bound( const key_type& key ) const noexcept;
+    const_iterator upper_bound( const key_type& key ) const noexcept;
+    
+    // Elements with keys in [lo, hi), in the order of keys.
+    const_ordered_range range( const key_type& lo, const key_type& hi ) const noexcept;
+    
+private:
+    typedef std::allocator_traits<_Allocator> alloc_traits;
+    typedef __eytzinger::__access access;
+    typedef std::vector<std::uint64_t,
+                        typename alloc_traits::template rebind_alloc<std::uint64_t> >
+        prefixes_type;
+    
+    template <bool _Upper>
+    size_type bound_index( const key_type &_key ) const noexcept;
+    size_type lower_index( const key_type &_key ) const noexcept;
+    size_type find_index( const key_type &_key ) const noexcept;
+    const_iterator at_index( size_type _i ) const noexcept;
+    static const unsigned prefetch_distance =
+        fixed_eytzinger_prefetch_distance<std::uint64_t>::value;
+    [[noreturn]] static void throw_at()
+    { throw std::out_of_range("fixed_eytzinger_string_map::at:  key not found"); }
+    
+    base_type       __m_base;
+    prefixes_type   __m_prefixes;   // prefixes of the keys past __m_common, in the same order
+    size_type       __m_common;     // length of the prefix shared by all keys
+};
+
+template <typename _Value, typename _Allocator>
+fixed_eytzinger_string_map<_Value, _Allocator>::fixed_eytzinger_string_map() :
+    fixed_eytzinger_string_map( base_type() )
+{
+}
+
+template <typename _Value, typename _Allocator>
+fixed_eytzinger_string_map<_Value, _Allocator>::fixed_eytzinger_string_map( base_type _base ) :
+    __m_base( std::move(_base) ),
+    __m_prefixes( __m_base.get_allocator() ),
+    __m_common( __eytzinger::__make_prefixes(access::keys(__m_base), access::count(__m_base),
+                                             __m_prefixes) )
+{
+}
+
+template <typename _Value, typename _Allocator>
+template <bool _Upper>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::size_type
+fixed_eytzinger_string_map<_Value, _Allocator>::bound_index( const key_type &_key ) const noexcept
+{
+    return __eytzinger::__prefix_bound<_Upper, prefetch_distance>(
+        __m_prefixes.data(), access::keys(__m_base), access::count(__m_base), __m_common, _key );
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::size_type
+fixed_eytzinger_string_map<_Value, _Allocator>::lower_index( const key_type &_key ) const noexcept
+{
+    return bound_index<false>( _key );
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::size_type
+fixed_eytzinger_string_map<_Value, _Allocator>::find_index( const key_type &_key ) const noexcept
+{
+    const size_type __i = lower_index( _key ), __count = access::count(__m_base);
+    return __i != __count && _key == access::keys(__m_base)[__i] ? __i : __count;
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_map<_Value, _Allocator>::at_index( size_type _i ) const noexcept
+{
+    return const_iterator{access::keys(__m_base) + _i, access::values(__m_base) + _i};
+}
+
+template <typename _Value, typename _Allocator>
+const _Value &fixed_eytzinger_string_map<_Value, _Allocator>::at( const key_type &_key ) const
+{
+    const size_type __i = find_index( _key );
+    if( __i == access::count(__m_base) )
+        throw_at();
+    return access::values(__m_base)[__i];
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_map<_Value, _Allocator>::begin() const noexcept
+{
+    return __m_base.begin();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_map<_Value, _Allocator>::end() const noexcept
+{
+    return __m_base.end();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_map<_Value, _Allocator>::cbegin() const noexcept
+{
+    return __m_base.cbegin();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_map<_Value, _Allocator>::cend() const noexcept
+{
+    return __m_base.cend();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::const_ordered_iterator
+fixed_eytzinger_string_map<_Value, _Allocator>::ordered_begin() const noexcept
+{
+    return __m_base.ordered_begin();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::const_ordered_iterator
+fixed_eytzinger_string_map<_Value, _Allocator>::ordered_end() const noexcept
+{
+    return __m_base.ordered_end();
+}
+
+template <typename _Value, typename _Allocator>
+bool fixed_eytzinger_string_map<_Value, _Allocator>::empty() const noexcept
+{
+    return __m_base.empty();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::size_type
+fixed_eytzinger_string_map<_Value, _Allocator>::size() const noexcept
+{
+    return __m_base.size();
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::key_compare
+fixed_eytzinger_string_map<_Value, _Allocator>::key_comp() const
+{
+    return __m_base.key_comp();
+}
+
+template <typename _Value, typename _Allocator>
+const typename fixed_eytzinger_string_map<_Value, _Allocator>::base_type&
+fixed_eytzinger_string_map<_Value, _Allocator>::base() const noexcept
+{
+    return __m_base;
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::size_type
+fixed_eytzinger_string_map<_Value, _Allocator>::count( const key_type& _key ) const noexcept
+{
+    return find_index(_key) != access::count(__m_base);
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_map<_Value, _Allocator>::find( const key_type& _key ) const noexcept
+{
+    return at_index( find_index(_key) );
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::const_range_pair
+fixed_eytzinger_string_map<_Value, _Allocator>::equal_range( const key_type& _key ) const noexcept
+{
+    const const_iterator __p = find(_key);
+    return {__p, __p == end() ? __p : std::next(__p, 1)};
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_map<_Value, _Allocator>::lower_bound( const key_type& _key ) const noexcept
+{
+    return at_index( lower_index(_key) );
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::const_iterator
+fixed_eytzinger_string_map<_Value, _Allocator>::upper_bound( const key_type& _key ) const noexcept
+{
+    return at_index( bound_index<true>(_key) );
+}
+
+template <typename _Value, typename _Allocator>
+typename fixed_eytzinger_string_map<_Value, _Allocator>::const_ordered_range
+fixed_eytzinger_string_map<_Value, _Allocator>::
+range( const key_type& _lo, const key_type& _hi ) const noexcept
+{
+    const size_type __count = access::count(__m_base), __lo = lower_index(_lo);
+    size_type __hi = lower_index(_hi);
+    const std::string *__keys = access::keys(__m_base);
+    if( __lo == __count || (__hi != __count && __keys[__hi] < __keys[__lo]) )
+        __hi = __lo;
+    return const_ordered_range{
+        const_ordered_iterator{ access::keys(__m_base), access::values(__m_base), __lo, __count },
+        const_ordered_iterator{ access::keys(__m_base), access::values(__m_base), __hi, __count } };
+}
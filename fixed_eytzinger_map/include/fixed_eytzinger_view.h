@@ -0,0 +1,526 @@
+/* Copyright (c) 2017 Michael Kazakov <mike.kazakov@gmail.com>
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#pragma once
+
+#include "fixed_eytzinger_map.h"
+
+namespace __eytzinger
+{
+
+// Merges adjacent runs of [_first, _first+_n), starting with runs of _s elements, until the whole
+// range is one run. Every run has the elements at odd positions first and those at even positions
+// after them. The even part of the left run is rotated past the odd part of the right one.
+template <class _RandomAccessIterator>
+void __unshuffle_runs( _RandomAccessIterator _first, size_t _n, size_t _s )
+{
+    // the number of odd positions in [0, i) is i / 2
+    for( ; _s < _n; _s *= 2 )
+        for( size_t __b = 0; __b + _s < _n; __b += 2 * _s ) {
+            const size_t __m = __b + _s, __e = std::min( __b + 2 * _s, _n );
+            std::rotate( _first + (__b + __m / 2 - __b / 2),
+                         _first + __m,
+                         _first + (__m + __e / 2 - __m / 2) );
+        }
+}
+
+// Stable partition of [_first, _first+_n) by the parity of positions: elements at odd positions go
+// first, those at even positions go after them. Takes O(n log n) time and no memory. Short runs
+// are merged block by block while the block is in cache, then the blocks are merged.
+template <class _RandomAccessIterator>
+void __unshuffle( _RandomAccessIterator _first, size_t _n )
+{
+    const size_t __block = 4096;
+    for( size_t __b = 0; __b < _n; __b += __block )
+        __unshuffle_runs( _first + __b, std::min(__block, _n - __b), 1 );
+    __unshuffle_runs( _first, _n, __block );
+}
+
+}
+
+// Rearranges a sorted range in place into the layout of fixed_eytzinger_map, i.e. the breadth-first
+// order of a complete binary search tree, in O(n log n) time and without extra memory.
+// Only the positions of elements matter, so parallel columns, e.g. keys and values sorted
+// together, are permuted consistently by applying this to each of them.
+// Nodes on the last, partially filled, level of the tree are the elements at even positions
+// among the first 2L ones, where L is their number. They are moved to the end, which leaves a
+// perfect tree in sorted order at the front. The leaves of a perfect tree are all the elements at
+// even positions, and they go after its inner nodes, level by level up to the root.
+template <class _RandomAccessIterator>
+void fixed_eytzinger_permute( _RandomAccessIterator _first, _RandomAccessIterator _last )
+{
+    size_t __n = size_t(std::distance(_first, _last));
+    size_t __perfect = 1;
+    while( __perfect * 2 + 1 <= __n )
+        __perfect = __perfect * 2 + 1;
+    if( __n > 1 && __n != __perfect ) {
+        const size_t __leaves = __n - __perfect;
+        __eytzinger::__unshuffle( _first, 2 * __leaves );
+        std::rotate( _first + __leaves, _first + 2 * __leaves, _first + __n );
+        __n = __perfect;
+    }
+    for( ; __n > 1; __n /= 2 )
+        __eytzinger::__unshuffle( _first, __n );
+}
+
+// fixed_eytzinger_view searches arrays of keys and values which are owned by the caller and are
+// already in the layout of fixed_eytzinger_map, e.g. sorted columns rearranged with
+// fixed_eytzinger_permute. It has the const lookup interface of the map and is as cheap to copy
+// as a pair of pointers. The arrays must outlive the view.
+
+template <typename _Key, typename _Value, class _Compare = std::less<_Key> >
+class fixed_eytzinger_view : private _Compare
+{
+public:
+    typedef size_t                                              size_type;
+    typedef std::pair<_Key,_Value>                              value_type;
+    typedef _Key                                                key_type;
+    typedef _Value                                              mapped_type;
+    typedef _Compare                                            key_compare;
+    typedef __eytzinger::__const_proxy_iterator<_Key, _Value>   iterator;
+    typedef __eytzinger::__const_proxy_iterator<_Key, _Value>   const_iterator;
+    typedef std::pair<const_iterator,const_iterator>            const_range_pair;
+    typedef __eytzinger::__ordered_iterator<_Key, const _Value> const_ordered_iterator;
+    typedef std::reverse_iterator<const_ordered_iterator>       const_reverse_ordered_iterator;
+    typedef __eytzinger::__range<const_ordered_iterator>        const_ordered_range;
+    
+    // Construction
+    fixed_eytzinger_view() noexcept;
+    fixed_eytzinger_view( const key_type *keys,
+                          const mapped_type *values,
+                          size_type count,
+                          const _Compare& comp = _Compare() ) noexcept;
+    
+    
+    // Modifiers
+    void swap( fixed_eytzinger_view& other ) noexcept;
+    
+    
+    // Element access
+    const mapped_type& at( const key_type& key ) const;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const mapped_type& at( const _K2& key ) const;
+    
+    
+    // Iterators
+    const_iterator begin()     const noexcept;
+    const_iterator end()       const noexcept;
+    const_iterator cbegin()    const noexcept;
+    const_iterator cend()      const noexcept;
+    
+    
+    // Iterators in the order of keys
+    const_ordered_iterator ordered_begin()     const noexcept;
+    const_ordered_iterator ordered_end()       const noexcept;
+    const_reverse_ordered_iterator ordered_rbegin()    const noexcept;
+    const_reverse_ordered_iterator ordered_rend()      const noexcept;
+    
+    
+    // Capacity
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+    
+    
+    // Observers
+    key_compare key_comp() const;
+    
+    
+    // Lookup
+    size_type count( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    size_type count( const _K2& key ) const noexcept;
+    
+    const_iterator find( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_iterator find(const _K2& key) const noexcept;
+    
+    const_range_pair equal_range( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_range_pair equal_range(const _K2& key) const noexcept;
+    
+    const_iterator lower_bound( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_iterator lower_bound(const _K2& key) const noexcept;
+    
+    const_iterator upper_bound( const key_type& key ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_iterator upper_bound(const _K2& key) const noexcept;
+    
+    // Elements with keys in [lo, hi), in the order of keys.
+    const_ordered_range range( const key_type& lo, const key_type& hi ) const noexcept;
+    template <typename _K2, typename _C = _Compare, typename = typename _C::is_transparent>
+    const_ordered_range range( const _K2& lo, const _K2& hi ) const noexcept;
+    
+    
+    // Batch lookup
+    // Each of these looks up every key in [first, last) and writes one result per key to out.
+    template <typename _ForwardIterator, typename _OutputIterator>
+    _OutputIterator count_batch(_ForwardIterator first,
+                                _ForwardIterator last,
+                                _OutputIterator out ) const;
+    
+    template <typename _ForwardIterator, typename _OutputIterator>
+    _OutputIterator find_batch(_ForwardIterator first,
+                               _ForwardIterator last,
+                               _OutputIterator out ) const;
+    
+    template <typename _ForwardIterator, typename _OutputIterator>
+    _OutputIterator lower_bound_batch(_ForwardIterator first,
+                                      _ForwardIterator last,
+                                      _OutputIterator out ) const;
+    
+private:
+    template <class _K2>
+    size_type lower_index( const _K2 &_key ) const noexcept;
+    template <class _K2>
+    size_type find_index( const _K2 &_key ) const noexcept;
+    template <typename _ForwardIterator>
+    static void check_batch_iterator() noexcept;
+    static const unsigned prefetch_distance = fixed_eytzinger_prefetch_distance<_Key>::value;
+    const _Compare &comparator() const noexcept { return *this; }
+    template <class _K1, class _K2>
+    bool comp2(const _K1& _v1, const _K2 &_v2) const noexcept
+    { return _Compare::operator()(_v1, _v2); }
+    [[noreturn]] static void throw_at()
+    { throw std::out_of_range("fixed_eytzinger_view::at:  key not found"); }
+    
+    size_type           __m_count;
+    const key_type     *__m_keys;
+    const mapped_type  *__m_values;
+};
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_view<_Key, _Value, _Compare>::fixed_eytzinger_view() noexcept :
+    __m_count( 0 ),
+    __m_keys( nullptr ),
+    __m_values( nullptr )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+fixed_eytzinger_view<_Key, _Value, _Compare>::
+fixed_eytzinger_view( const key_type *_keys,
+                      const mapped_type *_values,
+                      size_type _count,
+                      const _Compare& _comp ) noexcept :
+    _Compare( _comp ),
+    __m_count( _count ),
+    __m_keys( _keys ),
+    __m_values( _values )
+{
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+void fixed_eytzinger_view<_Key, _Value, _Compare>::swap( fixed_eytzinger_view& _other ) noexcept
+{
+    std::swap(__m_count, _other.__m_count);
+    std::swap(__m_keys, _other.__m_keys);
+    std::swap(__m_values, _other.__m_values);
+    std::swap((_Compare&)*this, (_Compare&)_other);
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::key_compare
+fixed_eytzinger_view<_Key, _Value, _Compare>::key_comp() const
+{
+    return comparator();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <class _K2>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::size_type
+fixed_eytzinger_view<_Key, _Value, _Compare>::lower_index( const _K2& _key ) const noexcept
+{
+    return __eytzinger::__lower_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <class _K2>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::size_type
+fixed_eytzinger_view<_Key, _Value, _Compare>::find_index( const _K2& _key ) const noexcept
+{
+    const size_type __i = lower_index( _key );
+    return __i != __m_count && !comp2(_key, __m_keys[__i]) ? __i : __m_count;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+const _Value &fixed_eytzinger_view<_Key, _Value, _Compare>::at( const key_type &_key ) const
+{
+    const size_type __i = find_index( _key );
+    if( __i == __m_count )
+        throw_at();
+    return __m_values[__i];
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+const _Value &fixed_eytzinger_view<_Key, _Value, _Compare>::at( const _K2 &_key ) const
+{
+    const size_type __i = find_index( _key );
+    if( __i == __m_count )
+        throw_at();
+    return __m_values[__i];
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::begin() const noexcept
+{
+    return const_iterator{__m_keys, __m_values};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::end() const noexcept
+{
+    return const_iterator{__m_keys + __m_count, __m_values + __m_count};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::cbegin() const noexcept
+{
+    return begin();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::cend() const noexcept
+{
+    return end();
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_ordered_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::ordered_begin() const noexcept
+{
+    return const_ordered_iterator{ __m_keys, __m_values,
+                                   __eytzinger::__inorder_first(__m_count), __m_count };
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_ordered_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::ordered_end() const noexcept
+{
+    return const_ordered_iterator{ __m_keys, __m_values, __m_count, __m_count };
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_reverse_ordered_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::ordered_rbegin() const noexcept
+{
+    return const_reverse_ordered_iterator{ ordered_end() };
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_reverse_ordered_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::ordered_rend() const noexcept
+{
+    return const_reverse_ordered_iterator{ ordered_begin() };
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+bool fixed_eytzinger_view<_Key, _Value, _Compare>::empty() const noexcept
+{
+    return __m_count == 0;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::size_type
+fixed_eytzinger_view<_Key, _Value, _Compare>::size() const noexcept
+{
+    return __m_count;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::size_type
+fixed_eytzinger_view<_Key, _Value, _Compare>::count( const key_type& _key ) const noexcept
+{
+    return find_index(_key) != __m_count;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::size_type
+fixed_eytzinger_view<_Key, _Value, _Compare>::count( const _K2& _key ) const noexcept
+{
+    return find_index(_key) != __m_count;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::find( const key_type& _key ) const noexcept
+{
+    const size_type __i = find_index(_key);
+    return const_iterator{__m_keys + __i, __m_values + __i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::find( const _K2& _key ) const noexcept
+{
+    const size_type __i = find_index(_key);
+    return const_iterator{__m_keys + __i, __m_values + __i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_range_pair
+fixed_eytzinger_view<_Key, _Value, _Compare>::
+equal_range( const key_type& _key ) const noexcept
+{
+    const const_iterator __p = find(_key);
+    return {__p, __p == end() ? __p : std::next(__p, 1)};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_range_pair
+fixed_eytzinger_view<_Key, _Value, _Compare>::
+equal_range( const _K2& _key ) const noexcept
+{
+    const const_iterator __p = find(_key);
+    return {__p, __p == end() ? __p : std::next(__p, 1)};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::
+lower_bound( const key_type& _key ) const noexcept
+{
+    const size_type __i = lower_index(_key);
+    return const_iterator{__m_keys + __i, __m_values + __i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::
+lower_bound( const _K2& _key ) const noexcept
+{
+    const size_type __i = lower_index(_key);
+    return const_iterator{__m_keys + __i, __m_values + __i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::
+upper_bound( const key_type& _key ) const noexcept
+{
+    const size_type __i =
+        __eytzinger::__upper_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
+    return const_iterator{__m_keys + __i, __m_values + __i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_iterator
+fixed_eytzinger_view<_Key, _Value, _Compare>::
+upper_bound( const _K2& _key ) const noexcept
+{
+    const size_type __i =
+        __eytzinger::__upper_bound<prefetch_distance>(__m_keys, __m_count, _key, comparator());
+    return const_iterator{__m_keys + __i, __m_values + __i};
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_ordered_range
+fixed_eytzinger_view<_Key, _Value, _Compare>::
+range( const key_type& _lo, const key_type& _hi ) const noexcept
+{
+    const size_type __lo = lower_index(_lo);
+    size_type __hi = lower_index(_hi);
+    if( __lo == __m_count || (__hi != __m_count && comp2(__m_keys[__hi], __m_keys[__lo])) )
+        __hi = __lo;
+    return const_ordered_range{ const_ordered_iterator{ __m_keys, __m_values, __lo, __m_count },
+                                const_ordered_iterator{ __m_keys, __m_values, __hi, __m_count } };
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _K2, typename _C, typename>
+typename fixed_eytzinger_view<_Key, _Value, _Compare>::const_ordered_range
+fixed_eytzinger_view<_Key, _Value, _Compare>::
+range( const _K2& _lo, const _K2& _hi ) const noexcept
+{
+    const size_type __lo = lower_index(_lo);
+    size_type __hi = lower_index(_hi);
+    if( __lo == __m_count || (__hi != __m_count && comp2(__m_keys[__hi], __m_keys[__lo])) )
+        __hi = __lo;
+    return const_ordered_range{ const_ordered_iterator{ __m_keys, __m_values, __lo, __m_count },
+                                const_ordered_iterator{ __m_keys, __m_values, __hi, __m_count } };
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _ForwardIterator>
+void fixed_eytzinger_view<_Key, _Value, _Compare>::check_batch_iterator() noexcept
+{
+    static_assert( std::is_base_of<std::forward_iterator_tag,
+                        typename std::iterator_traits<_ForwardIterator>::iterator_category>::value,
+                   "batch lookup requires forward iterators" );
+    static_assert( std::is_same<typename std::iterator_traits<_ForwardIterator>::value_type,
+                                _Key>::value ||
+                   __eytzinger::__is_transparent<_Compare>::value,
+                   "heterogeneous batch lookup requires a transparent comparator" );
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _ForwardIterator, typename _OutputIterator>
+_OutputIterator fixed_eytzinger_view<_Key, _Value, _Compare>::
+count_batch( _ForwardIterator _first, _ForwardIterator _last, _OutputIterator _out ) const
+{
+    check_batch_iterator<_ForwardIterator>();
+    __eytzinger::__lower_bound_batch(__m_keys, __m_count, _first, _last, comparator(),
+                                     [&](_ForwardIterator _k, size_type _i){
+        *_out++ = size_type( _i != __m_count && !comp2(*_k, __m_keys[_i]) );
+    });
+    return _out;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _ForwardIterator, typename _OutputIterator>
+_OutputIterator fixed_eytzinger_view<_Key, _Value, _Compare>::
+find_batch( _ForwardIterator _first, _ForwardIterator _last, _OutputIterator _out ) const
+{
+    check_batch_iterator<_ForwardIterator>();
+    __eytzinger::__lower_bound_batch(__m_keys, __m_count, _first, _last, comparator(),
+                                     [&](_ForwardIterator _k, size_type _i){
+        if( _i != __m_count && !comp2(*_k, __m_keys[_i]) )
+            *_out++ = const_iterator{__m_keys + _i, __m_values + _i};
+        else
+            *_out++ = end();
+    });
+    return _out;
+}
+
+template <typename _Key, typename _Value, typename _Compare>
+template <typename _ForwardIterator, typename _OutputIterator>
+_OutputIterator fixed_eytzinger_view<_Key, _Value, _Compare>::
+lower_bound_batch( _ForwardIterator _first, _ForwardIterator _last, _OutputIterator _out ) const
+{
+    check_batch_iterator<_ForwardIterator>();
+    __eytzinger::__lower_bound_batch(__m_keys, __m_count, _first, _last, comparator(),
+                                     [&](_ForwardIterator, size_type _i){
+        *_out++ = const_iterator{__m_keys + _i, __m_values + _i};
+    });
+    return _out;
+}
+
+namespace std
+{
+template <typename _Key, typename _Value, typename _Compare>
+inline void swap(fixed_eytzinger_view<_Key, _Value, _Compare>& __x,
+                 fixed_eytzinger_view<_Key, _Value, _Compare>& __y )
+{
+    __y.swap( __x );
+}
+}
@@ -0,0 +1,486 @@
+/* Copyright (c) 2017 Michael Kazakov <mike.kazakov@gmail.com>
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
+#pragma once
+
+#include "fixed_eytzinger_map.h"
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <array>
+
+// static_eytzinger_map is an immutable map of a fixed number of elements, _N, which keeps its keys
+// and values in std::array members instead of a heap block. It's meant for small tables known at
+// compile time, like opcode or enum name tables: the constructor is constexpr, so a constexpr map
+// is sorted and laid out by the compiler, takes no startup work and can be put in read-only data.
+// Lookups are constexpr as well. The depth of the tree is known statically, so a descent is
+// unrolled into a fixed sequence of branchless steps instead of a loop.
+// With keys or values which aren't literal types the map still works, just at run time.
+// Keys must be unique: duplicates make the constructor throw std::invalid_argument, which fails
+// the compilation of a constexpr map.
+
+namespace __eytzinger
+{
+
+// Number of complete levels of a tree of _count nodes.
+constexpr unsigned __static_levels( size_t _count ) noexcept
+{
+    unsigned __levels = 0;
+    while( (size_t(2) << __levels) - 1 <= _count )
+        ++__levels;
+    return __levels;
+}
+
+template <class _Less>
+constexpr void __static_sift_down( size_t *_a, size_t _i, size_t _n, _Less &_less ) noexcept
+{
+    while( 2 * _i + 1 < _n ) {
+        size_t __c = 2 * _i + 1;
+        if( __c + 1 < _n && _less(_a[__c], _a[__c + 1]) )
+            ++__c;
+        if( !_less(_a[_i], _a[__c]) )
+            return;
+        const size_t __t = _a[_i];
+        _a[_i] = _a[__c];
+        _a[__c] = __t;
+        _i = __c;
+    }
+}
+
+// Heap sort of _n indices, constexpr unlike std::sort before C++20.
+template <class _Less>
+constexpr void __static_sort( size_t *_a, size_t _n, _Less _less ) noexcept
+{
+    for( size_t __i = _n / 2; __i-- > 0; )
+        __static_sift_down( _a, __i, _n, _less );
+    for( size_t __n = _n; __n > 1; ) {
+        --__n;
+        const size_t __t = _a[0];
+        _a[0] = _a[__n];
+        _a[__n] = __t;
+        __static_sift_down( _a, 0, __n, _less );
+    }
+}
+
+// Places _sorted[_k], _sorted[_k+1], ... into the nodes of the subtree _j in order, returns the
+// index of the first element which didn't go into it.
+constexpr size_t __static_layout( const size_t *_sorted, size_t *_nodes, size_t _count,
+                                  size_t _j, size_t _k ) noexcept
+{
+    if( _j >= _count )
+        return _k;
+    _k = __static_layout( _sorted, _nodes, _count, 2 * _j + 1, _k );
+    _nodes[_j] = _sorted[_k++];
+    return __static_layout( _sorted, _nodes, _count, 2 * _j + 2, _k );
+}
+
+// Iterates over a pair of parallel key and value arrays, usable in constant expressions.
+template <class _Key, class _Value>
+struct __static_iterator
+{
+    typedef std::bidirectional_iterator_tag         iterator_category;
+    typedef ptrdiff_t                               difference_type;
+    typedef std::pair<_Key, _Value>                 value_type;
+    typedef __const_pair_ptr_wrap<_Key, _Value>     pointer;
+    typedef std::pair<const _Key&, const _Value&>   reference;
+
+    constexpr __static_iterator() noexcept : k(nullptr), v(nullptr)
+    { }
+    constexpr __static_iterator(const _Key *_k, const _Value *_v) noexcept : k(_k), v(_v)
+    { }
+    constexpr reference operator *() const noexcept
+    {
+        return reference{ *k, *v };
+    }
+    pointer operator->() const noexcept
+    {
+        return pointer{ k, v };
+    }
+    constexpr __static_iterator &operator++() noexcept
+    {
+        ++k; ++v; return *this;
+    }
+    constexpr __static_iterator operator++(int) noexcept
+    {
+        __static_iterator __tmp = *this; ++(*this); return __tmp;
+    }
+    constexpr __static_iterator &operator--() noexcept
+    {
+        --k; --v; return *this;
+    }
+    constexpr __static_iterator operator--(int) noexcept
+    {
+        __static_iterator __tmp = *this; --(*this); return __tmp;
+    }
+    constexpr bool operator ==(const __static_iterator &_rhs) const noexcept
+    {
+        return k == _rhs.k;
+    }
+    constexpr bool operator !=(const __static_iterator &_rhs) const noexcept
+    {
+        return k != _rhs.k;
+    }
+private:
+    const _Key *k;
+    const _Value *v;
+};
+
+}
+
+template <typename _Key, typename _Value, size_t _N, class _Compare = std::less<_Key> >
+class static_eytzinger_map : private _Compare
+{
+public:
+    typedef size_t                                                      size_type;
+    typedef std::pair<_Key,_Value>                                      value_type;
+    typedef _Key                                                        key_type;
+    typedef _Value                                                      mapped_type;
+    typedef _Compare                                                    key_compare;
+    typedef __eytzinger::__static_iterator<_Key, _Value>                const_iterator;
+    typedef std::pair<const_iterator,const_iterator>                    const_range_pair;
+    
+    // Construction
+    // Only an empty map, _N == 0, can be default-constructed.
+    constexpr static_eytzinger_map();
+    // The elements don't have to be sorted.
+    // Throws std::invalid_argument if there are duplicate keys.
+    template <size_t _M>
+    constexpr static_eytzinger_map( const value_type (&l)[_M],
+                                    const _Compare& comp = _Compare() );
+    constexpr explicit static_eytzinger_map( const std::array<value_type, _N>& a,
+                                             const _Compare& comp = _Compare() );
+    
+    
+    // Element access
+    constexpr mapped_type& at( const key_type& key );
+    constexpr const mapped_type& at( const key_type& key ) const;
+    constexpr mapped_type& operator[]( const key_type& key );
+    constexpr const mapped_type& operator[]( const key_type& key ) const;
+    
+    
+    // Iterators
+    constexpr const_iterator begin()     const noexcept;
+    constexpr const_iterator end()       const noexcept;
+    constexpr const_iterator cbegin()    const noexcept;
+    constexpr const_iterator cend()      const noexcept;
+    
+    
+    // Capacity
+    constexpr bool empty() const noexcept;
+    constexpr size_type size() const noexcept;
+    
+    
+    // Modifiers
+    void swap( static_eytzinger_map& other ) noexcept( std::is_nothrow_swappable_v<_Key> &&
+                                                       std::is_nothrow_swappable_v<_Value> &&
+                                                       std::is_nothrow_swappable_v<_Compare> );
+    
+    
+    // Observers
+    constexpr key_compare key_comp() const;
+    
+    
+    // Lookup
+    constexpr size_type count( const key_type& key ) const noexcept;
+    constexpr const_iterator find( const key_type& key ) const noexcept;
+    constexpr const_range_pair equal_range( const key_type& key ) const noexcept;
+    constexpr const_iterator lower_bound( const key_type& key ) const noexcept;
+    constexpr const_iterator upper_bound( const key_type& key ) const noexcept;
+    
+private:
+    constexpr void init( const value_type *_l );
+    template <bool _Upper>
+    constexpr void step( size_type &_j, size_type &_r, const key_type &_key ) const noexcept;
+    template <bool _Upper, size_t... _Levels>
+    constexpr size_type bound_index( const key_type &_key,
+                                     std::index_sequence<_Levels...> ) const noexcept;
+    template <bool _Upper>
+    constexpr size_type bound_index( const key_type &_key ) const noexcept;
+    constexpr size_type find_index( const key_type &_key ) const noexcept;
+    constexpr const_iterator at_index( size_type _j ) const noexcept;
+    constexpr const _Compare &comparator() const noexcept { return *this; }
+    static constexpr unsigned levels = __eytzinger::__static_levels( _N );
+    static constexpr bool has_partial_level = (size_type(1) << levels) - 1 != _N;
+    [[noreturn]] static void throw_at()
+    { throw std::out_of_range("static_eytzinger_map::at:  key not found"); }
+    [[noreturn]] static void throw_sb()
+    { throw std::out_of_range("static_eytzinger_map::operator[]:  key not found"); }
+    [[noreturn]] static void throw_duplicates()
+    { throw std::invalid_argument("static_eytzinger_map:  duplicate keys"); }
+    
+    std::array<_Key, _N>    __m_keys;
+    std::array<_Value, _N>  __m_values;
+};
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr static_eytzinger_map<_Key, _Value, _N, _Compare>::static_eytzinger_map():
+    _Compare(),
+    __m_keys{},
+    __m_values{}
+{
+    static_assert( _N == 0, "only an empty static_eytzinger_map can be default-constructed" );
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+template <size_t _M>
+constexpr static_eytzinger_map<_Key, _Value, _N, _Compare>::
+static_eytzinger_map( const value_type (&_l)[_M], const _Compare& _comp ):
+    _Compare(_comp),
+    __m_keys{},
+    __m_values{}
+{
+    static_assert( _M == _N, "static_eytzinger_map takes exactly _N elements" );
+    init( _l );
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr static_eytzinger_map<_Key, _Value, _N, _Compare>::
+static_eytzinger_map( const std::array<value_type, _N>& _a, const _Compare& _comp ):
+    _Compare(_comp),
+    __m_keys{},
+    __m_values{}
+{
+    init( _a.data() );
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr void static_eytzinger_map<_Key, _Value, _N, _Compare>::init( const value_type *_l )
+{
+    std::array<size_type, _N> __sorted{};
+    std::array<size_type, _N> __nodes{};
+    for( size_type __i = 0; __i < _N; ++__i )
+        __sorted[__i] = __i;
+    
+    __eytzinger::__static_sort( __sorted.data(), _N, [&](size_type _a, size_type _b) {
+        return bool( comparator()(_l[_a].first, _l[_b].first) );
+    });
+    for( size_type __i = 1; __i < _N; ++__i )
+        if( !comparator()(_l[__sorted[__i - 1]].first, _l[__sorted[__i]].first) )
+            throw_duplicates();
+    
+    __eytzinger::__static_layout( __sorted.data(), __nodes.data(), _N, 0, 0 );
+    for( size_type __j = 0; __j < _N; ++__j ) {
+        __m_keys[__j] = _l[__nodes[__j]].first;
+        __m_values[__j] = _l[__nodes[__j]].second;
+    }
+}
+
+// One level of a descent: _r is the last node at which it went left so far.
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+template <bool _Upper>
+constexpr void static_eytzinger_map<_Key, _Value, _N, _Compare>::
+step( size_type &_j, size_type &_r, const key_type &_key ) const noexcept
+{
+    const bool __right = _Upper ?
+        !bool( comparator()(_key, __m_keys[_j]) ) :
+        bool( comparator()(__m_keys[_j], _key) );
+    _r ^= (_r ^ _j) & (size_type(__right) - 1); // _r = __right ? _r : _j, which compilers branch on
+    _j = 2 * _j + 1 + size_type(__right);
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+template <bool _Upper, size_t... _Levels>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::size_type
+static_eytzinger_map<_Key, _Value, _N, _Compare>::
+bound_index( const key_type &_key, std::index_sequence<_Levels...> ) const noexcept
+{
+    size_type __j = 0, __r = _N;
+    ( (void(_Levels), step<_Upper>(__j, __r, _key)), ... );  // complete levels, no bound checks
+    if constexpr( has_partial_level )
+        if( __j < _N )
+            step<_Upper>( __j, __r, _key );
+    return __r;
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+template <bool _Upper>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::size_type
+static_eytzinger_map<_Key, _Value, _N, _Compare>::bound_index( const key_type &_key ) const noexcept
+{
+    return bound_index<_Upper>( _key, std::make_index_sequence<levels>() );
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::size_type
+static_eytzinger_map<_Key, _Value, _N, _Compare>::find_index( const key_type &_key ) const noexcept
+{
+    const size_type __j = bound_index<false>( _key );
+    return __j != _N && !comparator()(_key, __m_keys[__j]) ? __j : _N;
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::const_iterator
+static_eytzinger_map<_Key, _Value, _N, _Compare>::at_index( size_type _j ) const noexcept
+{
+    return const_iterator{ __m_keys.data() + _j, __m_values.data() + _j };
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr _Value &static_eytzinger_map<_Key, _Value, _N, _Compare>::at( const key_type &_key )
+{
+    const size_type __j = find_index( _key );
+    if( __j == _N )
+        throw_at();
+    return __m_values[__j];
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr const _Value &
+static_eytzinger_map<_Key, _Value, _N, _Compare>::at( const key_type &_key ) const
+{
+    const size_type __j = find_index( _key );
+    if( __j == _N )
+        throw_at();
+    return __m_values[__j];
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr _Value &
+static_eytzinger_map<_Key, _Value, _N, _Compare>::operator[]( const key_type &_key )
+{
+    const size_type __j = find_index( _key );
+    if( __j == _N )
+        throw_sb();
+    return __m_values[__j];
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr const _Value &
+static_eytzinger_map<_Key, _Value, _N, _Compare>::operator[]( const key_type &_key ) const
+{
+    const size_type __j = find_index( _key );
+    if( __j == _N )
+        throw_sb();
+    return __m_values[__j];
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::const_iterator
+static_eytzinger_map<_Key, _Value, _N, _Compare>::begin() const noexcept
+{
+    return at_index( 0 );
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::const_iterator
+static_eytzinger_map<_Key, _Value, _N, _Compare>::end() const noexcept
+{
+    return at_index( _N );
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::const_iterator
+static_eytzinger_map<_Key, _Value, _N, _Compare>::cbegin() const noexcept
+{
+    return begin();
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::const_iterator
+static_eytzinger_map<_Key, _Value, _N, _Compare>::cend() const noexcept
+{
+    return end();
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr bool static_eytzinger_map<_Key, _Value, _N, _Compare>::empty() const noexcept
+{
+    return _N == 0;
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::size_type
+static_eytzinger_map<_Key, _Value, _N, _Compare>::size() const noexcept
+{
+    return _N;
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+void static_eytzinger_map<_Key, _Value, _N, _Compare>::swap( static_eytzinger_map& _other )
+    noexcept( std::is_nothrow_swappable_v<_Key> &&
+              std::is_nothrow_swappable_v<_Value> &&
+              std::is_nothrow_swappable_v<_Compare> )
+{
+    using std::swap;
+    swap( static_cast<_Compare&>(*this), static_cast<_Compare&>(_other) );
+    swap( __m_keys, _other.__m_keys );
+    swap( __m_values, _other.__m_values );
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::key_compare
+static_eytzinger_map<_Key, _Value, _N, _Compare>::key_comp() const
+{
+    return comparator();
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::size_type
+static_eytzinger_map<_Key, _Value, _N, _Compare>::count( const key_type &_key ) const noexcept
+{
+    const size_type __j = bound_index<false>( _key );
+    return __j != _N && !comparator()(_key, __m_keys[__j]);
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::const_iterator
+static_eytzinger_map<_Key, _Value, _N, _Compare>::find( const key_type &_key ) const noexcept
+{
+    return at_index( find_index(_key) );
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::const_range_pair
+static_eytzinger_map<_Key, _Value, _N, _Compare>::equal_range( const key_type &_key ) const noexcept
+{
+    const size_type __j = bound_index<false>( _key );
+    if( __j != _N && !comparator()(_key, __m_keys[__j]) )
+        return const_range_pair{ at_index(__j), at_index(bound_index<true>(_key)) };
+    return const_range_pair{ at_index(__j), at_index(__j) };
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::const_iterator
+static_eytzinger_map<_Key, _Value, _N, _Compare>::lower_bound( const key_type &_key ) const noexcept
+{
+    return at_index( bound_index<false>(_key) );
+}
+
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+constexpr typename static_eytzinger_map<_Key, _Value, _N, _Compare>::const_iterator
+static_eytzinger_map<_Key, _Value, _N, _Compare>::upper_bound( const key_type &_key ) const noexcept
+{
+    return at_index( bound_index<true>(_key) );
+}
+
+// Builds a map of as many elements as there are in the braced list, e.g.
+// constexpr auto m = make_static_eytzinger_map<int, std::string_view>({{1, "one"}, {2, "two"}});
+template <typename _Key, typename _Value, class _Compare = std::less<_Key>, size_t _N>
+constexpr static_eytzinger_map<_Key, _Value, _N, _Compare>
+make_static_eytzinger_map( const std::pair<_Key, _Value> (&_l)[_N],
+                           const _Compare& _comp = _Compare() )
+{
+    return static_eytzinger_map<_Key, _Value, _N, _Compare>( _l, _comp );
+}
+
+namespace std
+{
+template <typename _Key, typename _Value, size_t _N, typename _Compare>
+inline void swap( static_eytzinger_map<_Key, _Value, _N, _Compare>& __x,
+                  static_eytzinger_map<_Key, _Value, _N, _Compare>& __y )
+    noexcept( noexcept(__x.swap(__y)) )
+{
+    __y.swap( __x );
+}
+}
+
+#endif
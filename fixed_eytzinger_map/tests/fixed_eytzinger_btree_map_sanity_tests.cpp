@@ -0,0 +1,143 @@
+#include <catch.hpp>
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <numeric>
+#include <fixed_eytzinger_btree_map.h>
+
+template <typename _Key>
+static void check_btree_lookup( int _max_size )
+{
+    for( int n = 0; n <= _max_size; ++n ) {
+        std::vector<_Key> keys;
+        for( int i = 0; i < n; ++i )
+            keys.emplace_back( _Key(2 * i + 1) );
+        std::vector< std::pair<_Key, int> > d;
+        for( int i = 0; i < n; ++i )
+            d.emplace_back( keys[i], i );
+        fixed_eytzinger_btree_map<_Key, int> e{ std::begin(d), std::end(d) };
+        REQUIRE( e.size() == size_t(n) );
+
+        for( int x = 0; x <= 2 * n + 1; ++x ) {
+            const _Key k = _Key(x);
+            const auto lb = std::lower_bound( std::begin(keys), std::end(keys), k );
+            const auto ub = std::upper_bound( std::begin(keys), std::end(keys), k );
+            if( lb == std::end(keys) )
+                CHECK( e.lower_bound(k) == e.end() );
+            else
+                CHECK( e.lower_bound(k)->first == *lb );
+            if( ub == std::end(keys) )
+                CHECK( e.upper_bound(k) == e.end() );
+            else
+                CHECK( e.upper_bound(k)->first == *ub );
+            if( x % 2 && x < 2 * n ) {
+                REQUIRE( e.find(k) != e.end() );
+                CHECK( e.at(k) == x / 2 );
+                CHECK( e.count(k) == 1 );
+            }
+            else {
+                CHECK( e.find(k) == e.end() );
+                CHECK( e.count(k) == 0 );
+            }
+        }
+    }
+}
+
+TEST_CASE( "B-tree lookup agrees with binary search over a sorted array",
+           "[fixed_eytzinger_btree_map]" )
+{
+    check_btree_lookup<int>( 600 );
+    check_btree_lookup<unsigned>( 300 );
+    check_btree_lookup<long long>( 300 );
+    check_btree_lookup<unsigned long long>( 300 );
+    check_btree_lookup<short>( 300 );
+    check_btree_lookup<float>( 300 );
+    check_btree_lookup<double>( 300 );
+}
+
+TEST_CASE( "B-tree handles keys of the whole range", "[fixed_eytzinger_btree_map]" )
+{
+    const unsigned big = std::numeric_limits<unsigned>::max();
+    fixed_eytzinger_btree_map<unsigned, int> e;
+    std::vector< std::pair<unsigned, int> > d;
+    for( int i = 0; i < 100; ++i ) {
+        d.emplace_back( unsigned(i), i );
+        d.emplace_back( big - unsigned(i), -i );
+    }
+    e.assign( std::begin(d), std::end(d) );
+    CHECK( e.size() == 200 );
+    for( int i = 0; i < 100; ++i ) {
+        CHECK( e.at(unsigned(i)) == i );
+        CHECK( e.at(big - unsigned(i)) == -i );
+    }
+    CHECK( e.lower_bound(1000u)->first == big - 99 );
+    CHECK( e.upper_bound(big) == e.end() );
+}
+
+TEST_CASE( "B-tree works with string->string", "[fixed_eytzinger_btree_map]" )
+{
+    std::vector< std::pair<std::string, std::string> > d;
+    for( int i = 0; i < 1000; ++i )
+        d.emplace_back( std::to_string(i), std::to_string(i * 2) );
+    fixed_eytzinger_btree_map<std::string, std::string> e{ std::begin(d), std::end(d) };
+    CHECK( e.size() == d.size() );
+    for( int i = 0; i < 1000; ++i ) {
+        REQUIRE( e.find(std::to_string(i)) != e.end() );
+        CHECK( e[std::to_string(i)] == std::to_string(i * 2) );
+    }
+    CHECK( e.find("abc") == e.end() );
+    CHECK_THROWS_AS( e.at("abc"), std::out_of_range );
+    CHECK( e.lower_bound("10")->first == "10" );
+    CHECK( e.upper_bound("10")->first == "100" );
+}
+
+TEST_CASE( "B-tree supports copy, move and comparison", "[fixed_eytzinger_btree_map]" )
+{
+    fixed_eytzinger_btree_map<int, std::string> e1{ {5, "5"}, {1, "1"}, {3, "3"}, {1, "one"} };
+    CHECK( e1.size() == 3 );
+    auto e2 = e1;
+    CHECK( e1 == e2 );
+    auto e3 = std::move(e2);
+    CHECK( e2.empty() );
+    CHECK( e1 == e3 );
+    CHECK( e1 != e2 );
+    e2 = { {7, "7"} };
+    std::swap( e2, e3 );
+    CHECK( e2 == e1 );
+    CHECK( e3.at(7) == "7" );
+    e3.clear();
+    CHECK( e3.empty() );
+    CHECK( e3.find(7) == e3.end() );
+}
+
+TEST_CASE( "B-tree supports move-only values", "[fixed_eytzinger_btree_map]" )
+{
+    std::vector< std::pair<int, std::unique_ptr<int>> > d;
+    for( int i = 0; i < 100; ++i )
+        d.emplace_back( i, std::unique_ptr<int>(new int(i)) );
+    fixed_eytzinger_btree_map<int, std::unique_ptr<int>> e{ std::make_move_iterator(std::begin(d)),
+                                                             std::make_move_iterator(std::end(d)) };
+    for( int i = 0; i < 100; ++i )
+        CHECK( *e.at(i) == i );
+}
+
+#if __cplusplus >= 201402L
+TEST_CASE( "B-tree supports heterogeneous lookup", "[fixed_eytzinger_btree_map]" )
+{
+    struct Less {
+        using is_transparent = void;
+        bool operator()(const std::string &_1, const std::string &_2) const { return _1 < _2; }
+        bool operator()(const std::string &_1, const char *_2) const { return _1 < _2; }
+        bool operator()(const char *_1, const std::string &_2) const { return _1 < _2; }
+    };
+    fixed_eytzinger_btree_map<std::string, int, Less> e{ {"a", 1}, {"b", 2}, {"c", 3}, {"d", 4} };
+    CHECK( e.count("b") == 1 );
+    CHECK( e.count("e") == 0 );
+    CHECK( e.at("c") == 3 );
+    CHECK( e["d"] == 4 );
+    CHECK( e.lower_bound("bb")->first == "c" );
+    CHECK( e.upper_bound("c")->first == "d" );
+    CHECK( e.equal_range("a").first->second == 1 );
+}
+#endif
@@ -0,0 +1,138 @@
+#include <catch.hpp>
+#include <fixed_eytzinger_layout_map.h>
+#include <map>
+#include <string>
+#include <vector>
+
+template <typename L>
+static bool SameLookups( const L &l, const std::map<int, std::string> &m, int max_key )
+{
+    if( l.size() != m.size() || l.empty() != m.empty() )
+        return false;
+    for( int k = -1; k <= max_key; ++k ) {
+        const auto lb = m.lower_bound( k ), ub = m.upper_bound( k );
+        const auto llb = l.lower_bound( k ), lub = l.upper_bound( k );
+        if( (lb == m.end()) != (llb == l.end()) || (lb != m.end() && llb->first != lb->first) )
+            return false;
+        if( (ub == m.end()) != (lub == l.end()) || (ub != m.end() && lub->first != ub->first) )
+            return false;
+        if( l.count(k) != m.count(k) || (l.find(k) == l.end()) != (m.find(k) == m.end()) )
+            return false;
+        if( m.count(k) && (l.at(k) != m.at(k) || l[k] != m.at(k) || l.find(k)->second != m.at(k)) )
+            return false;
+    }
+    return true;
+}
+
+template <typename L>
+static void CheckLayout( size_t expected_split )
+{
+    for( int n: {0, 1, 2, 3, 7, 8, 100, 1000, 5000} ) {
+        std::map<int, std::string> m;
+        for( int i = 0; i < n; ++i )
+            m.emplace( i * 3, std::to_string(i) );
+        const L l{ m.begin(), m.end() };
+        CHECK( SameLookups(l, m, 3 * n) );
+        CHECK( l.split_size() == std::min<size_t>(expected_split, n) );
+        
+        const fixed_eytzinger_map<int, std::string> e{ m.begin(), m.end() };
+        auto i = l.begin();
+        for( auto j: e ) {
+            CHECK( i->first == j.first );
+            CHECK( (*i).second == j.second );
+            ++i;
+        }
+        CHECK( i == l.end() );
+        CHECK( std::distance(l.cbegin(), l.cend()) == n );
+        
+        L copy = l;
+        CHECK( SameLookups(copy, m, 3 * n) );
+        L moved = std::move( copy );
+        CHECK( SameLookups(moved, m, 3 * n) );
+        CHECK( copy.empty() );
+        L assigned;
+        assigned = moved;
+        moved = L();
+        CHECK( SameLookups(assigned, m, 3 * n) );
+        
+        if( n > 1 ) {
+            L mutable_l{ fixed_eytzinger_sorted_unique, m.begin(), m.end() };
+            mutable_l.at( 0 ) = "changed";
+            mutable_l[3 * (n - 1)] += "!";
+            CHECK( mutable_l.at(0) == "changed" );
+            CHECK( mutable_l.at(3 * (n - 1)) == m.at(3 * (n - 1)) + "!" );
+            CHECK_THROWS_AS( mutable_l.at(1), std::out_of_range );
+            CHECK_THROWS_AS( mutable_l[-1], std::out_of_range );
+        }
+    }
+}
+
+TEST_CASE( "Layout maps agree with std::map", "[fixed_eytzinger_layout_map]" )
+{
+    CheckLayout< fixed_eytzinger_layout_map<int, std::string> >( size_t(-1) );
+    CheckLayout< fixed_eytzinger_layout_map<int, std::string,
+                                            fixed_eytzinger_interleaved_layout> >( 0 );
+    CheckLayout< fixed_eytzinger_layout_map<int, std::string,
+                                            fixed_eytzinger_hybrid_layout<3>> >( 7 );
+    CheckLayout< fixed_eytzinger_layout_map<int, std::string,
+                                            fixed_eytzinger_hybrid_layout<>> >( 65535 );
+}
+
+TEST_CASE( "Layout maps take over a map", "[fixed_eytzinger_layout_map]" )
+{
+    typedef fixed_eytzinger_layout_map<int, int, fixed_eytzinger_hybrid_layout<2>,
+                                       std::greater<int>> L;
+    L l{ L::base_type{ {1, 10}, {2, 20}, {3, 30}, {4, 40}, {5, 50} } };
+    CHECK( l.split_size() == 3 );
+    CHECK( l.lower_bound(10)->first == 5 );
+    CHECK( l.upper_bound(3)->first == 2 );
+    CHECK( l.lower_bound(0) == l.end() );
+    CHECK( std::distance(l.equal_range(4).first, l.equal_range(4).second) == 1 );
+    CHECK( std::distance(l.equal_range(6).first, l.equal_range(6).second) == 0 );
+    CHECK( l.key_comp()(2, 1) );
+    
+    L other{ {7, 70} };
+    std::swap( l, other );
+    CHECK( l.size() == 1 );
+    CHECK( other.at(1) == 10 );
+    std::vector< std::pair<int, int> > ascending{ {1, 10}, {2, 20} };
+    CHECK_THROWS_AS( (L{ fixed_eytzinger_sorted_unique, ascending.begin(), ascending.end() }),
+                     std::invalid_argument );
+}
+
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+TEST_CASE( "Layout maps follow the allocator propagation traits",
+           "[fixed_eytzinger_layout_map]" )
+{
+    typedef std::pmr::polymorphic_allocator< std::pair<int, std::string> > A;
+    typedef fixed_eytzinger_layout_map<int, std::string, fixed_eytzinger_hybrid_layout<2>,
+                                       std::less<int>, A> L;
+    std::pmr::monotonic_buffer_resource arena;
+    std::vector< std::pair<int, std::string> > d;
+    for( int i = 0; i < 100; ++i )
+        d.emplace_back( i, std::to_string(i) );
+    
+    L a{ d.begin(), d.end() };
+    L b{ { {1, "1"} }, std::less<int>(), A(&arena) };
+    b = std::move(a);
+    CHECK( a.empty() );
+    CHECK( b.size() == 100 );
+    CHECK( b.at(42) == "42" );
+    CHECK( b.get_allocator().resource() == &arena );
+    
+    L c{ { {1, "1"} }, std::less<int>(), A(&arena) };
+    c = b;
+    CHECK( c.size() == 100 );
+    CHECK( c.get_allocator().resource() == &arena );
+    
+    L e{ { {7, "7"} }, std::less<int>(), A(&arena) };
+    e.swap( c );
+    CHECK( e.size() == 100 );
+    CHECK( c.at(7) == "7" );
+    CHECK( e.get_allocator().resource() == &arena );
+    
+    L f( b );
+    CHECK( f.get_allocator().resource() == std::pmr::get_default_resource() );
+    CHECK( f.at(99) == "99" );
+}
+#endif
@@ -0,0 +1,107 @@
+#include <catch.hpp>
+#include <fixed_eytzinger_learned_map.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <random>
+#include <vector>
+
+template <typename K>
+static void CheckAgainstMap( const std::vector<K> &keys, const std::vector<K> &lookups,
+                             size_t segment_size, size_t max_segments )
+{
+    std::map<K, int> m;
+    for( size_t i = 0; i < keys.size(); ++i )
+        m.emplace( keys[i], (int)i );
+    typedef fixed_eytzinger_learned_map<K, int> L;
+    const L l{ typename L::base_type(m.begin(), m.end()), segment_size, max_segments };
+    REQUIRE( l.size() == m.size() );
+    CHECK( l.segments() >= 1 );
+    CHECK( l.segments() <= std::max<size_t>(max_segments, 1) );
+    
+    bool same = true;
+    for( K k: lookups ) {
+        const auto lb = m.lower_bound( k ), ub = m.upper_bound( k );
+        const auto llb = l.lower_bound( k ), lub = l.upper_bound( k );
+        same = same && (lb == m.end() ? llb == l.end() : llb != l.end() && llb->first == lb->first);
+        same = same && (ub == m.end() ? lub == l.end() : lub != l.end() && lub->first == ub->first);
+        same = same && l.count( k ) == m.count( k );
+        same = same && (l.find(k) == l.end()) == (m.find(k) == m.end());
+    }
+    CHECK( same );
+}
+
+TEST_CASE( "Learned lookups agree with std::map", "[fixed_eytzinger_learned_map]" )
+{
+    std::mt19937_64 rnd( 11 );
+    for( size_t n: {0, 1, 2, 3, 10, 100, 1000, 20000} ) {
+        std::vector<long long> ids, clustered, lookups;
+        for( size_t i = 0; i < n; ++i ) {
+            ids.emplace_back( 1000 + 3 * (long long)i );
+            clustered.emplace_back( i % 10 == 0 ? (long long)(rnd() >> 2) :
+                                                  (long long)(rnd() % 100) );
+        }
+        for( long long k = -5; k < 1010 + 3 * (long long)n; ++k )
+            lookups.emplace_back( k );
+        for( int i = 0; i < 1000; ++i )
+            lookups.emplace_back( (long long)rnd() );
+        lookups.emplace_back( std::numeric_limits<long long>::min() );
+        lookups.emplace_back( std::numeric_limits<long long>::max() );
+        for( size_t segment_size: {1, 8, 100} ) {
+            CheckAgainstMap( ids, lookups, segment_size, 65536 );
+            CheckAgainstMap( clustered, lookups, segment_size, 65536 );
+        }
+        CheckAgainstMap( ids, lookups, 1, 7 );
+        CheckAgainstMap( ids, lookups, 1, 0 );
+        
+        std::vector<double> reals, real_lookups;
+        std::lognormal_distribution<double> lognormal( 0., 3. );
+        for( size_t i = 0; i < n; ++i )
+            reals.emplace_back( i % 2 ? lognormal(rnd) : -lognormal(rnd) );
+        for( double k: reals ) {
+            real_lookups.emplace_back( k );
+            real_lookups.emplace_back( std::nextafter(k, 1e300) );
+            real_lookups.emplace_back( std::nextafter(k, -1e300) );
+        }
+        real_lookups.emplace_back( -std::numeric_limits<double>::infinity() );
+        real_lookups.emplace_back( std::numeric_limits<double>::infinity() );
+        CheckAgainstMap( reals, real_lookups, 4, 65536 );
+        
+        std::vector<uint64_t> wide, wide_lookups;
+        for( size_t i = 0; i < n; ++i )
+            wide.emplace_back( std::numeric_limits<uint64_t>::max() - i * 1000 );
+        for( uint64_t k: wide )
+            for( uint64_t d: {0, 1, 999} )
+                wide_lookups.emplace_back( k - d );
+        wide_lookups.emplace_back( 0 );
+        CheckAgainstMap( wide, wide_lookups, 2, 65536 );
+    }
+}
+
+TEST_CASE( "Learned map has the const interface of the map", "[fixed_eytzinger_learned_map]" )
+{
+    typedef fixed_eytzinger_learned_map<int, int> L;
+    L l{ L::base_type{ {10, 1}, {20, 2}, {30, 3}, {40, 4} } };
+    CHECK( l.at(20) == 2 );
+    CHECK_THROWS_AS( l.at(25), std::out_of_range );
+    CHECK( l.find(30)->second == 3 );
+    CHECK( std::distance(l.equal_range(40).first, l.equal_range(40).second) == 1 );
+    CHECK( std::distance(l.equal_range(41).first, l.equal_range(41).second) == 0 );
+    CHECK( std::distance(l.range(15, 35).begin(), l.range(15, 35).end()) == 2 );
+    CHECK( l.range(35, 15).empty() );
+    CHECK( std::distance(l.begin(), l.end()) == 4 );
+    CHECK( (*l.ordered_begin()).first == 10 );
+    CHECK( std::distance(l.ordered_begin(), l.ordered_end()) == 4 );
+    CHECK( l.base().size() == 4 );
+    CHECK( l.key_comp()(1, 2) );
+    
+    L copy = l;
+    CHECK( copy.at(10) == 1 );
+    L moved = std::move( copy );
+    CHECK( moved.at(40) == 4 );
+    const L empty;
+    CHECK( empty.empty() );
+    CHECK( empty.find(1) == empty.end() );
+    CHECK( empty.lower_bound(1) == empty.end() );
+}
@@ -15,6 +15,8 @@
 #include <random>
 #include <boost/container/flat_map.hpp>
 #include <fixed_eytzinger_map.h>
+#include <fixed_eytzinger_btree_map.h>
+#include <fixed_eytzinger_layout_map.h>
 
 using namespace std;
 using namespace std::chrono;
@@ -89,7 +91,8 @@ void test_lookup()
         ";" << "std::map<int,int>" <<
         ";" << "std::unordered_map<int,int>" <<
         ";" << "boost::flat_map<int,int>" <<
-        ";" << "fixed_eytzinger_map<int,int>" << endl;
+        ";" << "fixed_eytzinger_map<int,int>" <<
+        ";" << "fixed_eytzinger_btree_map<int,int>" << endl;
     
     const int n1 = 1000, n2 = 10000000, d = 200;
     const double dp = 1.2;
@@ -117,6 +120,12 @@ void test_lookup()
         {
             auto m4 = spawn<fixed_eytzinger_map<int, int>>(n);
             auto t = measure_time( [&]{ return lookup(m4, n); });
+            cout << double(t.count()) / n / 1E3  << ";";
+        }
+        
+        {
+            auto m5 = spawn<fixed_eytzinger_btree_map<int, int>>(n);
+            auto t = measure_time( [&]{ return lookup(m5, n); });
             cout << double(t.count()) / n / 1E3  << endl;
         }
     }
@@ -140,7 +149,8 @@ void test_lookup_and_fetch()
         ";" << "std::map<int,int>" <<
         ";" << "std::unordered_map<int,int>" <<
         ";" << "boost::flat_map<int,int>" <<
-        ";" << "fixed_eytzinger_map<int,int>" << endl;
+        ";" << "fixed_eytzinger_map<int,int>" <<
+        ";" << "fixed_eytzinger_btree_map<int,int>" << endl;
     
     const int n1 = 1000, n2 = 10000000, d = 200;
     const double dp = 1.2;
@@ -168,6 +178,170 @@ void test_lookup_and_fetch()
         {
             auto m4 = spawn<fixed_eytzinger_map<int, int>>(n);
             auto t = measure_time( [&]{ return lookup_and_fetch(m4, n); });
+            cout << double(t.count()) / n / 1E3  << ";";
+        }
+        
+        {
+            auto m5 = spawn<fixed_eytzinger_btree_map<int, int>>(n);
+            auto t = measure_time( [&]{ return lookup_and_fetch(m5, n); });
+            cout << double(t.count()) / n / 1E3  << endl;
+        }
+    }
+}
+
+void test_layouts()
+{
+    cout << "lookup and lookup and fetch times by layout, us per element" << endl;
+    cout << "n" <<
+        ";" << "split count" <<
+        ";" << "interleaved count" <<
+        ";" << "hybrid count" <<
+        ";" << "split at" <<
+        ";" << "interleaved at" <<
+        ";" << "hybrid at" << endl;
+    
+    typedef fixed_eytzinger_layout_map<int, int, fixed_eytzinger_split_layout> split_map;
+    typedef fixed_eytzinger_layout_map<int, int, fixed_eytzinger_interleaved_layout> inter_map;
+    typedef fixed_eytzinger_layout_map<int, int, fixed_eytzinger_hybrid_layout<>> hybrid_map;
+    
+    const int n1 = 1000, n2 = 10000000, d = 200;
+    const double dp = 1.2;
+    
+    for( int n = n1, dn = d; n <= n2; n += dn, dn *= dp ) {
+        cout << n << ";";
+        auto m1 = spawn<split_map>(n);
+        auto m2 = spawn<inter_map>(n);
+        auto m3 = spawn<hybrid_map>(n);
+        {
+            auto t = measure_time( [&]{ return lookup(m1, n); });
+            cout << double(t.count()) / n / 1E3  << ";";
+        }
+        
+        {
+            auto t = measure_time( [&]{ return lookup(m2, n); });
+            cout << double(t.count()) / n / 1E3  << ";";
+        }
+        
+        {
+            auto t = measure_time( [&]{ return lookup(m3, n); });
+            cout << double(t.count()) / n / 1E3  << ";";
+        }
+        
+        {
+            auto t = measure_time( [&]{ return lookup_and_fetch(m1, n); });
+            cout << double(t.count()) / n / 1E3  << ";";
+        }
+        
+        {
+            auto t = measure_time( [&]{ return lookup_and_fetch(m2, n); });
+            cout << double(t.count()) / n / 1E3  << ";";
+        }
+        
+        {
+            auto t = measure_time( [&]{ return lookup_and_fetch(m3, n); });
+            cout << double(t.count()) / n / 1E3  << endl;
+        }
+    }
+}
+
+// Orders ints as std::less does, but isn't std::less, so small maps with it are descended rather
+// than scanned.
+struct descent_less
+{
+    bool operator()(int _a, int _b) const noexcept { return _a < _b; }
+};
+
+// Keys for lookups in small maps are drawn beforehand, drawing one takes longer than the lookup.
+vector<int> small_lookup_keys(int _n)
+{
+    rand_seq rnd(2 * _n);
+    vector<int> keys(100000);
+    for( auto &k: keys )
+        k = rnd();
+    return keys;
+}
+
+template <typename C>
+auto lookup_small(const C&_c, const vector<int> &_keys)
+{
+    uint64_t sum = 0;
+    for( auto k: _keys )
+        sum += _c.count( k );
+    return sum;
+}
+
+void test_small_lookup()
+{
+    cout << "small maps lookup times, us per element" << endl;
+    cout << "n" <<
+        ";" << "std::map<int,int>" <<
+        ";" << "boost::flat_map<int,int>" <<
+        ";" << "fixed_eytzinger_map<int,int>" <<
+        ";" << "fixed_eytzinger_map<int,int> without scan" << endl;
+    
+    const int n1 = 1, n2 = 128;
+    
+    for( int n = n1; n <= n2; n += n < 32 ? 1 : 8 ) {
+        cout << n << ";";
+        const auto keys = small_lookup_keys(n);
+        {
+            auto m1 = spawn<map<int, int>>(n);
+            auto t = measure_time( [&]{ return lookup_small(m1, keys); });
+            cout << double(t.count()) / keys.size() / 1E3  << ";";
+        }
+        
+        {
+            auto m2 = spawn<boost::container::flat_map<int, int>>(n);
+            auto t = measure_time( [&]{ return lookup_small(m2, keys); });
+            cout << double(t.count()) / keys.size() / 1E3  << ";";
+        }
+        
+        {
+            auto m3 = spawn<fixed_eytzinger_map<int, int>>(n);
+            auto t = measure_time( [&]{ return lookup_small(m3, keys); });
+            cout << double(t.count()) / keys.size() / 1E3  << ";";
+        }
+        
+        {
+            auto m4 = spawn<fixed_eytzinger_map<int, int, descent_less>>(n);
+            auto t = measure_time( [&]{ return lookup_small(m4, keys); });
+            cout << double(t.count()) / keys.size() / 1E3  << endl;
+        }
+    }
+}
+
+template <typename C>
+auto lookup_batch(const C&_c, int _n)
+{
+    rand_seq rnd(_n);
+    vector<int> keys(_n);
+    vector<size_t> counts(_n);
+    generate( begin(keys), end(keys), [&]{ return rnd(); } );
+    
+    _c.count_batch( begin(keys), end(keys), begin(counts) );
+    return accumulate( begin(counts), end(counts), uint64_t(0) );
+}
+
+void test_batch_lookup()
+{
+    cout << "batch lookup times, us per element" << endl;
+    cout << "n" <<
+        ";" << "fixed_eytzinger_map<int,int>::count" <<
+        ";" << "fixed_eytzinger_map<int,int>::count_batch" << endl;
+    
+    const int n1 = 1000, n2 = 10000000, d = 200;
+    const double dp = 1.2;
+    
+    for( int n = n1, dn = d; n <= n2; n += dn, dn *= dp ) {
+        cout << n << ";";
+        auto m = spawn<fixed_eytzinger_map<int, int>>(n);
+        {
+            auto t = measure_time( [&]{ return lookup(m, n); });
+            cout << double(t.count()) / n / 1E3  << ";";
+        }
+        
+        {
+            auto t = measure_time( [&]{ return lookup_batch(m, n); });
             cout << double(t.count()) / n / 1E3  << endl;
         }
     }
@@ -180,6 +354,48 @@ vector< pair<int, int> > spawn_test_data(int _n)
     return d;
 }
 
+void test_ordered_scan()
+{
+    cout << "in-order scan times, ns per element" << endl;
+    cout << "n" <<
+        ";" << "std::map<int,int>" <<
+        ";" << "boost::flat_map<int,int>" <<
+        ";" << "fixed_eytzinger_map<int,int>" << endl;
+    
+    const int n1 = 1000, n2 = 10000000, d = 200;
+    const double dp = 1.2;
+    
+    for( int n = n1, dn = d; n <= n2; n += dn, dn *= dp ) {
+        cout << n << ";";
+        {
+            auto c = spawn< map<int, int> >(n);
+            auto t = measure_time( [&]{
+                return accumulate( c.begin(), c.end(), uint64_t(0),
+                                   [](uint64_t s, const auto &i){ return s + i.second; } );
+            });
+            cout << double(t.count()) / n  << ";";
+        }
+        
+        {
+            auto c = spawn< boost::container::flat_map<int, int> >(n);
+            auto t = measure_time( [&]{
+                return accumulate( c.begin(), c.end(), uint64_t(0),
+                                   [](uint64_t s, const auto &i){ return s + i.second; } );
+            });
+            cout << double(t.count()) / n  << ";";
+        }
+        
+        {
+            auto c = spawn< fixed_eytzinger_map<int, int> >(n);
+            auto t = measure_time( [&]{
+                return accumulate( c.ordered_begin(), c.ordered_end(), uint64_t(0),
+                                   [](uint64_t s, const auto &i){ return s + i.second; } );
+            });
+            cout << double(t.count()) / n  << endl;
+        }
+    }
+}
+
 void test_building()
 {
     cout << "build&destroy times, us per element" << endl;
@@ -187,7 +403,9 @@ void test_building()
         ";" << "std::map<int,int>" <<
         ";" << "std::unordered_map<int,int>" <<
         ";" << "boost::flat_map<int,int>" <<
-        ";" << "fixed_eytzinger_map<int,int>" << endl;
+        ";" << "fixed_eytzinger_map<int,int>" <<
+        ";" << "fixed_eytzinger_btree_map<int,int>" <<
+        ";" << "fixed_eytzinger_map<int,int> (parallel)" << endl;
     
     const int n1 = 1000, n2 = 10000000, d = 200;
     const double dp = 1.2;
@@ -223,6 +441,23 @@ void test_building()
             auto t = measure_time( [&]{
                 return fixed_eytzinger_map<int, int>{ begin(d), end(d) }.count(n);
             });
+            cout << double(t.count()) / n / 1E3  << ";";
+        }
+        
+        {
+            auto d = spawn_test_data(n);
+            auto t = measure_time( [&]{
+                return fixed_eytzinger_btree_map<int, int>{ begin(d), end(d) }.count(n);
+            });
+            cout << double(t.count()) / n / 1E3  << ";";
+        }
+        
+        {
+            auto d = spawn_test_data(n);
+            auto t = measure_time( [&]{
+                return fixed_eytzinger_map<int, int>{ fixed_eytzinger_parallel(),
+                                                      begin(d), end(d) }.count(n);
+            });
             cout << double(t.count()) / n / 1E3  << endl;
         }
     }
@@ -321,6 +556,18 @@ int main(int argc, const char * argv[])
     test_lookup_and_fetch();
     cout << endl;
 
+    test_small_lookup();
+    cout << endl;
+
+    test_layouts();
+    cout << endl;
+
+    test_batch_lookup();
+    cout << endl;
+
+    test_ordered_scan();
+    cout << endl;
+
     test_building();
     cout << endl;
 
@@ -5,6 +5,9 @@
 #include <exception>
 #include <algorithm>
 #include <numeric>
+#include <map>
+#include <iterator>
+#include <random>
 #include <fixed_eytzinger_map.h>
 
 TEST_CASE( "Works with int->int", "[fixed_eytzinger_map]" )
@@ -276,3 +279,729 @@ TEST_CASE( "Supports heteregenous comparators for non-comparable types", "[fixed
     CHECK( map[4l] == 4 );
 }
 #endif
+
+TEST_CASE( "Lookup agrees with binary search over a sorted array", "[fixed_eytzinger_map]" )
+{
+    for( int n = 0; n < 130; ++n ) {
+        std::vector< std::pair<int, int> > d;
+        std::vector<int> sorted;
+        for( int i = 0; i < n; ++i ) {
+            d.emplace_back( 2*i, i );
+            sorted.emplace_back( 2*i );
+        }
+        const fixed_eytzinger_map<int, int> e{ std::begin(d), std::end(d) };
+        
+        for( int k = -2; k <= 2*n + 1; ++k ) {
+            auto lb = std::lower_bound( std::begin(sorted), std::end(sorted), k );
+            if( lb == std::end(sorted) )
+                CHECK( e.lower_bound(k) == e.end() );
+            else
+                CHECK( e.lower_bound(k)->first == *lb );
+            
+            auto ub = std::upper_bound( std::begin(sorted), std::end(sorted), k );
+            if( ub == std::end(sorted) )
+                CHECK( e.upper_bound(k) == e.end() );
+            else
+                CHECK( e.upper_bound(k)->first == *ub );
+            
+            CHECK( e.count(k) == size_t(k >= 0 && k < 2*n && k % 2 == 0) );
+        }
+    }
+}
+
+struct PD_Key {
+    short v;
+    bool operator<(const PD_Key &_rhs) const noexcept { return v < _rhs.v; }
+};
+template <>
+struct fixed_eytzinger_prefetch_distance<PD_Key>
+{
+    static const unsigned value = 6;
+};
+TEST_CASE( "Supports a custom prefetch distance", "[fixed_eytzinger_map]" )
+{
+    std::vector< std::pair<PD_Key, int> > d;
+    int n = 1000;
+    for( int i = 0; i < n; ++i )
+        d.emplace_back( PD_Key{short(2*i)}, i );
+    fixed_eytzinger_map<PD_Key, int> e{ std::begin(d), std::end(d) };
+    
+    for( int i = 0; i < n; ++i ) {
+        CHECK( e.at(PD_Key{short(2*i)}) == i );
+        CHECK( e.lower_bound(PD_Key{short(2*i-1)})->second == i );
+        CHECK( e.count(PD_Key{short(2*i+1)}) == 0 );
+    }
+}
+
+TEST_CASE( "Aligns groups of siblings to cache lines", "[fixed_eytzinger_map]" )
+{
+    for( int n: {1, 2, 17, 1000} ) {
+        std::vector< std::pair<int, double> > d;
+        for( int i = 0; i < n; ++i )
+            d.emplace_back( i, i );
+        fixed_eytzinger_map<int, double> e1{ std::begin(d), std::end(d) };
+        CHECK( (uintptr_t)(&e1.begin()->first - 1) % 64 == 0 );
+        CHECK( (uintptr_t)(&e1.begin()->second) % 64 == 0 );
+        
+        fixed_eytzinger_map<int, double> e2 = e1;
+        CHECK( (uintptr_t)(&e2.begin()->first - 1) % 64 == 0 );
+        CHECK( e1 == e2 );
+    }
+}
+
+template <typename T>
+struct CountingAllocator
+{
+    typedef T value_type;
+    CountingAllocator( int *_counter ) noexcept : counter(_counter) {}
+    template <typename U>
+    CountingAllocator( const CountingAllocator<U> &_other ) noexcept : counter(_other.counter) {}
+    T *allocate( size_t _n )
+    {
+        ++*counter;
+        return static_cast<T*>( ::operator new(_n * sizeof(T)) );
+    }
+    void deallocate( T *_p, size_t ) noexcept
+    {
+        --*counter;
+        ::operator delete(_p);
+    }
+    template <typename U>
+    bool operator==( const CountingAllocator<U> &_rhs ) const noexcept
+    { return counter == _rhs.counter; }
+    template <typename U>
+    bool operator!=( const CountingAllocator<U> &_rhs ) const noexcept
+    { return counter != _rhs.counter; }
+    int *counter;
+};
+
+TEST_CASE( "Supports custom allocators", "[fixed_eytzinger_map]" )
+{
+    typedef CountingAllocator<std::pair<int, std::string>> A;
+    typedef fixed_eytzinger_map<int, std::string, std::less<int>, A> M;
+    int c1 = 0, c2 = 0;
+    {
+        std::vector< std::pair<int, std::string> > d;
+        for( int i = 0; i < 100; ++i )
+            d.emplace_back( i, std::to_string(i) );
+        M m1{ std::begin(d), std::end(d), A(&c1) };
+        CHECK( c1 == 2 );
+        CHECK( m1.get_allocator() == A(&c1) );
+        
+        M m2{ m1 };
+        CHECK( c1 == 4 );
+        CHECK( m1 == m2 );
+        
+        M m3{ m1, A(&c2) };
+        CHECK( c1 == 4 );
+        CHECK( c2 == 2 );
+        CHECK( m1 == m3 );
+        
+        M m4{ std::move(m3), A(&c1) };
+        CHECK( c1 == 6 );
+        CHECK( c2 == 0 );
+        CHECK( m3.empty() );
+        CHECK( m4 == m1 );
+        
+        M m5{ A(&c2) };
+        m5 = std::move(m4);
+        CHECK( c1 == 4 );
+        CHECK( c2 == 2 );
+        CHECK( m5.get_allocator() == A(&c2) );
+        CHECK( m5 == m1 );
+        
+        m5 = { {1, "1"}, {2, "2"} };
+        CHECK( c2 == 2 );
+        CHECK( m5.at(2) == "2" );
+    }
+    CHECK( c1 == 0 );
+    CHECK( c2 == 0 );
+}
+
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+TEST_CASE( "Supports polymorphic allocators", "[fixed_eytzinger_map]" )
+{
+    char buffer[16384];
+    std::pmr::monotonic_buffer_resource arena{ buffer, sizeof(buffer),
+                                               std::pmr::null_memory_resource() };
+    std::vector< std::pair<int, int> > d;
+    for( int i = 0; i < 100; ++i )
+        d.emplace_back( 99 - i, i );
+    fixed_eytzinger_pmr_map<int, int> m{ std::begin(d), std::end(d), &arena };
+    CHECK( m.get_allocator().resource() == &arena );
+    for( int i = 0; i < 100; ++i )
+        CHECK( m.at(99 - i) == i );
+    CHECK( (uintptr_t)(&m.begin()->first - 1) % 64 == 0 );
+    
+    fixed_eytzinger_pmr_map<int, int> m2 = m;
+    CHECK( m2.get_allocator().resource() == std::pmr::get_default_resource() );
+    m2 = m;
+    m2 = std::move(m);
+    CHECK( m.empty() );
+    CHECK( m2.size() == 100 );
+    CHECK( m2.get_allocator().resource() == std::pmr::get_default_resource() );
+}
+
+TEST_CASE( "Moves to an exhausted memory resource throw", "[fixed_eytzinger_map]" )
+{
+    char buffer[1024];
+    std::pmr::monotonic_buffer_resource arena{ buffer, sizeof(buffer),
+                                               std::pmr::null_memory_resource() };
+    std::vector< std::pair<int, int> > d;
+    for( int i = 0; i < 1000; ++i )
+        d.emplace_back( i, i );
+    fixed_eytzinger_pmr_map<int, int> m{ std::begin(d), std::end(d) };
+    fixed_eytzinger_pmr_map<int, int> m2{ {{1, 1}}, &arena };
+
+    CHECK_THROWS_AS( m2 = std::move(m), std::bad_alloc );
+    CHECK( m.size() == 1000 );
+    CHECK( m2.size() == 1 );
+    CHECK( m2.at(1) == 1 );
+
+    typedef fixed_eytzinger_pmr_map<int, int> M;
+    CHECK_THROWS_AS( M(std::move(m), &arena), std::bad_alloc );
+    CHECK( m.size() == 1000 );
+}
+#endif
+
+struct ThrowingValue
+{
+    static int alive, copies_left;
+    ThrowingValue() { ++alive; }
+    ThrowingValue( const ThrowingValue& ) {
+        if( copies_left-- == 0 )
+            throw std::runtime_error("copy");
+        ++alive;
+    }
+    ThrowingValue( ThrowingValue&& ) noexcept { ++alive; }
+    ~ThrowingValue() { --alive; }
+};
+int ThrowingValue::alive = 0;
+int ThrowingValue::copies_left = 0;
+
+template <typename T>
+struct InputIterator
+{
+    typedef std::input_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const T* pointer;
+    typedef const T& reference;
+    const T& operator*() const { return *p; }
+    InputIterator& operator++() { ++p; return *this; }
+    bool operator==( const InputIterator &_rhs ) const { return p == _rhs.p; }
+    bool operator!=( const InputIterator &_rhs ) const { return p != _rhs.p; }
+    const T *p;
+};
+
+TEST_CASE( "Builds from sorted unique input in linear time", "[fixed_eytzinger_map]" )
+{
+    SECTION( "same layout as with sorting" ) {
+        for( int n = 0; n < 300; ++n ) {
+            std::vector< std::pair<int, int> > d;
+            for( int i = 0; i < n; ++i )
+                d.emplace_back( i * 3, i );
+            fixed_eytzinger_map<int, int> e1{ std::begin(d), std::end(d) };
+            fixed_eytzinger_map<int, int> e2{ fixed_eytzinger_sorted_unique,
+                                              std::begin(d), std::end(d) };
+            REQUIRE( e1 == e2 );
+        }
+    }
+    
+    SECTION( "from other containers" ) {
+        std::map<std::string, int> m;
+        for( int i = 0; i < 1000; ++i )
+            m[std::to_string(i)] = i;
+        fixed_eytzinger_map<std::string, int> e{ fixed_eytzinger_sorted_unique,
+                                                 std::begin(m), std::end(m) };
+        CHECK( e.size() == m.size() );
+        for( auto &i: m )
+            CHECK( e.at(i.first) == i.second );
+        
+        std::vector< std::pair<int, int> > d{ {1, 1}, {2, 2}, {3, 3}, {5, 5}, {8, 8}, {13, 13} };
+        fixed_eytzinger_map<int, int> e2;
+        e2.assign( fixed_eytzinger_sorted_unique,
+                   InputIterator<std::pair<int, int>>{d.data()},
+                   InputIterator<std::pair<int, int>>{d.data() + d.size()} );
+        CHECK( e2.size() == 6 );
+        CHECK( e2.at(13) == 13 );
+        
+        fixed_eytzinger_map<int, int, std::greater<int>> e3{ fixed_eytzinger_sorted_unique,
+            { {3, 0}, {2, 0}, {1, 0} } };
+        CHECK( e3.lower_bound(4)->first == 3 );
+    }
+    
+    SECTION( "rejects unordered input" ) {
+        using M = fixed_eytzinger_map<int, int>;
+        CHECK_THROWS_AS( (M{ fixed_eytzinger_sorted_unique, { {1, 0}, {3, 0}, {2, 0} } }),
+                         std::invalid_argument );
+        CHECK_THROWS_AS( (M{ fixed_eytzinger_sorted_unique, { {1, 0}, {1, 0} } }),
+                         std::invalid_argument );
+        
+        M e{ {1, 1} };
+        std::vector< std::pair<int, int> > d{ {5, 0}, {4, 0} };
+        CHECK_THROWS_AS( e.assign( fixed_eytzinger_sorted_unique, std::begin(d), std::end(d) ),
+                         std::invalid_argument );
+        CHECK( e.at(1) == 1 );
+    }
+    
+    SECTION( "cleans up after exceptions" ) {
+        std::vector< std::pair<int, ThrowingValue> > d( 100 );
+        for( int i = 0; i < 100; ++i )
+            d[i].first = i;
+        for( int k: {0, 1, 50, 99} ) {
+            ThrowingValue::copies_left = k;
+            CHECK_THROWS_AS( (fixed_eytzinger_map<int, ThrowingValue>{
+                fixed_eytzinger_sorted_unique, std::begin(d), std::end(d)}), std::runtime_error );
+            CHECK( ThrowingValue::alive == 100 );
+        }
+        d[60].first = 0;
+        ThrowingValue::copies_left = 1000;
+        CHECK_THROWS_AS( (fixed_eytzinger_map<int, ThrowingValue>{
+            fixed_eytzinger_sorted_unique, std::begin(d), std::end(d)}), std::invalid_argument );
+        CHECK( ThrowingValue::alive == 100 );
+    }
+}
+
+struct CountingValue
+{
+    static int copies;
+    explicit CountingValue( int _v = 0 ) : v(_v) {}
+    CountingValue( const CountingValue& _rhs ) : v(_rhs.v) { ++copies; }
+    CountingValue( CountingValue&& _rhs ) noexcept : v(_rhs.v) {}
+    CountingValue& operator=( const CountingValue& _rhs ) { v = _rhs.v; ++copies; return *this; }
+    CountingValue& operator=( CountingValue&& _rhs ) noexcept { v = _rhs.v; return *this; }
+    int v;
+    char payload[60];
+};
+int CountingValue::copies = 0;
+
+TEST_CASE( "Copies each element at most once", "[fixed_eytzinger_map]" )
+{
+    std::vector< std::pair<int, CountingValue> > d;
+    std::vector< std::pair<std::string, CountingValue> > s;
+    std::map<int, int> expected;
+    for( int i = 0; i < 5000; ++i ) {
+        const int k = (i * 7919) % 3001;
+        d.emplace_back( k, CountingValue{k} );
+        s.emplace_back( std::to_string(k), CountingValue{k} );
+        expected[k] = k;
+    }
+    auto check = [&](const fixed_eytzinger_map<int, CountingValue> &_e) {
+        REQUIRE( _e.size() == expected.size() );
+        for( auto &i: expected )
+            CHECK( _e.at(i.first).v == i.second );
+    };
+    
+    SECTION( "from a range" ) {
+        CountingValue::copies = 0;
+        fixed_eytzinger_map<int, CountingValue> e1{ std::begin(d), std::end(d) };
+        CHECK( CountingValue::copies == (int)expected.size() );
+        check( e1 );
+        
+        CountingValue::copies = 0;
+        fixed_eytzinger_map<std::string, CountingValue> e2{ std::begin(s), std::end(s) };
+        CHECK( CountingValue::copies == (int)expected.size() );
+        CHECK( e2.size() == expected.size() );
+        for( auto &i: expected )
+            CHECK( e2.at(std::to_string(i.first)).v == i.second );
+        
+        std::map<int, CountingValue> m{ std::begin(d), std::end(d) };
+        CountingValue::copies = 0;
+        fixed_eytzinger_map<int, CountingValue> e3{ std::begin(m), std::end(m) };
+        CHECK( CountingValue::copies == (int)expected.size() );
+        check( e3 );
+        
+        CountingValue::copies = 0;
+        fixed_eytzinger_map<int, CountingValue> e4{ std::make_move_iterator(std::begin(d)),
+                                                    std::make_move_iterator(std::end(d)) };
+        CHECK( CountingValue::copies == 0 );
+        check( e4 );
+    }
+    
+    SECTION( "from an rvalue vector" ) {
+        CountingValue::copies = 0;
+        fixed_eytzinger_map<int, CountingValue> e1{ std::move(d) };
+        CHECK( CountingValue::copies == 0 );
+        CHECK( d.empty() );
+        check( e1 );
+        
+        CountingValue::copies = 0;
+        fixed_eytzinger_map<std::string, CountingValue> e2;
+        e2.assign( std::move(s) );
+        CHECK( CountingValue::copies == 0 );
+        CHECK( s.empty() );
+        CHECK( e2.size() == expected.size() );
+        
+        typedef CountingAllocator<std::pair<int, CountingValue>> A;
+        int allocations = 0;
+        std::vector< std::pair<int, CountingValue>, A > v( 10, std::make_pair(1, CountingValue{1}),
+                                                           A{&allocations} );
+        fixed_eytzinger_map<int, CountingValue, std::greater<int>> e3{ std::move(v) };
+        CHECK( allocations == 0 );
+        CHECK( e3.size() == 1 );
+    }
+}
+
+TEST_CASE( "Rebuilds with sorted changes in linear time", "[fixed_eytzinger_map]" )
+{
+    SECTION( "same contents and layout as built from scratch" ) {
+        std::mt19937 rnd( 7 );
+        for( int n: {0, 1, 2, 10, 100, 1000, 5000} ) {
+            std::map<int, int> m;
+            for( int i = 0; i < n; ++i )
+                m[(int)(rnd() % (2 * n + 1))] = i;
+            fixed_eytzinger_map<int, int> e{ fixed_eytzinger_sorted_unique, m.begin(), m.end() };
+            for( int changes: {0, 1, n / 10, n, 3 * n} ) {
+                std::map<int, int> upserts, expected = m;
+                std::vector<int> erased;
+                for( int i = 0; i < changes; ++i ) {
+                    const int k = (int)(rnd() % (2 * n + 3)) - 1;
+                    if( rnd() % 2 )
+                        upserts[k] = -i;
+                    else
+                        erased.emplace_back( k );
+                }
+                std::sort( erased.begin(), erased.end() );
+                for( int k: erased )
+                    expected.erase( k );
+                for( auto &i: upserts )
+                    expected[i.first] = i.second;
+                const fixed_eytzinger_map<int, int> built{ fixed_eytzinger_sorted_unique,
+                                                           expected.begin(), expected.end() };
+                
+                fixed_eytzinger_map<int, int> e1{ e, fixed_eytzinger_sorted_unique,
+                                                  upserts.begin(), upserts.end(),
+                                                  erased.begin(), erased.end() };
+                CHECK( e1 == built );
+                fixed_eytzinger_map<int, int> e2 = e;
+                e2.rebuild( fixed_eytzinger_sorted_unique, upserts.begin(), upserts.end(),
+                            erased.begin(), erased.end() );
+                CHECK( e2 == built );
+            }
+        }
+    }
+    
+    SECTION( "merges two maps" ) {
+        fixed_eytzinger_map<std::string, int> a{ {"a", 1}, {"c", 3}, {"e", 5} };
+        fixed_eytzinger_map<std::string, int> b{ {"b", 20}, {"c", 30}, {"f", 60} };
+        auto m = fixed_eytzinger_merge( a, b );
+        CHECK( m == (fixed_eytzinger_map<std::string, int>{
+            {"a", 1}, {"b", 20}, {"c", 30}, {"e", 5}, {"f", 60} }) );
+        CHECK( fixed_eytzinger_merge(a, decltype(a)()) == a );
+        CHECK( fixed_eytzinger_merge(decltype(a)(), b) == b );
+        
+        fixed_eytzinger_map<int, int, std::greater<int>> g{ {1, 1}, {3, 3} };
+        std::vector< std::pair<int, int> > d{ {4, 4}, {2, 2} };
+        g.rebuild( fixed_eytzinger_sorted_unique, d.begin(), d.end() );
+        CHECK( g.size() == 4 );
+        CHECK( g.lower_bound(5)->first == 4 );
+    }
+    
+    SECTION( "moves the elements which stay" ) {
+        std::vector< std::pair<int, CountingValue> > d, u;
+        for( int i = 0; i < 1000; ++i )
+            d.emplace_back( i, CountingValue{i} );
+        for( int i = 0; i < 1000; i += 10 )
+            u.emplace_back( i, CountingValue{-i} );
+        fixed_eytzinger_map<int, CountingValue> e{ fixed_eytzinger_sorted_unique,
+                                                   std::begin(d), std::end(d) };
+        CountingValue::copies = 0;
+        e.rebuild( fixed_eytzinger_sorted_unique,
+                   std::make_move_iterator(u.begin()), std::make_move_iterator(u.end()) );
+        CHECK( CountingValue::copies == 0 );
+        CHECK( e.size() == 1000 );
+        CHECK( e.at(10).v == -10 );
+        CHECK( e.at(11).v == 11 );
+    }
+    
+    SECTION( "rejects unordered changes" ) {
+        using M = fixed_eytzinger_map<int, int>;
+        M e{ {1, 1}, {2, 2}, {3, 3} };
+        std::vector< std::pair<int, int> > d{ {5, 0}, {4, 0} };
+        std::vector<int> erased{ 3, 1 }, sorted{ 1, 3 };
+        CHECK_THROWS_AS( e.rebuild( fixed_eytzinger_sorted_unique, std::begin(d), std::end(d) ),
+                         std::invalid_argument );
+        CHECK_THROWS_AS( e.rebuild( fixed_eytzinger_sorted_unique, d.end(), d.end(),
+                                    erased.begin(), erased.end() ),
+                         std::invalid_argument );
+        CHECK_THROWS_AS( (M{ e, fixed_eytzinger_sorted_unique, d.begin(), d.end() }),
+                         std::invalid_argument );
+        CHECK( e == (M{ {1, 1}, {2, 2}, {3, 3} }) );
+        e.rebuild( fixed_eytzinger_sorted_unique, d.end(), d.end(), sorted.begin(), sorted.end() );
+        CHECK( e == (M{ {2, 2} }) );
+    }
+    
+    SECTION( "cleans up after exceptions" ) {
+        std::vector< std::pair<int, ThrowingValue> > d( 100 ), u( 10 );
+        for( int i = 0; i < 100; ++i )
+            d[i].first = i * 2;
+        for( int i = 0; i < 10; ++i )
+            u[i].first = i * 20 + 1;
+        ThrowingValue::copies_left = 1000;
+        fixed_eytzinger_map<int, ThrowingValue> e{ fixed_eytzinger_sorted_unique,
+                                                   std::begin(d), std::end(d) };
+        for( int k: {0, 5, 9} ) {
+            ThrowingValue::copies_left = k;
+            CHECK_THROWS_AS( e.rebuild( fixed_eytzinger_sorted_unique, u.begin(), u.end() ),
+                             std::runtime_error );
+            CHECK( ThrowingValue::alive == 210 );
+            CHECK( e.size() == 100 );
+            CHECK( e.count(40) == 1 );
+        }
+        ThrowingValue::copies_left = 1000;
+        e.rebuild( fixed_eytzinger_sorted_unique, u.begin(), u.end() );
+        CHECK( ThrowingValue::alive == 220 );
+        CHECK( e.size() == 110 );
+    }
+}
+
+struct InlineExecutor
+{
+    size_t concurrency() const noexcept { return 5; }
+    template <typename F>
+    void operator()( size_t _tasks, F _f )
+    {
+        for( size_t i = _tasks; i-- > 0; )
+            _f(i);
+        *runs += _tasks;
+    }
+    size_t *runs;
+};
+
+TEST_CASE( "Builds in parallel", "[fixed_eytzinger_map]" )
+{
+    for( int n: {0, 1, 1000, 100000, 250001} ) {
+        std::vector< std::pair<int, std::string> > d;
+        for( int i = 0; i < n; ++i ) {
+            const int k = (i * 7919) % (n - n / 5 + 1);
+            d.emplace_back( k, std::to_string(k) );
+        }
+        fixed_eytzinger_map<int, std::string> e1{ std::begin(d), std::end(d) };
+        fixed_eytzinger_map<int, std::string> e2{ fixed_eytzinger_parallel(),
+                                                  std::begin(d), std::end(d) };
+        CHECK( e1 == e2 );
+        
+        size_t runs = 0;
+        fixed_eytzinger_map<int, std::string> e3;
+        e3.assign( fixed_eytzinger_parallel( InlineExecutor{&runs} ), std::begin(d), std::end(d) );
+        CHECK( e3 == e2 );
+        CHECK( (runs != 0) == (n >= 100000) );
+    }
+}
+
+template <typename I1, typename I2>
+static bool SameElements( I1 first1, I1 last1, I2 first2, I2 last2 )
+{
+    for( ; first1 != last1 && first2 != last2; ++first1, ++first2 )
+        if( first1->first != first2->first || first1->second != first2->second )
+            return false;
+    return first1 == last1 && first2 == last2;
+}
+
+TEST_CASE( "Iterates in the order of keys", "[fixed_eytzinger_map]" )
+{
+    for( int n = 0; n < 300; ++n ) {
+        std::map<int, int> m;
+        for( int i = 0; i < n; ++i )
+            m[(i * 7919) % 1009] = i;
+        fixed_eytzinger_map<int, int> e{ std::begin(m), std::end(m) };
+        const auto &ce = e;
+        
+        REQUIRE( SameElements(m.begin(), m.end(), e.ordered_begin(), e.ordered_end()) );
+        REQUIRE( SameElements(m.rbegin(), m.rend(), ce.ordered_rbegin(), ce.ordered_rend()) );
+        CHECK( std::distance(ce.ordered_begin(), ce.ordered_end()) == n );
+        CHECK( std::distance(e.ordered_rbegin(), e.ordered_rend()) == n );
+        
+        if( n != 0 ) {
+            auto it = e.ordered_end();
+            CHECK( (--it)->first == m.rbegin()->first );
+            CHECK( (it--)->first == m.rbegin()->first );
+            if( n > 1 )
+                CHECK( it->first == std::next(m.rbegin())->first );
+        }
+        
+        for( int lo = -1; lo < 1011; lo += 37 )
+            for( int hi = lo - 40; hi < 1011; hi += 59 ) {
+                auto r = e.range( lo, hi );
+                if( hi < lo )
+                    CHECK( r.empty() );
+                else
+                    CHECK( SameElements(m.lower_bound(lo), m.lower_bound(hi), r.begin(), r.end()) );
+            }
+    }
+    
+    fixed_eytzinger_map<int, int> e{ {5, 0}, {1, 0}, {3, 0}, {2, 0}, {4, 0} };
+    int v = 0;
+    for( auto i = e.ordered_begin(); i != e.ordered_end(); ++i )
+        i->second = ++v;
+    for( auto i: e.range(2, 5) )
+        i.second *= 10;
+    std::vector< std::pair<int, int> > expected{ {1, 1}, {2, 20}, {3, 30}, {4, 40}, {5, 5} };
+    typedef fixed_eytzinger_map<int, int>::const_ordered_iterator CI;
+    CI first = e.ordered_begin(), last = e.ordered_end();
+    CHECK( SameElements(expected.begin(), expected.end(), first, last) );
+    
+    fixed_eytzinger_map<std::string, int, std::greater<std::string>> g{
+        {"a", 1}, {"b", 2}, {"c", 3}, {"d", 4} };
+    std::vector<std::string> keys;
+    for( auto i: g.range("c", "a") )
+        keys.emplace_back( i.first );
+    CHECK( keys == (std::vector<std::string>{ "c", "b" }) );
+}
+
+#if __cplusplus >= 201402L
+TEST_CASE( "Supports heteregenous ordered ranges", "[fixed_eytzinger_map]" )
+{
+    fixed_eytzinger_map<std::string, int, std::less<>> e{
+        {"apple", 1}, {"banana", 2}, {"cherry", 3}, {"date", 4} };
+    const auto &ce = e;
+    auto r = ce.range( "b", "d" );
+    CHECK( std::distance(r.begin(), r.end()) == 2 );
+    CHECK( r.begin()->second == 2 );
+}
+#endif
+
+TEST_CASE( "Supports batched lookup", "[fixed_eytzinger_map]" )
+{
+    for( int n: {0, 1, 2, 3, 7, 15, 16, 17, 100, 1000} ) {
+        std::vector< std::pair<int, int> > d;
+        for( int i = 0; i < n; ++i )
+            d.emplace_back( 2*i, i );
+        fixed_eytzinger_map<int, int> e{ std::begin(d), std::end(d) };
+        const auto &ce = e;
+        
+        std::vector<int> keys;
+        for( int k = -3; k <= 2*n + 3; ++k )
+            keys.emplace_back( k );
+        
+        std::vector<size_t> counts;
+        ce.count_batch( std::begin(keys), std::end(keys), std::back_inserter(counts) );
+        REQUIRE( counts.size() == keys.size() );
+        
+        std::vector<fixed_eytzinger_map<int, int>::iterator> found(keys.size());
+        CHECK( e.find_batch( std::begin(keys), std::end(keys), std::begin(found) ) ==
+               std::end(found) );
+        
+        std::vector<fixed_eytzinger_map<int, int>::const_iterator> lower(keys.size());
+        ce.lower_bound_batch( std::begin(keys), std::end(keys), std::begin(lower) );
+        
+        for( size_t i = 0; i < keys.size(); ++i ) {
+            CHECK( counts[i] == e.count(keys[i]) );
+            CHECK( found[i] == e.find(keys[i]) );
+            CHECK( lower[i] == ce.lower_bound(keys[i]) );
+        }
+    }
+}
+
+#if __cplusplus >= 201402L
+TEST_CASE( "Supports heteregenous batched lookup", "[fixed_eytzinger_map]" )
+{
+    const fixed_eytzinger_map<std::string, int, std::less<>>
+        a( {{"a", 1}, {"b", 2}, {"c", 3}} );
+    const char *keys[] = {"c", "z", "a", "", "b"};
+    
+    std::vector<size_t> counts;
+    a.count_batch( std::begin(keys), std::end(keys), std::back_inserter(counts) );
+    CHECK( counts == (std::vector<size_t>{1, 0, 1, 0, 1}) );
+    
+    std::vector<decltype(a)::const_iterator> found;
+    a.find_batch( std::begin(keys), std::end(keys), std::back_inserter(found) );
+    REQUIRE( found.size() == 5 );
+    CHECK( found[0]->second == 3 );
+    CHECK( found[1] == a.end() );
+    CHECK( found[2]->second == 1 );
+    CHECK( found[3] == a.end() );
+    CHECK( found[4]->second == 2 );
+}
+#endif
+
+template <typename K>
+static void check_batch_lookup_for_arithmetic_keys( std::vector<K> keys )
+{
+    std::sort( std::begin(keys), std::end(keys) );
+    for( size_t n: {size_t(0), size_t(1), size_t(5), size_t(31), size_t(64), keys.size()} ) {
+        std::vector< std::pair<K, int> > d;
+        for( size_t i = 0; i < n && i < keys.size(); i += 2 )
+            d.emplace_back( keys[i], int(i) );
+        const fixed_eytzinger_map<K, int> e{ std::begin(d), std::end(d) };
+        
+        std::vector<typename fixed_eytzinger_map<K, int>::const_iterator> lower;
+        e.lower_bound_batch( std::begin(keys), std::end(keys), std::back_inserter(lower) );
+        REQUIRE( lower.size() == keys.size() );
+        for( size_t i = 0; i < keys.size(); ++i )
+            CHECK( lower[i] == e.lower_bound(keys[i]) );
+    }
+}
+
+TEST_CASE( "Batched lookup handles arithmetic keys", "[fixed_eytzinger_map]" )
+{
+    std::vector<int32_t> i32;
+    std::vector<uint32_t> u32;
+    std::vector<int64_t> i64;
+    std::vector<uint64_t> u64;
+    std::vector<float> f32;
+    std::vector<double> f64;
+    for( int i = -500; i < 500; ++i ) {
+        i32.emplace_back( i * 1000003 );
+        u32.emplace_back( uint32_t(i) * 2654435761u );
+        i64.emplace_back( int64_t(i) * 1000000000007 );
+        u64.emplace_back( uint64_t(i) * 11400714819323198485ull );
+        f32.emplace_back( float(i) / 3.f );
+        f64.emplace_back( double(i) * 1e10 );
+    }
+    check_batch_lookup_for_arithmetic_keys( i32 );
+    check_batch_lookup_for_arithmetic_keys( u32 );
+    check_batch_lookup_for_arithmetic_keys( i64 );
+    check_batch_lookup_for_arithmetic_keys( u64 );
+    check_batch_lookup_for_arithmetic_keys( f32 );
+    check_batch_lookup_for_arithmetic_keys( f64 );
+}
+
+template <typename K>
+static void check_small_lookup_for_arithmetic_keys( std::vector<K> keys )
+{
+    std::sort( std::begin(keys), std::end(keys) );
+    for( size_t n = 0; n <= 40; ++n ) {
+        std::vector< std::pair<K, int> > d;
+        std::vector<K> sorted;
+        for( size_t i = 0; i < n; ++i ) {
+            d.emplace_back( keys[2 * i + 1], int(i) );
+            sorted.emplace_back( keys[2 * i + 1] );
+        }
+        const fixed_eytzinger_map<K, int> e{ std::begin(d), std::end(d) };
+        
+        for( size_t i = 0; i <= 2 * n; ++i ) {
+            const K k = keys[i];
+            auto lb = std::lower_bound( std::begin(sorted), std::end(sorted), k );
+            auto ub = std::upper_bound( std::begin(sorted), std::end(sorted), k );
+            CHECK( e.lower_bound(k) == (lb == std::end(sorted) ? e.end() : e.find(*lb)) );
+            CHECK( e.upper_bound(k) == (ub == std::end(sorted) ? e.end() : e.find(*ub)) );
+            CHECK( e.count(k) == size_t(i % 2) );
+        }
+    }
+}
+
+TEST_CASE( "Small maps of arithmetic keys agree with binary search", "[fixed_eytzinger_map]" )
+{
+    std::vector<int32_t> i32;
+    std::vector<uint32_t> u32;
+    std::vector<int64_t> i64;
+    std::vector<uint64_t> u64;
+    std::vector<float> f32;
+    std::vector<double> f64;
+    for( int i = -41; i < 41; ++i ) {
+        i32.emplace_back( i * 1000003 );
+        u32.emplace_back( uint32_t(i) * 2654435761u );
+        i64.emplace_back( int64_t(i) * 1000000000007 );
+        u64.emplace_back( uint64_t(i) * 11400714819323198485ull );
+        f32.emplace_back( float(i) / 3.f );
+        f64.emplace_back( double(i) * 1e10 );
+    }
+    check_small_lookup_for_arithmetic_keys( i32 );
+    check_small_lookup_for_arithmetic_keys( u32 );
+    check_small_lookup_for_arithmetic_keys( i64 );
+    check_small_lookup_for_arithmetic_keys( u64 );
+    check_small_lookup_for_arithmetic_keys( f32 );
+    check_small_lookup_for_arithmetic_keys( f64 );
+}
@@ -0,0 +1,189 @@
+#include <catch.hpp>
+#include <fixed_eytzinger_map_view.h>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char *g_ViewFile = "fixed_eytzinger_map_view_sanity_tests.bin";
+
+static std::vector<char> ReadFile( const char *path )
+{
+    std::ifstream f( path, std::ios::binary );
+    return std::vector<char>( std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>() );
+}
+
+template <typename It1, typename It2>
+static bool SameElements( It1 first1, It1 last1, It2 first2 )
+{
+    for( ; first1 != last1; ++first1, ++first2 )
+        if( (*first1).first != (*first2).first || (*first1).second != (*first2).second )
+            return false;
+    return true;
+}
+
+// Keeps a copy of a file in memory aligned as the file would be when mapped.
+struct AlignedCopy
+{
+    explicit AlignedCopy( const std::vector<char> &bytes ) :
+        words( bytes.size() / sizeof(long long) + 1 ), size( bytes.size() )
+    {
+        std::copy( bytes.begin(), bytes.end(), data() );
+    }
+    char *data() { return reinterpret_cast<char*>(words.data()); }
+    std::vector<long long> words;
+    size_t size;
+};
+
+TEST_CASE( "Saved map can be searched in place", "[fixed_eytzinger_map_view]" )
+{
+    for( int n = 0; n < 1000; n += 37 ) {
+        std::map<int, double> m;
+        for( int i = 0; i < n; ++i )
+            m.emplace( (i * 7919) % 4001 * 2, i * 0.5 );
+        fixed_eytzinger_map<int, double> e{ m.begin(), m.end() };
+        save( e, g_ViewFile );
+
+        fixed_eytzinger_map_view<int, double> v{ g_ViewFile };
+        REQUIRE( v.size() == e.size() );
+        CHECK( v.empty() == e.empty() );
+        CHECK( v.verify() );
+        CHECK( SameElements(v.begin(), v.end(), e.cbegin()) );
+        CHECK( std::distance(v.ordered_begin(), v.ordered_end()) == n );
+        CHECK( SameElements(v.ordered_begin(), v.ordered_end(), m.begin()) );
+        CHECK( SameElements(v.ordered_rbegin(), v.ordered_rend(), m.rbegin()) );
+
+        std::vector<int> keys;
+        for( int k = -1; k <= 8003; k += 3 ) {
+            keys.emplace_back( k );
+            CHECK( v.count(k) == m.count(k) );
+            CHECK( (v.find(k) == v.end()) == (m.find(k) == m.end()) );
+            if( m.count(k) ) {
+                CHECK( v.at(k) == m.at(k) );
+                CHECK( v.find(k)->second == m.at(k) );
+            }
+            else {
+                CHECK_THROWS_AS( v.at(k), std::out_of_range );
+            }
+            auto lb = m.lower_bound(k);
+            CHECK( (lb == m.end() ? v.lower_bound(k) == v.end() :
+                                    v.lower_bound(k)->first == lb->first) );
+            auto ub = m.upper_bound(k);
+            CHECK( (ub == m.end() ? v.upper_bound(k) == v.end() :
+                                    v.upper_bound(k)->first == ub->first) );
+            auto r = v.equal_range(k);
+            CHECK( std::distance(r.first, r.second) == (ptrdiff_t)m.count(k) );
+        }
+        CHECK( std::distance(v.range(100, 1000).begin(), v.range(100, 1000).end()) ==
+               std::distance(m.lower_bound(100), m.lower_bound(1000)) );
+
+        std::vector<size_t> counts;
+        std::vector<fixed_eytzinger_map_view<int, double>::const_iterator> found, bounds;
+        v.count_batch( keys.begin(), keys.end(), std::back_inserter(counts) );
+        v.find_batch( keys.begin(), keys.end(), std::back_inserter(found) );
+        v.lower_bound_batch( keys.begin(), keys.end(), std::back_inserter(bounds) );
+        for( size_t i = 0; i < keys.size(); ++i ) {
+            CHECK( counts[i] == v.count(keys[i]) );
+            CHECK( found[i] == v.find(keys[i]) );
+            CHECK( bounds[i] == v.lower_bound(keys[i]) );
+        }
+
+        AlignedCopy copy( ReadFile(g_ViewFile) );
+        fixed_eytzinger_map_view<int, double> mv{ copy.data(), copy.size };
+        CHECK( SameElements(mv.begin(), mv.end(), e.cbegin()) );
+        CHECK( mv.verify() );
+        if( n != 0 ) {
+            copy.data()[copy.size - 1] ^= 1;
+            CHECK( !mv.verify() );
+        }
+    }
+
+    typedef std::array<char, 100> BigKey;
+    std::vector< std::pair<BigKey, int> > big;
+    for( int i = 0; i < 50; ++i )
+        big.emplace_back( BigKey{{char('a' + i % 26), char('a' + i / 26)}}, i );
+    save( fixed_eytzinger_map<BigKey, int>( big.begin(), big.end() ), g_ViewFile );
+    fixed_eytzinger_map_view<BigKey, int> bv{ g_ViewFile };
+    CHECK( bv.verify() );
+    for( auto &i: big )
+        CHECK( bv.at(i.first) == i.second );
+    std::remove( g_ViewFile );
+}
+
+TEST_CASE( "View rejects files of other maps", "[fixed_eytzinger_map_view]" )
+{
+    fixed_eytzinger_map<long long, int> e{ {1, 10}, {2, 20}, {3, 30} };
+    save( e, g_ViewFile );
+
+    typedef fixed_eytzinger_map_view<long long, int> V;
+    CHECK_NOTHROW( V{g_ViewFile} );
+    CHECK_THROWS_AS( (fixed_eytzinger_map_view<long long, long long>{g_ViewFile}),
+                     std::runtime_error );
+    CHECK_THROWS_AS( (fixed_eytzinger_map_view<int, int>{g_ViewFile}), std::runtime_error );
+    CHECK_THROWS_AS( (fixed_eytzinger_map_view<long long, int, std::greater<long long>>{
+                        g_ViewFile}), std::runtime_error );
+    CHECK_THROWS_AS( V{"fixed_eytzinger_map_view_sanity_tests.none"}, std::system_error );
+
+    const std::vector<char> bytes = ReadFile( g_ViewFile );
+    {
+        AlignedCopy copy( bytes );
+        copy.data()[0] = 'X';
+        CHECK_THROWS_AS( (V{copy.data(), copy.size}), std::runtime_error );
+    }
+    {
+        AlignedCopy copy( bytes );
+        CHECK_THROWS_AS( (V{copy.data(), copy.size - 1}), std::runtime_error );
+        CHECK_THROWS_AS( (V{copy.data(), 16}), std::runtime_error );
+    }
+
+    V v{ g_ViewFile };
+    save( fixed_eytzinger_map<long long, int>{ {4, 40} }, g_ViewFile );
+    CHECK( v.at(2) == 20 ); // the old file stays mapped
+    V w{ g_ViewFile };
+    CHECK( w.size() == 1 );
+    std::swap( v, w );
+    CHECK( v.at(4) == 40 );
+    V moved = std::move( w );
+    CHECK( moved.at(3) == 30 );
+    CHECK( w.empty() );
+    std::remove( g_ViewFile );
+}
+
+TEST_CASE( "Concurrent saves to one path leave a whole file", "[fixed_eytzinger_map_view]" )
+{
+    std::vector< std::pair<long long, int> > d;
+    for( int i = 0; i < 10000; ++i )
+        d.emplace_back( i, i );
+    const fixed_eytzinger_map<long long, int> small{ {1, 1} }, large( d.begin(), d.end() );
+    std::thread other( [&]{
+        for( int i = 0; i < 20; ++i )
+            save( small, g_ViewFile );
+    });
+    for( int i = 0; i < 20; ++i )
+        save( large, g_ViewFile );
+    other.join();
+    
+    fixed_eytzinger_map_view<long long, int> v{ g_ViewFile };
+    CHECK( v.verify() );
+    CHECK( (v.size() == small.size() || v.size() == large.size()) );
+    CHECK( v.at(1) == 1 );
+    std::remove( g_ViewFile );
+}
+
+#if __cplusplus >= 201402L
+TEST_CASE( "View supports heterogeneous lookup", "[fixed_eytzinger_map_view]" )
+{
+    fixed_eytzinger_map<int, int, std::less<>> e{ {1, 10}, {2, 20}, {3, 30} };
+    save( e, g_ViewFile );
+    fixed_eytzinger_map_view<int, int, std::less<>> v{ g_ViewFile };
+    CHECK( v.count(2.5) == 0 );
+    CHECK( v.lower_bound(2.5)->first == 3 );
+    CHECK( v.at(2.0) == 20 );
+    CHECK( std::distance(v.range(1.5, 3.5).begin(), v.range(1.5, 3.5).end()) == 2 );
+    std::remove( g_ViewFile );
+}
+#endif
@@ -0,0 +1,120 @@
+#include <catch.hpp>
+#include <fixed_eytzinger_multimap.h>
+#include <map>
+#include <string>
+#include <vector>
+
+template <typename M1, typename M2>
+static bool SameEntries( const M1 &m1, const M2 &m2 )
+{
+    if( m1.size() != m2.size() )
+        return false;
+    for( auto &i: m2 ) {
+        auto r1 = m1.equal_range( i.first );
+        auto r2 = m2.equal_range( i.first );
+        for( ; r1.first != r1.second && r2.first != r2.second; ++r1.first, ++r2.first )
+            if( r1.first->first != r2.first->first || r1.first->second != r2.first->second )
+                return false;
+        if( r1.first != r1.second || r2.first != r2.second )
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE( "Keeps all entries of a key", "[fixed_eytzinger_multimap]" )
+{
+    for( int n = 0; n < 500; n += 7 ) {
+        std::vector< std::pair<int, int> > d;
+        std::multimap<int, int> m;
+        for( int i = 0; i < n; ++i ) {
+            const int k = (i * 7919) % (n / 3 + 1);
+            d.emplace_back( k, i );
+            m.emplace( k, i );
+        }
+        fixed_eytzinger_multimap<int, int> e{ std::begin(d), std::end(d) };
+        REQUIRE( e.size() == m.size() );
+        REQUIRE( SameEntries(e, m) );
+        CHECK( std::distance(e.begin(), e.end()) == n );
+        CHECK( e.empty() == (n == 0) );
+
+        for( int k = -1; k <= n / 3 + 1; ++k ) {
+            CHECK( e.count(k) == m.count(k) );
+            if( m.count(k) ) {
+                CHECK( e.find(k)->first == k );
+                CHECK( e.find(k)->second == m.find(k)->second );
+            }
+            else {
+                CHECK( e.find(k) == e.end() );
+                CHECK( e.equal_range(k).first == e.equal_range(k).second );
+            }
+        }
+
+        std::vector<int> forward, backward;
+        for( auto i = e.begin(); i != e.end(); ++i )
+            forward.emplace_back( i->second );
+        for( auto i = e.end(); i != e.begin(); )
+            backward.emplace_back( (--i)->second );
+        CHECK( std::equal(forward.rbegin(), forward.rend(), backward.begin()) );
+        CHECK( backward.size() == (size_t)n );
+    }
+}
+
+TEST_CASE( "Multimap supports standard operations", "[fixed_eytzinger_multimap]" )
+{
+    typedef fixed_eytzinger_multimap<std::string, int> M;
+    M e{ {"b", 1}, {"a", 2}, {"b", 3}, {"c", 4}, {"b", 5} };
+    CHECK( e.size() == 5 );
+    CHECK( e.count("b") == 3 );
+
+    std::vector<int> b;
+    for( auto r = e.equal_range("b"); r.first != r.second; ++r.first )
+        b.emplace_back( r.first->second );
+    CHECK( b == (std::vector<int>{1, 3, 5}) );
+
+    e.find("a")->second = 20;
+    const M &ce = e;
+    CHECK( ce.find("a")->second == 20 );
+    M::const_iterator ci = e.begin();
+    CHECK( ci == ce.begin() );
+
+    M copy = e;
+    CHECK( copy == e );
+    M moved = std::move(copy);
+    CHECK( moved == e );
+    CHECK( copy.empty() );
+
+    M other;
+    other = { {"x", 1}, {"x", 1} };
+    CHECK( other.count("x") == 2 );
+    std::swap( other, moved );
+    CHECK( moved.count("x") == 2 );
+    CHECK( other == e );
+
+    std::vector< M::value_type > v{ {"y", 1}, {"z", 2}, {"y", 3} };
+    other.assign( std::move(v) );
+    CHECK( v.empty() );
+    CHECK( other.count("y") == 2 );
+    CHECK( other != e );
+
+    other.clear();
+    CHECK( other.empty() );
+    CHECK( other.begin() == other.end() );
+    CHECK( other.count("y") == 0 );
+
+    fixed_eytzinger_multimap<int, int, std::greater<int>> g{ {1, 1}, {2, 2}, {1, 3} };
+    CHECK( g.count(1) == 2 );
+}
+
+#if __cplusplus >= 201402L
+TEST_CASE( "Multimap supports heterogeneous lookup", "[fixed_eytzinger_multimap]" )
+{
+    fixed_eytzinger_multimap<std::string, int, std::less<>> e{
+        {"apple", 1}, {"banana", 2}, {"apple", 3} };
+    const auto &ce = e;
+    CHECK( e.count("apple") == 2 );
+    CHECK( ce.find("banana")->second == 2 );
+    CHECK( e.find("cherry") == e.end() );
+    auto r = ce.equal_range( "apple" );
+    CHECK( std::distance(r.first, r.second) == 2 );
+}
+#endif
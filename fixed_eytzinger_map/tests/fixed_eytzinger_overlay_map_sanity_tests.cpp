@@ -0,0 +1,141 @@
+#include <catch.hpp>
+#include <fixed_eytzinger_overlay_map.h>
+#include <map>
+#include <random>
+#include <string>
+
+template <typename O, typename M>
+static bool SameContents( const O &o, const M &m, int max_key )
+{
+    if( o.size() != m.size() )
+        return false;
+    for( int k = -1; k <= max_key; ++k ) {
+        const auto i = m.find( k );
+        const auto v = o.find( k );
+        if( (i == m.end()) != (v == nullptr) || o.count(k) != m.count(k) )
+            return false;
+        if( v && *v != i->second )
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE( "Overlay applies changes over the base", "[fixed_eytzinger_overlay_map]" )
+{
+    for( int background = 0; background < 2; ++background ) {
+        std::map<int, int> m;
+        for( int i = 0; i < 500; i += 2 )
+            m.emplace( i, i );
+        typedef fixed_eytzinger_overlay_map<int, int> O;
+        O o{ O::base_type(m.begin(), m.end()), 50, background != 0 };
+        CHECK( o.size() == m.size() );
+
+        std::mt19937 rnd( 42 );
+        for( int step = 0; step < 5000; ++step ) {
+            const int key = rnd() % 600, op = rnd() % 3;
+            if( op == 0 )
+                CHECK( o.insert({key, step}) == m.emplace(key, step).second );
+            else if( op == 1 ) {
+                const bool inserted = !m.count( key );
+                m[key] = step;
+                CHECK( o.insert_or_assign(key, step) == inserted );
+            }
+            else
+                CHECK( o.erase(key) == m.erase(key) );
+            if( step % 250 == 0 )
+                REQUIRE( SameContents(o, m, 600) );
+        }
+        REQUIRE( SameContents(o, m, 600) );
+        CHECK( o.merge_threshold() == 50 );
+        CHECK( o.background_merge() == (background != 0) );
+
+        o.merge();
+        CHECK( o.delta_size() == 0 );
+        REQUIRE( o.base().size() == m.size() );
+        auto b = o.base().ordered_begin();
+        for( auto &i: m ) {
+            CHECK( (*b).first == i.first );
+            CHECK( (*b).second == i.second );
+            ++b;
+        }
+        REQUIRE( SameContents(o, m, 600) );
+    }
+}
+
+TEST_CASE( "Overlay merges once the delta is big enough", "[fixed_eytzinger_overlay_map]" )
+{
+    typedef fixed_eytzinger_overlay_map<std::string, int> O;
+    O o{ O::base_type{ {"a", 1}, {"b", 2} }, 2 };
+    CHECK( o.at("a") == 1 );
+    CHECK_THROWS_AS( o.at("c"), std::out_of_range );
+    o.insert( {"c", 3} );
+    o.erase( "a" );
+    CHECK( o.delta_size() == 2 );
+    CHECK( o.base().size() == 2 );
+    o.insert_or_assign( "b", 20 );
+    CHECK( o.delta_size() == 0 );
+    CHECK( o.base().size() == 2 );
+    CHECK( o.base().at("b") == 20 );
+    CHECK( o.base().count("a") == 0 );
+    CHECK( o.size() == 2 );
+
+    O moved = std::move( o );
+    CHECK( moved.at("c") == 3 );
+    CHECK( !moved.empty() );
+    CHECK( O().empty() );
+}
+
+TEST_CASE( "Moved-from overlay is empty and usable", "[fixed_eytzinger_overlay_map]" )
+{
+    typedef fixed_eytzinger_overlay_map<int, int> O;
+    O o{ O::base_type{ {1, 10}, {2, 20} }, 2 };
+    o.insert( {3, 30} );
+    O moved = std::move( o );
+    CHECK( moved.size() == 3 );
+    CHECK( moved.at(3) == 30 );
+    CHECK( o.empty() );
+    CHECK( o.size() == 0 );
+    CHECK( o.delta_size() == 0 );
+    CHECK( o.base().empty() );
+    CHECK( o.find(1) == nullptr );
+    CHECK( o.count(3) == 0 );
+    CHECK( o.erase(1) == 0 );
+    CHECK( o.insert({4, 40}) );
+    CHECK( o.at(4) == 40 );
+    CHECK( o.merge_threshold() == 2 );
+
+    o = std::move( moved );
+    CHECK( o.size() == 3 );
+    CHECK( o.at(1) == 10 );
+    CHECK( moved.empty() );
+    CHECK( moved.find(4) == nullptr );
+    CHECK( moved.insert_or_assign(5, 50) );
+    moved.merge();
+    CHECK( moved.base().size() == 1 );
+    o = std::move( o );
+    CHECK( o.size() == 3 );
+}
+
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+TEST_CASE( "Overlay keeps the delta in the allocator of the base", "[fixed_eytzinger_overlay_map]" )
+{
+    typedef std::pmr::polymorphic_allocator< std::pair<int, int> > A;
+    typedef fixed_eytzinger_overlay_map<int, int, std::less<int>, A> O;
+    std::pmr::monotonic_buffer_resource arena;
+    O::base_type base{ { {1, 10}, {2, 20} }, std::less<int>(), A(&arena) };
+    
+    // anything allocated from the default resource would throw
+    std::pmr::memory_resource *const prev =
+        std::pmr::set_default_resource( std::pmr::null_memory_resource() );
+    O o{ std::move(base), 100, true };
+    CHECK( !o.background_merge() ); // the merge would share the resource with the delta
+    CHECK( o.insert({3, 30}) );
+    CHECK( o.insert_or_assign(1, 11) == false );
+    CHECK( o.erase(2) == 1 );
+    CHECK( o.delta_size() == 3 );
+    CHECK( *o.find(1) == 11 );
+    CHECK( o.count(2) == 0 );
+    CHECK( o.at(3) == 30 );
+    std::pmr::set_default_resource( prev );
+}
+#endif
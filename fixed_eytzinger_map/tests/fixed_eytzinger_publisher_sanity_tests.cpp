@@ -0,0 +1,81 @@
+#include <catch.hpp>
+#include <fixed_eytzinger_map.h>
+#include <fixed_eytzinger_publisher.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+typedef fixed_eytzinger_map<int, int> PublishedMap;
+
+static PublishedMap MakeVersion( int version, int size )
+{
+    std::vector< std::pair<int, int> > d;
+    for( int i = 0; i < size; ++i )
+        d.emplace_back( i, version );
+    return PublishedMap( fixed_eytzinger_sorted_unique, d.begin(), d.end() );
+}
+
+TEST_CASE( "Publishes containers to readers", "[fixed_eytzinger_publisher]" )
+{
+    fixed_eytzinger_publisher<PublishedMap> p{ MakeVersion(1, 10) };
+    auto s1 = p.read();
+    REQUIRE( s1 );
+    CHECK( s1->at(5) == 1 );
+
+    std::atomic<bool> published{ false };
+    std::thread writer( [&]{
+        p.publish( MakeVersion(2, 20) );
+        published = true;
+    });
+    // the new map is swapped in before the writer waits for s1 to let go of the old one
+    while( p.read()->size() != 20 )
+        std::this_thread::yield();
+    CHECK( !published ); // s1 still holds the old map
+    CHECK( (*s1).size() == 10 );
+    CHECK( p.read()->at(15) == 2 );
+    s1.release();
+    CHECK( !s1 );
+    writer.join();
+    CHECK( published );
+
+    auto s2 = p.read();
+    decltype(s2) s3;
+    s3 = std::move( s2 );
+    CHECK( !s2 );
+    CHECK( s3.get()->size() == 20 );
+    s3 = p.read();
+    CHECK( s3->at(0) == 2 );
+
+    fixed_eytzinger_publisher<PublishedMap> empty;
+    CHECK( empty.read()->empty() );
+}
+
+TEST_CASE( "Readers see whole versions while writers replace them", "[fixed_eytzinger_publisher]" )
+{
+    const int size = 1000, versions = 50, readers = 4;
+    fixed_eytzinger_publisher<PublishedMap> p{ MakeVersion(0, size) };
+    std::atomic<bool> done{ false };
+    std::atomic<int> failures{ 0 };
+    std::vector<std::thread> threads;
+    for( int r = 0; r < readers; ++r )
+        threads.emplace_back( [&, r]{
+            int last = 0;
+            for( int i = 0; !done; ++i ) {
+                auto s = p.read();
+                const int version = s->at( (i * 7 + r) % size );
+                if( version < last || s->at(size - 1) != version || s->size() != (size_t)size )
+                    ++failures;
+                last = version;
+            }
+        });
+    std::thread writer( [&]{
+        for( int v = 1; v <= versions; ++v )
+            p.publish( MakeVersion(v, size) );
+    });
+    writer.join();
+    done = true;
+    for( auto &t: threads )
+        t.join();
+    CHECK( failures == 0 );
+    CHECK( p.read()->at(0) == versions );
+}
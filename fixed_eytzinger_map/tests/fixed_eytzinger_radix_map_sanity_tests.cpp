@@ -0,0 +1,195 @@
+#include <catch.hpp>
+#include <fixed_eytzinger_radix_map.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+template <typename M, typename K>
+static bool SameLookups( const M &x, const std::map<K, int> &m, const std::vector<K> &lookups )
+{
+    if( x.size() != m.size() )
+        return false;
+    for( K k: lookups ) {
+        const auto lb = m.lower_bound( k ), ub = m.upper_bound( k );
+        const auto xlb = x.lower_bound( k ), xub = x.upper_bound( k );
+        if( (lb == m.end()) != (xlb == x.end()) || (lb != m.end() && xlb->first != lb->first) )
+            return false;
+        if( (ub == m.end()) != (xub == x.end()) || (ub != m.end() && xub->first != ub->first) )
+            return false;
+        if( x.count(k) != m.count(k) )
+            return false;
+        if( m.count(k) && (x.at(k) != m.at(k) || x.find(k)->second != m.at(k)) )
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE( "Radix lookups agree with std::map", "[fixed_eytzinger_radix_map]" )
+{
+    std::mt19937_64 rnd( 5 );
+    for( size_t n: {0, 1, 2, 7, 100, 1000, 50000} ) {
+        std::map<long long, int> ids, hashes;
+        std::map<int, int> negative;
+        std::map<uint64_t, int> wide;
+        for( size_t i = 0; i < n; ++i ) {
+            ids.emplace( 1000 + 3 * (long long)i, (int)i );
+            hashes.emplace( (long long)rnd(), (int)i );
+            negative.emplace( (int)(rnd() % 1000) - 2000 + (i % 3 == 0 ? 0 : 1000000), (int)i );
+            wide.emplace( i % 2 ? std::numeric_limits<uint64_t>::max() - i : i, (int)i );
+        }
+        std::vector<long long> lookups;
+        for( auto &i: hashes ) {
+            lookups.emplace_back( i.first );
+            lookups.emplace_back( i.first + 1 );
+            lookups.emplace_back( i.first - 1 );
+        }
+        for( long long k = 990; k < 1010 + 3 * (long long)n; ++k )
+            lookups.emplace_back( k );
+        lookups.emplace_back( std::numeric_limits<long long>::min() );
+        lookups.emplace_back( std::numeric_limits<long long>::max() );
+
+        fixed_eytzinger_radix_map<long long, int> x1{ ids.begin(), ids.end() };
+        CHECK( SameLookups(x1, ids, lookups) );
+        CHECK( x1.buckets() >= std::min<size_t>(n / 16, 1) );
+        fixed_eytzinger_radix_map<long long, int> x2{ fixed_eytzinger_sorted_unique,
+                                                      hashes.begin(), hashes.end() };
+        CHECK( SameLookups(x2, hashes, lookups) );
+
+        std::vector<int> int_lookups;
+        for( int k = -2100; k < -900; ++k )
+            int_lookups.emplace_back( k );
+        for( int k = 999000; k < 1000100; ++k )
+            int_lookups.emplace_back( k );
+        int_lookups.emplace_back( std::numeric_limits<int>::min() );
+        int_lookups.emplace_back( std::numeric_limits<int>::max() );
+        fixed_eytzinger_radix_map<int, int> x3{ negative.begin(), negative.end() };
+        CHECK( SameLookups(x3, negative, int_lookups) );
+
+        std::vector<uint64_t> wide_lookups;
+        for( auto &i: wide )
+            for( uint64_t d: {0, 1} ) {
+                wide_lookups.emplace_back( i.first + d );
+                wide_lookups.emplace_back( i.first - d );
+            }
+        fixed_eytzinger_radix_map<uint64_t, int> x4{ wide.begin(), wide.end() };
+        CHECK( SameLookups(x4, wide, wide_lookups) );
+
+        std::map<double, int> reals;
+        std::vector<double> real_lookups{ -0., 0., -std::numeric_limits<double>::infinity(),
+                                          std::numeric_limits<double>::infinity() };
+        std::normal_distribution<double> normal( 0., 1000. );
+        for( size_t i = 0; i < n; ++i ) {
+            const double k = normal( rnd );
+            reals.emplace( k, (int)i );
+            real_lookups.emplace_back( k );
+            real_lookups.emplace_back( std::nextafter(k, 1e300) );
+            real_lookups.emplace_back( std::nextafter(k, -1e300) );
+        }
+        reals.emplace( 0., -1 );
+        fixed_eytzinger_radix_map<double, int> x5{ reals.begin(), reals.end() };
+        CHECK( SameLookups(x5, reals, real_lookups) );
+        CHECK( x5.at(-0.) == -1 );
+    }
+}
+
+// Projects strings to their first eight bytes, which is monotonic but not injective.
+struct StringPrefix
+{
+    uint64_t operator()( const std::string &_s ) const noexcept
+    {
+        uint64_t p = 0;
+        for( size_t i = 0; i < 8; ++i )
+            p = (p << 8) | (i < _s.size() ? (unsigned char)_s[i] : 0);
+        return p;
+    }
+};
+
+TEST_CASE( "Radix map supports standard operations", "[fixed_eytzinger_radix_map]" )
+{
+    typedef fixed_eytzinger_radix_map<std::string, int, StringPrefix> S;
+    std::map<std::string, int> m;
+    std::vector<std::string> lookups;
+    for( int i = 0; i < 3000; ++i ) {
+        const std::string k = (i % 2 ? "common_prefix_" : "") + std::to_string(i * 7 % 1000);
+        m.emplace( k, i );
+        lookups.emplace_back( k );
+        lookups.emplace_back( k + "0" );
+    }
+    lookups.emplace_back( "" );
+    lookups.emplace_back( "zzz" );
+    S s{ m.begin(), m.end() };
+    CHECK( SameLookups(s, m, lookups) );
+    CHECK( std::distance(s.begin(), s.end()) == (ptrdiff_t)m.size() );
+
+    S copy = s;
+    CHECK( copy == s );
+    S moved = std::move( copy );
+    CHECK( moved == s );
+    CHECK( copy.empty() );
+    CHECK( copy.buckets() == 0 );
+    CHECK( copy.find("common_prefix_7") == copy.end() );
+    CHECK( copy.count("7") == 0 );
+    CHECK( copy.upper_bound("") == copy.end() );
+    CHECK_THROWS_AS( copy.at("7"), std::out_of_range );
+    copy = std::move( moved );
+    CHECK( copy == s );
+    CHECK( moved.empty() );
+    CHECK( moved.lower_bound("7") == moved.end() );
+    moved = copy;
+    CHECK( moved == s );
+    S other{ {"a", 1}, {"b", 2}, {"a", 3} };
+    CHECK( other.size() == 2 );
+    CHECK( other != s );
+    std::swap( other, moved );
+    CHECK( other == s );
+    CHECK( moved.at("b") == 2 );
+    CHECK_THROWS_AS( moved.at("c"), std::out_of_range );
+    CHECK( std::distance(moved.equal_range("a").first, moved.equal_range("a").second) == 1 );
+    CHECK( std::distance(moved.equal_range("c").first, moved.equal_range("c").second) == 0 );
+
+    std::vector< std::pair<int, int> > unsorted{ {2, 0}, {1, 0} };
+    CHECK_THROWS_AS( (fixed_eytzinger_radix_map<int, int>{ fixed_eytzinger_sorted_unique,
+                                                           unsorted.begin(), unsorted.end() }),
+                     std::invalid_argument );
+    const fixed_eytzinger_radix_map<int, int> small{ {1, 1}, {2, 2}, {3, 3} };
+    CHECK( (uintptr_t)(&small.begin()->first - 1) % 64 == 0 );
+    CHECK( (uintptr_t)(&small.begin()->second) % 64 == 0 );
+    const fixed_eytzinger_radix_map<int, int> empty;
+    CHECK( empty.empty() );
+    CHECK( empty.find(1) == empty.end() );
+    CHECK( empty.lower_bound(1) == empty.end() );
+}
+
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+TEST_CASE( "Radix maps follow the allocator propagation traits", "[fixed_eytzinger_radix_map]" )
+{
+    typedef std::pmr::polymorphic_allocator< std::pair<int, int> > A;
+    typedef fixed_eytzinger_radix_map<int, int, fixed_eytzinger_radix_projection<int>,
+                                      std::less<int>, A> R;
+    std::pmr::monotonic_buffer_resource arena;
+    std::vector< std::pair<int, int> > d;
+    for( int i = 0; i < 1000; ++i )
+        d.emplace_back( i * 3, i );
+    
+    R a{ d.begin(), d.end() };
+    R b{ { {1, 1} }, std::less<int>(), A(&arena) };
+    b = std::move( a );
+    CHECK( a.empty() );
+    CHECK( a.find(3) == a.end() );
+    CHECK( b.size() == 1000 );
+    CHECK( b.at(300) == 100 );
+    CHECK( b.get_allocator().resource() == &arena );
+    
+    R c{ { {1, 1} }, std::less<int>(), A(&arena) };
+    c = b;
+    CHECK( c == b );
+    CHECK( c.get_allocator().resource() == &arena );
+    R e( b );
+    CHECK( e.get_allocator().resource() == std::pmr::get_default_resource() );
+    CHECK( e.at(2997) == 999 );
+}
+#endif
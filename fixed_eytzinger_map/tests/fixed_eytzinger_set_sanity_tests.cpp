@@ -0,0 +1,136 @@
+#include <catch.hpp>
+#include <fixed_eytzinger_set.h>
+#include <set>
+#include <string>
+#include <vector>
+
+TEST_CASE( "Contains the same keys as std::set", "[fixed_eytzinger_set]" )
+{
+    for( int n = 0; n < 500; n += 7 ) {
+        std::vector<int> d;
+        std::set<int> s;
+        for( int i = 0; i < n; ++i ) {
+            const int k = (i * 7919) % (n + 1) * 2;
+            d.emplace_back( k );
+            s.emplace( k );
+        }
+        fixed_eytzinger_set<int> e{ std::begin(d), std::end(d) };
+        REQUIRE( e.size() == s.size() );
+        CHECK( std::distance(e.begin(), e.end()) == (ptrdiff_t)s.size() );
+        CHECK( std::set<int>(e.begin(), e.end()) == s );
+        CHECK( e == fixed_eytzinger_set<int>(fixed_eytzinger_sorted_unique, s.begin(), s.end()) );
+
+        for( int k = -1; k <= 2 * n + 2; ++k ) {
+            CHECK( e.count(k) == s.count(k) );
+            if( s.count(k) )
+                CHECK( *e.find(k) == k );
+            else
+                CHECK( e.find(k) == e.end() );
+            auto lb = s.lower_bound(k);
+            CHECK( (lb == s.end() ? e.lower_bound(k) == e.end() : *e.lower_bound(k) == *lb) );
+            auto ub = s.upper_bound(k);
+            CHECK( (ub == s.end() ? e.upper_bound(k) == e.end() : *e.upper_bound(k) == *ub) );
+            auto r = e.equal_range(k);
+            CHECK( std::distance(r.first, r.second) == (ptrdiff_t)s.count(k) );
+        }
+
+        std::vector<int> keys;
+        for( int k = -1; k <= 2 * n + 2; ++k )
+            keys.emplace_back( k );
+        std::vector<size_t> counts;
+        std::vector<fixed_eytzinger_set<int>::const_iterator> found, bounds;
+        e.count_batch( keys.begin(), keys.end(), std::back_inserter(counts) );
+        e.find_batch( keys.begin(), keys.end(), std::back_inserter(found) );
+        e.lower_bound_batch( keys.begin(), keys.end(), std::back_inserter(bounds) );
+        for( size_t i = 0; i < keys.size(); ++i ) {
+            CHECK( counts[i] == e.count(keys[i]) );
+            CHECK( found[i] == e.find(keys[i]) );
+            CHECK( bounds[i] == e.lower_bound(keys[i]) );
+        }
+    }
+}
+
+TEST_CASE( "Set supports standard operations", "[fixed_eytzinger_set]" )
+{
+    typedef fixed_eytzinger_set<std::string> S;
+    S e{ "b", "a", "c", "b" };
+    CHECK( e.size() == 3 );
+    CHECK( e.count("b") == 1 );
+    CHECK( e.count("d") == 0 );
+
+    S copy = e;
+    CHECK( copy == e );
+    S moved = std::move(copy);
+    CHECK( moved == e );
+    CHECK( copy.empty() );
+
+    S other;
+    other = { "x", "y" };
+    std::swap( other, moved );
+    CHECK( moved.count("x") == 1 );
+    CHECK( other == e );
+
+    std::vector<std::string> v{ "z", "y", "z" };
+    other.assign( std::move(v) );
+    CHECK( v.empty() );
+    CHECK( other.size() == 2 );
+    CHECK( other != e );
+
+    CHECK_THROWS_AS( S(fixed_eytzinger_sorted_unique, {"a", "c", "b"}), std::invalid_argument );
+    CHECK_THROWS_AS( S(fixed_eytzinger_sorted_unique, {"a", "a"}), std::invalid_argument );
+
+    other.clear();
+    CHECK( other.empty() );
+    CHECK( other.begin() == other.end() );
+    CHECK( other.count("y") == 0 );
+
+    fixed_eytzinger_set<int, std::greater<int>> g{ 1, 2, 3 };
+    CHECK( *g.lower_bound(2) == 2 );
+    CHECK( *g.upper_bound(2) == 1 );
+}
+
+#if __cplusplus >= 201402L
+TEST_CASE( "Set supports heterogeneous lookup", "[fixed_eytzinger_set]" )
+{
+    fixed_eytzinger_set<std::string, std::less<>> e{ "apple", "banana", "cherry" };
+    CHECK( e.count("apple") == 1 );
+    CHECK( *e.find("banana") == "banana" );
+    CHECK( e.find("date") == e.end() );
+    CHECK( *e.lower_bound("b") == "banana" );
+    CHECK( *e.upper_bound("banana") == "cherry" );
+
+    const char *keys[] = { "cherry", "date" };
+    size_t counts[2];
+    e.count_batch( std::begin(keys), std::end(keys), counts );
+    CHECK( counts[0] == 1 );
+    CHECK( counts[1] == 0 );
+}
+#endif
+
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+TEST_CASE( "Set moves to an exhausted memory resource throw", "[fixed_eytzinger_set]" )
+{
+    char buffer[1024];
+    std::pmr::monotonic_buffer_resource arena{ buffer, sizeof(buffer),
+                                               std::pmr::null_memory_resource() };
+    std::vector<int> d( 1000 );
+    for( int i = 0; i < 1000; ++i )
+        d[i] = i;
+    fixed_eytzinger_pmr_set<int> s{ std::begin(d), std::end(d) };
+    fixed_eytzinger_pmr_set<int> s2{ {1}, &arena };
+
+    CHECK_THROWS_AS( s2 = std::move(s), std::bad_alloc );
+    CHECK( s.size() == 1000 );
+    CHECK( s2.size() == 1 );
+    CHECK( s2.count(1) == 1 );
+
+    typedef fixed_eytzinger_pmr_set<int> S;
+    CHECK_THROWS_AS( S(std::move(s), &arena), std::bad_alloc );
+    CHECK( s.size() == 1000 );
+
+    S s3{ {7, 8}, &arena };
+    s3 = s2;
+    CHECK( s3 == s2 );
+    CHECK( s3.get_allocator().resource() == &arena );
+}
+#endif
@@ -0,0 +1,109 @@
+#include <catch.hpp>
+#include <fixed_eytzinger_string_arena_map.h>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 201703L
+template <typename S>
+static bool SameLookups( const S &s, const std::map<std::string, int> &m,
+                         const std::vector<std::string> &lookups )
+{
+    if( s.size() != m.size() )
+        return false;
+    for( auto &k: lookups ) {
+        const auto lb = m.lower_bound( k ), ub = m.upper_bound( k );
+        const auto slb = s.lower_bound( k ), sub = s.upper_bound( k );
+        if( (lb == m.end()) != (slb == s.end()) || (lb != m.end() && slb->first != lb->first) )
+            return false;
+        if( (ub == m.end()) != (sub == s.end()) || (ub != m.end() && sub->first != ub->first) )
+            return false;
+        if( s.count(k) != m.count(k) )
+            return false;
+        if( m.count(k) && (s.at(k) != m.at(k) || s.find(k)->second != m.at(k)) )
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE( "Arena map lookups agree with std::map", "[fixed_eytzinger_string_arena_map]" )
+{
+    typedef fixed_eytzinger_string_arena_map<int> S;
+    const std::string alphabet( "ab\0\xff", 4 );
+    std::mt19937 rnd( 11 );
+    for( const std::string common: {"", "a", "https://www.example.com/"} )
+        for( size_t n: {0, 1, 2, 10, 100, 3000} ) {
+            std::map<std::string, int> m;
+            std::vector< std::pair<std::string, int> > input;
+            std::vector<std::string> lookups{ "", common, common + "b", "\xff\xff" };
+            for( size_t i = 0; i < n; ++i ) {
+                std::string k = common;
+                for( size_t l = rnd() % 12; l != 0; --l )
+                    k += alphabet[rnd() % alphabet.size()];
+                if( m.emplace(k, (int)i).second )
+                    input.emplace_back( k, (int)i );
+            }
+            for( auto &i: m ) {
+                lookups.emplace_back( i.first );
+                lookups.emplace_back( i.first + '\0' );
+                lookups.emplace_back( i.first.substr(0, i.first.size() - 1) );
+            }
+            
+            const S s{ input.begin(), input.end() };
+            CHECK( SameLookups(s, m, lookups) );
+            size_t bytes = 0;
+            for( auto &i: m )
+                bytes += i.first.size();
+            CHECK( s.arena_size() == bytes );
+            
+            const S sorted{ fixed_eytzinger_sorted_unique, m.begin(), m.end() };
+            CHECK( SameLookups(sorted, m, lookups) );
+            CHECK( std::equal(s.ordered_begin(), s.ordered_end(), sorted.ordered_begin()) );
+            
+            S copy = s;
+            input.clear(); // the map doesn't refer to its input
+            CHECK( SameLookups(copy, m, lookups) );
+            S assigned;
+            assigned = copy;
+            copy = S();
+            CHECK( SameLookups(assigned, m, lookups) );
+            CHECK( std::distance(assigned.range(common, common + "b").begin(),
+                                 assigned.range(common, common + "b").end()) ==
+                   std::distance(m.lower_bound(common), m.lower_bound(common + "b")) );
+        }
+}
+
+TEST_CASE( "Arena map supports transparent lookup", "[fixed_eytzinger_string_arena_map]" )
+{
+    typedef fixed_eytzinger_string_arena_map<int> S;
+    S s{ {"example.com", 1}, {"example.org", 2}, {"example.net", 3}, {"example.com", 4} };
+    CHECK( s.size() == 3 );
+    CHECK( (s.at("example.com") == 1 || s.at("example.com") == 4) );
+    CHECK( s.at(std::string("example.net")) == 3 );
+    CHECK( s.at(std::string_view("example.org")) == 2 );
+    CHECK_THROWS_AS( s.at("example"), std::out_of_range );
+    CHECK( (s.lower_bound("example")->first == "example.com") );
+    CHECK( (s.upper_bound("example.net")->first == "example.org") );
+    CHECK( s.find("example.zzz") == s.end() );
+    CHECK( std::distance(s.begin(), s.end()) == 3 );
+    CHECK( s.base().size() == 3 );
+    
+    S moved = std::move( s );
+    CHECK( moved.at("example.org") == 2 );
+    S other{ {"a", 1} };
+    std::swap( other, moved );
+    CHECK( other.at("example.org") == 2 );
+    CHECK( moved.at("a") == 1 );
+    moved = std::move( other );
+    CHECK( moved.at("example.net") == 3 );
+    
+    std::vector< std::pair<const char*, int> > unsorted{ {"b", 1}, {"a", 2} };
+    CHECK_THROWS_AS( (S{ fixed_eytzinger_sorted_unique, unsorted.begin(), unsorted.end() }),
+                     std::invalid_argument );
+    const S empty;
+    CHECK( empty.empty() );
+    CHECK( empty.find("") == empty.end() );
+    CHECK( empty.arena_size() == 0 );
+}
+#endif
@@ -0,0 +1,88 @@
+#include <catch.hpp>
+#include <fixed_eytzinger_string_map.h>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+template <typename S>
+static bool SameLookups( const S &s, const std::map<std::string, int> &m,
+                         const std::vector<std::string> &lookups )
+{
+    if( s.size() != m.size() )
+        return false;
+    for( auto &k: lookups ) {
+        const auto lb = m.lower_bound( k ), ub = m.upper_bound( k );
+        const auto slb = s.lower_bound( k ), sub = s.upper_bound( k );
+        if( (lb == m.end()) != (slb == s.end()) || (lb != m.end() && slb->first != lb->first) )
+            return false;
+        if( (ub == m.end()) != (sub == s.end()) || (ub != m.end() && sub->first != ub->first) )
+            return false;
+        if( s.count(k) != m.count(k) )
+            return false;
+        if( m.count(k) && (s.at(k) != m.at(k) || s.find(k)->second != m.at(k)) )
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE( "String map lookups agree with std::map", "[fixed_eytzinger_string_map]" )
+{
+    typedef fixed_eytzinger_string_map<int> S;
+    const std::string alphabet( "ab\0\xff", 4 );
+    std::mt19937 rnd( 7 );
+    for( const std::string common: {"", "a", "https://www.example.com/"} )
+        for( size_t n: {0, 1, 2, 10, 100, 3000} ) {
+            std::map<std::string, int> m;
+            std::vector<std::string> lookups{ "", common, common.substr(0, common.size() / 2),
+                                              common + "b", "\xff", "\xff\xff\xff" };
+            for( size_t i = 0; i < n; ++i ) {
+                std::string k = common;
+                for( size_t l = rnd() % 12; l != 0; --l )
+                    k += alphabet[rnd() % alphabet.size()];
+                m.emplace( k, (int)i );
+            }
+            for( auto &i: m ) {
+                lookups.emplace_back( i.first );
+                lookups.emplace_back( i.first + '\0' );
+                lookups.emplace_back( i.first.substr(0, i.first.size() - 1) );
+                if( !i.first.empty() ) {
+                    lookups.emplace_back( i.first.substr(1) );
+                    std::string k = i.first;
+                    ++k.back();
+                    lookups.emplace_back( k );
+                }
+            }
+            
+            const S s{ S::base_type(m.begin(), m.end()) };
+            CHECK( SameLookups(s, m, lookups) );
+            CHECK( std::distance(s.ordered_begin(), s.ordered_end()) == (ptrdiff_t)m.size() );
+            CHECK( std::distance(s.range(common, common + "b").begin(),
+                                 s.range(common, common + "b").end()) ==
+                   std::distance(m.lower_bound(common), m.lower_bound(common + "b")) );
+        }
+}
+
+TEST_CASE( "String map keeps the map it was built from", "[fixed_eytzinger_string_map]" )
+{
+    typedef fixed_eytzinger_string_map<int> S;
+    S s{ S::base_type{ {"example.com", 1}, {"example.org", 2}, {"example.net", 3} } };
+    CHECK( s.base().size() == 3 );
+    CHECK( s.at("example.net") == 3 );
+    CHECK_THROWS_AS( s.at("example"), std::out_of_range );
+    CHECK_THROWS_AS( s.at("example.co"), std::out_of_range );
+    CHECK( s.lower_bound("example")->first == "example.com" );
+    CHECK( s.lower_bound("example.zzz") == s.end() );
+    CHECK( s.upper_bound("example.net")->first == "example.org" );
+    CHECK( std::distance(s.equal_range("example.org").first,
+                         s.equal_range("example.org").second) == 1 );
+    CHECK( std::distance(s.begin(), s.end()) == 3 );
+    CHECK( s.key_comp()("a", "b") );
+    
+    S moved = std::move( s );
+    CHECK( moved.at("example.com") == 1 );
+    const S empty;
+    CHECK( empty.empty() );
+    CHECK( empty.find("") == empty.end() );
+    CHECK( empty.lower_bound("a") == empty.end() );
+}
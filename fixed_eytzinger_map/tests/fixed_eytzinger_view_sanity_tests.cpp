@@ -0,0 +1,103 @@
+#include <catch.hpp>
+#include <fixed_eytzinger_view.h>
+#include <map>
+#include <string>
+#include <vector>
+
+TEST_CASE( "Permutes sorted ranges into the layout of the map", "[fixed_eytzinger_view]" )
+{
+    std::vector<size_t> sizes;
+    for( size_t n = 0; n <= 300; ++n )
+        sizes.emplace_back( n );
+    sizes.emplace_back( 65535 );
+    sizes.emplace_back( 65536 );
+    sizes.emplace_back( 100000 );
+    for( size_t n: sizes ) {
+        std::vector< std::pair<int, int> > d;
+        for( int i = 0; i < (int)n; ++i )
+            d.emplace_back( i, -i );
+        fixed_eytzinger_map<int, int> m{ fixed_eytzinger_sorted_unique, d.begin(), d.end() };
+
+        std::vector<int> keys( n );
+        for( size_t i = 0; i < n; ++i )
+            keys[i] = (int)i;
+        fixed_eytzinger_permute( keys.begin(), keys.end() );
+        bool same = true;
+        size_t i = 0;
+        for( auto it = m.cbegin(); it != m.cend(); ++it, ++i )
+            same = same && it->first == keys[i];
+        CHECK( same );
+    }
+}
+
+TEST_CASE( "Looks up in arrays owned by the caller", "[fixed_eytzinger_view]" )
+{
+    for( int n = 0; n < 1000; n += 37 ) {
+        std::map<int, std::string> m;
+        for( int i = 0; i < n; ++i )
+            m.emplace( (i * 7919) % 4001 * 2, std::to_string(i) );
+        std::vector<int> keys;
+        std::vector<std::string> values;
+        for( auto &i: m ) {
+            keys.emplace_back( i.first );
+            values.emplace_back( i.second );
+        }
+        fixed_eytzinger_permute( keys.begin(), keys.end() );
+        fixed_eytzinger_permute( values.begin(), values.end() );
+
+        const fixed_eytzinger_view<int, std::string> v{ keys.data(), values.data(), keys.size() };
+        REQUIRE( v.size() == m.size() );
+        CHECK( v.empty() == m.empty() );
+        CHECK( std::distance(v.begin(), v.end()) == n );
+        auto o = v.ordered_begin();
+        for( auto &i: m ) {
+            CHECK( o->first == i.first );
+            CHECK( o->second == i.second );
+            ++o;
+        }
+        CHECK( o == v.ordered_end() );
+
+        std::vector<int> lookups;
+        for( int k = -1; k <= 8003; k += 3 ) {
+            lookups.emplace_back( k );
+            CHECK( v.count(k) == m.count(k) );
+            if( m.count(k) ) {
+                CHECK( v.at(k) == m.at(k) );
+                CHECK( v.find(k)->second == m.at(k) );
+            }
+            else {
+                CHECK( v.find(k) == v.end() );
+                CHECK_THROWS_AS( v.at(k), std::out_of_range );
+            }
+            auto lb = m.lower_bound(k);
+            CHECK( (lb == m.end() ? v.lower_bound(k) == v.end() :
+                                    v.lower_bound(k)->first == lb->first) );
+            auto ub = m.upper_bound(k);
+            CHECK( (ub == m.end() ? v.upper_bound(k) == v.end() :
+                                    v.upper_bound(k)->first == ub->first) );
+        }
+        CHECK( std::distance(v.range(100, 1000).begin(), v.range(100, 1000).end()) ==
+               std::distance(m.lower_bound(100), m.lower_bound(1000)) );
+
+        std::vector<size_t> counts;
+        v.count_batch( lookups.begin(), lookups.end(), std::back_inserter(counts) );
+        for( size_t i = 0; i < lookups.size(); ++i )
+            CHECK( counts[i] == m.count(lookups[i]) );
+    }
+}
+
+#if __cplusplus >= 201402L
+TEST_CASE( "View supports heterogeneous lookup over caller arrays", "[fixed_eytzinger_view]" )
+{
+    std::string keys[] = { "apple", "banana", "cherry", "date" };
+    int values[] = { 1, 2, 3, 4 };
+    fixed_eytzinger_permute( std::begin(keys), std::end(keys) );
+    fixed_eytzinger_permute( std::begin(values), std::end(values) );
+    fixed_eytzinger_view<std::string, int, std::less<>> v{ keys, values, 4 };
+    CHECK( v.at("banana") == 2 );
+    CHECK( v.count("elderberry") == 0 );
+    CHECK( v.lower_bound("c")->second == 3 );
+    auto copy = v;
+    CHECK( copy.find("date")->second == 4 );
+}
+#endif
@@ -0,0 +1,114 @@
+#include <catch.hpp>
+#include <static_eytzinger_map.h>
+#include <algorithm>
+#include <array>
+#include <map>
+#include <random>
+#include <string>
+
+#if __cplusplus >= 201703L
+namespace {
+enum class op { add, sub, mul, div, mod };
+constexpr auto ops = make_static_eytzinger_map<int, op>({
+    {'%', op::mod}, {'+', op::add}, {'/', op::div}, {'-', op::sub}, {'*', op::mul}
+});
+static_assert( ops.size() == 5 );
+static_assert( ops.at('*') == op::mul && ops['-'] == op::sub );
+static_assert( ops.count('+') == 1 && ops.count('^') == 0 );
+static_assert( ops.find('^') == ops.end() );
+static_assert( (*ops.lower_bound('.')).first == '/' );
+static_assert( ops.upper_bound('/') == ops.end() );
+
+constexpr static_eytzinger_map<int, int, 0> none;
+static_assert( none.empty() && none.count(1) == 0 && none.begin() == none.end() );
+}
+
+template <typename S>
+static bool SameLookups( const S &s, const std::map<int, std::string> &m, int max_key )
+{
+    if( s.size() != m.size() || s.empty() != m.empty() )
+        return false;
+    for( int k = -1; k <= max_key; ++k ) {
+        const auto lb = m.lower_bound( k ), ub = m.upper_bound( k );
+        const auto slb = s.lower_bound( k ), sub = s.upper_bound( k );
+        if( (lb == m.end()) != (slb == s.end()) || (lb != m.end() && slb->first != lb->first) )
+            return false;
+        if( (ub == m.end()) != (sub == s.end()) || (ub != m.end() && sub->first != ub->first) )
+            return false;
+        const auto er = s.equal_range( k );
+        if( er.first != slb || er.second != sub )
+            return false;
+        if( s.count(k) != m.count(k) || (s.find(k) == s.end()) != (m.find(k) == m.end()) )
+            return false;
+        if( m.count(k) && (s.at(k) != m.at(k) || s[k] != m.at(k) || s.find(k)->second != m.at(k)) )
+            return false;
+    }
+    return true;
+}
+
+template <size_t N>
+static void CheckSize()
+{
+    std::array<std::pair<int, std::string>, N> a;
+    std::map<int, std::string> m;
+    for( size_t i = 0; i < N; ++i ) {
+        a[i] = { int(i) * 3, std::to_string(i) };
+        m.emplace( a[i] );
+    }
+    std::shuffle( a.begin(), a.end(), std::mt19937(N) );
+    
+    const static_eytzinger_map<int, std::string, N> s{ a };
+    CHECK( SameLookups(s, m, 3 * int(N)) );
+    
+    const fixed_eytzinger_map<int, std::string> e{ m.begin(), m.end() };
+    auto i = s.begin();
+    for( auto j: e ) {
+        CHECK( i->first == j.first );
+        CHECK( (*i).second == j.second );
+        ++i;
+    }
+    CHECK( i == s.end() );
+    
+    auto copy = s;
+    copy.at( 0 ) = "changed";
+    CHECK( copy[0] == "changed" );
+    CHECK( s.at(0) == "0" );
+    auto other = s;
+    swap( copy, other );
+    CHECK( other.at(0) == "changed" );
+    CHECK( copy.at(0) == "0" );
+    CHECK( s.at(0) == "0" );
+}
+
+TEST_CASE( "Static map lookups agree with std::map", "[static_eytzinger_map]" )
+{
+    CheckSize<1>();
+    CheckSize<2>();
+    CheckSize<3>();
+    CheckSize<4>();
+    CheckSize<7>();
+    CheckSize<8>();
+    CheckSize<15>();
+    CheckSize<16>();
+    CheckSize<100>();
+    CheckSize<1000>();
+}
+
+TEST_CASE( "Static map rejects duplicates and missing keys", "[static_eytzinger_map]" )
+{
+    CHECK_THROWS_AS( (static_eytzinger_map<int, int, 3>{ {{1, 1}, {2, 2}, {1, 3}} }),
+                     std::invalid_argument );
+    const static_eytzinger_map<int, int, 3> s{ {{3, 3}, {1, 1}, {2, 2}} };
+    CHECK_THROWS_AS( s.at(4), std::out_of_range );
+    CHECK_THROWS_AS( s[0], std::out_of_range );
+}
+
+TEST_CASE( "Static map with a custom comparator", "[static_eytzinger_map]" )
+{
+    constexpr auto s = make_static_eytzinger_map<int, int>( {{1, 10}, {3, 30}, {2, 20}},
+                                                           std::greater<int>() );
+    static_assert( s.at(3) == 30 );
+    static_assert( (*s.lower_bound(4)).first == 3 && (*s.upper_bound(2)).first == 1 );
+    CHECK( s.lower_bound(0) == s.end() );
+}
+#endif